@@ -4,13 +4,17 @@ var rgbaToC565 = function (r, g, b, a) {
 		: (((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
 };
 
+// How the pixels of the image a color palette belongs to are stored:
+var IMAGE_FORMAT_8BPP = 0; // one palette index per byte
+var IMAGE_FORMAT_4BPP = 1; // two per byte, the first one in the high nibble
+
 var serializeColorPalette = function (colorPalette) {
 	var colors = colorPalette.colorArray;
 	var name = colorPalette.name;
 	var headerLength = getPaddedHeaderLength(
 		32 // name
 		+ 1 // uint8_t color_count
-		+ 1 // uint8_t padding
+		+ 1 // uint8_t image_format
 		+ 2 * colors.length // uint16_t colors
 	);
 	var arrayBuffer = new ArrayBuffer(headerLength);
@@ -27,7 +31,11 @@ var serializeColorPalette = function (colorPalette) {
 		colors.length
 	);
 	offset += 1;
-	offset += 1; // uint8_t padding
+	dataView.setUint8(
+		offset, // uint8_t image_format
+		colorPalette.imageFormat || IMAGE_FORMAT_8BPP
+	);
+	offset += 1;
 	colors.forEach(function (color) {
 		// DO NOT USE `IS_LITTLE_ENDIAN` HERE!
 		// The screen _hardware_ is Big Endian,
@@ -42,6 +50,17 @@ var serializeColorPalette = function (colorPalette) {
 	return arrayBuffer;
 };
 
+var packImageNibbles = function (data) {
+	var source = new Uint8Array(data);
+	var packed = new Uint8Array(Math.ceil(source.length / 2));
+	source.forEach(function (paletteIndex, pixelIndex) {
+		packed[pixelIndex >> 1] |= (pixelIndex & 1)
+			? paletteIndex
+			: paletteIndex << 4;
+	});
+	return packed.buffer;
+};
+
 var imageTypeHandlerMap = {
 	gif: function(fileUint8Buffer) {
 		var reader = new window.omggif.GifReader(fileUint8Buffer);
@@ -190,6 +209,14 @@ var handleImage = function (tileset, scenarioData, fileNameMap) {
 				}
 				// console.table(wtfLog);
 				console.log(`Colors in image "${imageFileName}": ${colorPalette.colorArray.length}`);
+				// Every tile has to start on a whole byte for the engine to find it
+				if (
+					colorPalette.colorArray.length <= 16
+					&& pixelsPerTile % 2 === 0
+				) {
+					data = packImageNibbles(data);
+					colorPalette.imageFormat = IMAGE_FORMAT_4BPP;
+				}
 				file.serialized = data;
 				colorPalette.serialized = serializeColorPalette(colorPalette);
 				return file;
@@ -386,6 +386,10 @@ var actionFieldsMap = {
 	SLOT_ERASE: [
 		{propertyName: 'slot', size: 1},
 	],
+	CHECK_SAVE_IN_PROGRESS: [
+		{propertyName: 'success_script', size: 2},
+		{propertyName: 'expected_bool', size: 1},
+	],
 };
 
 var actionNames = [
@@ -476,6 +480,7 @@ var actionNames = [
 	'SLOT_SAVE',
 	'SLOT_LOAD',
 	'SLOT_ERASE',
+	'CHECK_SAVE_IN_PROGRESS',
 ];
 
 var specialKeywordsEnum = {
@@ -0,0 +1,168 @@
+#include "EngineGlyphSpans.h"
+
+#include <memory>
+
+typedef struct {
+	const uint8_t *bitmap;
+	const GFXglyph *glyphs;
+	uint16_t glyphCount;
+	//where the spans of each glyph start in spans,
+	//both NULL if the font didn't fit in what was left of the budget:
+	const uint16_t *glyphOffsets;
+	const uint8_t *spans;
+	//a copy of a font that was already decoded uses its spans,
+	//only the font that decoded them owns them:
+	std::unique_ptr<uint16_t[]> ownGlyphOffsets;
+	std::unique_ptr<uint8_t[]> ownSpans;
+} EngineGlyphSpans_Font;
+
+static EngineGlyphSpans_Font glyphFonts[ENGINE_GLYPH_SPANS_FONT_COUNT];
+static uint8_t glyphFontCount = 0;
+static bool glyphSpansEnabled = true;
+static EngineGlyphSpans_Stats glyphStats = {};
+
+static inline bool glyphBitSet(const uint8_t *bitmap, uint32_t bit) {
+	return (bitmap[bit >> 3] << (bit & 7)) & 0x80;
+}
+
+//works out the spans of one glyph and writes them to spans,
+//or only counts them if spans is NULL. returns how many bytes they take.
+static uint32_t glyphSpansBuild(
+	const uint8_t *bitmap,
+	const GFXglyph *glyph,
+	uint8_t *spans
+) {
+	//the rows of a glyph's bitmap follow each other without padding,
+	//so the bit a row starts on carries on from the one before:
+	uint32_t bit = glyph->bitmapOffset * 8;
+	uint32_t length = 0;
+	for (uint8_t y = 0; y < glyph->height; y++) {
+		uint32_t countIndex = length++;
+		uint8_t runCount = 0;
+		uint8_t x = 0;
+		while (x < glyph->width) {
+			while (x < glyph->width && !glyphBitSet(bitmap, bit + x)) {
+				x++;
+			}
+			if (x == glyph->width) {
+				break;
+			}
+			uint8_t start = x;
+			while (x < glyph->width && glyphBitSet(bitmap, bit + x)) {
+				x++;
+			}
+			if (spans != NULL) {
+				spans[length] = start;
+				spans[length + 1] = x - start;
+			}
+			length += 2;
+			runCount++;
+		}
+		if (spans != NULL) {
+			spans[countIndex] = runCount;
+		}
+		bit += glyph->width;
+	}
+	return length;
+}
+
+//how many bytes of the bitmap the glyphs use:
+static uint32_t glyphBitmapLength(const GFXfont *font) {
+	uint32_t length = 0;
+	for (uint16_t glyph = 0; glyph <= font->last - font->first; glyph++) {
+		const GFXglyph *g = &font->glyph[glyph];
+		length = MAX(length, (uint32_t)(g->bitmapOffset + (((g->width * g->height) + 7) / 8)));
+	}
+	return length;
+}
+
+//an already decoded font with the same glyphs and bitmap, or NULL:
+static const EngineGlyphSpans_Font *glyphSpansFindCopy(const GFXfont *font) {
+	uint16_t glyphCount = (font->last - font->first) + 1;
+	for (uint8_t i = 0; i < glyphFontCount; i++) {
+		const EngineGlyphSpans_Font *decoded = &glyphFonts[i];
+		if (
+			decoded->spans != NULL
+			&& decoded->glyphCount == glyphCount
+			&& memcmp(decoded->glyphs, font->glyph, glyphCount * sizeof(GFXglyph)) == 0
+			&& memcmp(decoded->bitmap, font->bitmap, glyphBitmapLength(font)) == 0
+		) {
+			return decoded;
+		}
+	}
+	return NULL;
+}
+
+static void glyphSpansDecode(EngineGlyphSpans_Font *decoded, const GFXfont *font) {
+	uint16_t glyphCount = (font->last - font->first) + 1;
+	decoded->glyphCount = glyphCount;
+	const EngineGlyphSpans_Font *copyOf = glyphSpansFindCopy(font);
+	if (copyOf != NULL) {
+		decoded->glyphOffsets = copyOf->glyphOffsets;
+		decoded->spans = copyOf->spans;
+		return;
+	}
+	uint32_t length = 0;
+	for (uint16_t glyph = 0; glyph < glyphCount; glyph++) {
+		length += glyphSpansBuild(font->bitmap, &font->glyph[glyph], NULL);
+	}
+	uint32_t bytes = length + (glyphCount * sizeof(uint16_t));
+	if (length > UINT16_MAX || glyphStats.bytes + bytes > ENGINE_GLYPH_SPANS_BYTES) {
+		return;
+	}
+	decoded->ownGlyphOffsets = std::make_unique<uint16_t[]>(glyphCount);
+	decoded->ownSpans = std::make_unique<uint8_t[]>(length);
+	uint32_t offset = 0;
+	for (uint16_t glyph = 0; glyph < glyphCount; glyph++) {
+		decoded->ownGlyphOffsets[glyph] = offset;
+		offset += glyphSpansBuild(
+			font->bitmap,
+			&font->glyph[glyph],
+			decoded->ownSpans.get() + offset
+		);
+	}
+	decoded->glyphOffsets = decoded->ownGlyphOffsets.get();
+	decoded->spans = decoded->ownSpans.get();
+	glyphStats.fonts++;
+	glyphStats.bytes += bytes;
+}
+
+const uint8_t *EngineGlyphSpans_Get(const GFXfont *font, uint8_t glyphIndex) {
+	if (!glyphSpansEnabled) {
+		glyphStats.glyphsFromBitmap++;
+		return NULL;
+	}
+	EngineGlyphSpans_Font *decoded = NULL;
+	for (uint8_t i = 0; i < glyphFontCount; i++) {
+		if (glyphFonts[i].bitmap == font->bitmap && glyphFonts[i].glyphs == font->glyph) {
+			decoded = &glyphFonts[i];
+			break;
+		}
+	}
+	if (decoded == NULL && glyphFontCount < ENGINE_GLYPH_SPANS_FONT_COUNT) {
+		//fonts that don't fit keep their slot too, so they aren't tried again:
+		decoded = &glyphFonts[glyphFontCount++];
+		decoded->bitmap = font->bitmap;
+		decoded->glyphs = font->glyph;
+		glyphSpansDecode(decoded, font);
+	}
+	if (decoded == NULL || decoded->spans == NULL) {
+		glyphStats.glyphsFromBitmap++;
+		return NULL;
+	}
+	glyphStats.glyphsFromSpans++;
+	return decoded->spans + decoded->glyphOffsets[glyphIndex];
+}
+
+void EngineGlyphSpans_SetEnabled(bool enabled) {
+	glyphSpansEnabled = enabled;
+}
+
+const EngineGlyphSpans_Stats *EngineGlyphSpans_GetStats() {
+	return &glyphStats;
+}
+
+void EngineGlyphSpans_ResetStats() {
+	glyphStats.glyphsFromSpans = 0;
+	glyphStats.glyphsFromBitmap = 0;
+}
@@ -0,0 +1,47 @@
+#ifndef ENGINE_GLYPH_SPANS_H_
+#define ENGINE_GLYPH_SPANS_H_
+
+#include "common.h"
+
+//Font bitmaps are one bit per pixel, so drawing text straight from them means
+//looking at every bit of every glyph. Instead, the first time a font is drawn
+//all of its glyphs are decoded into spans, laid out the same way as a tile's
+//(see EngineTileSpans.h): row by row from the top, one byte with how many runs
+//the row has, followed by a start column byte and a length byte for each run.
+//FrameBuffer then only fills the runs.
+
+//RAM budget for the spans of every font together, per target. 0 turns it off.
+#ifndef ENGINE_GLYPH_SPANS_BYTES
+#ifdef DC801_DESKTOP
+#define ENGINE_GLYPH_SPANS_BYTES (64 * 1024)
+#else
+#define ENGINE_GLYPH_SPANS_BYTES (8 * 1024)
+#endif //DC801_DESKTOP
+#endif //ENGINE_GLYPH_SPANS_BYTES
+
+//fonts are told apart by their bitmap and glyphs. the const ones in the font
+//headers are copied into every file that includes them, so the same font can
+//take more than one of these, but its spans are only decoded once:
+#define ENGINE_GLYPH_SPANS_FONT_COUNT 16
+
+typedef struct {
+	uint32_t fonts;
+	uint32_t bytes;
+	//glyphs drawn from spans, and from the bitmap because
+	//their font didn't fit or this is turned off:
+	uint32_t glyphsFromSpans;
+	uint32_t glyphsFromBitmap;
+} EngineGlyphSpans_Stats;
+
+//the spans of glyph glyphIndex (the character minus font->first),
+//decoding every glyph of the font the first time it's asked for.
+//NULL if the font doesn't fit, the glyph has to be drawn from the bitmap then.
+const uint8_t *EngineGlyphSpans_Get(const GFXfont *font, uint8_t glyphIndex);
+//false makes every glyph come from the bitmap, so tests can compare
+//and time both. on by default.
+void EngineGlyphSpans_SetEnabled(bool enabled);
+const EngineGlyphSpans_Stats *EngineGlyphSpans_GetStats();
+//only resets how many glyphs were drawn, the fonts stay decoded:
+void EngineGlyphSpans_ResetStats();
+
+#endif //ENGINE_GLYPH_SPANS_H_
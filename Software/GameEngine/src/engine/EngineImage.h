@@ -0,0 +1,40 @@
+#ifndef ENGINE_IMAGE_H_
+#define ENGINE_IMAGE_H_
+
+#include "common.h"
+
+//The images in game.dat are palette indexes, laid out tile after tile.
+//An image with 16 colors or fewer can be packed two pixels to a byte,
+//the first one in the high nibble, which halves what has to be read from ROM.
+//Which one an image is comes from its color palette (see MageColorPalette).
+
+#define ENGINE_IMAGE_FORMAT_8BPP 0
+#define ENGINE_IMAGE_FORMAT_4BPP 1
+
+//the encoder only packs images where every tile is an even number of pixels,
+//so every tile starts on a whole byte.
+
+//the palette index of the pixel at index:
+static inline uint8_t EngineImage_Pixel(
+	const uint8_t *pixels,
+	uint32_t index,
+	bool packed
+) {
+	if (!packed) {
+		return pixels[index];
+	}
+	uint8_t pair = pixels[index >> 1];
+	return (index & 1) ? (pair & 0x0F) : (pair >> 4);
+}
+
+//where the pixel at pixelOffset starts, in bytes:
+static inline uint32_t EngineImage_Offset(uint32_t pixelOffset, bool packed) {
+	return packed ? (pixelOffset >> 1) : pixelOffset;
+}
+
+//how many bytes pixelCount pixels take:
+static inline uint32_t EngineImage_Bytes(uint32_t pixelCount, bool packed) {
+	return packed ? ((pixelCount + 1) >> 1) : pixelCount;
+}
+
+#endif //ENGINE_IMAGE_H_
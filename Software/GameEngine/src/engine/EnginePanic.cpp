@@ -22,6 +22,16 @@ std::string extract_filename(const char * fullpath) {
 	return std::string(filepart);
 }
 
+// Everything on the panic screen, kept until it has been drawn,
+// which may be a band at a time
+typedef struct {
+	const char *file;
+	int lineno;
+	char message[401];
+} PanicScreen;
+
+static PanicScreen panic_screen;
+
 void panic_print(const char *msg, int x, int y)
 {
 	// Write to the screen
@@ -32,15 +42,12 @@ void panic_print(const char *msg, int x, int y)
 		x,
 		y
 	);
-
-#ifdef DC801_DESKTOP
-	// On desktop, write to stderr as well
-	fprintf(stderr, "%s", msg);
-#endif
 }
 
-void EnginePanic(const char *filename, int lineno, const char *format, ...)
+static void panic_draw(void *data)
 {
+	const PanicScreen *screen = (const PanicScreen *)data;
+
 	// BSOD background
 	canvas.clearScreen(COLOR_BSOD);
 
@@ -57,14 +64,6 @@ void EnginePanic(const char *filename, int lineno, const char *format, ...)
 	const int x = 45;
 	int y = 0;
 
-#ifdef DC801_DESKTOP
-	// Print Banner, File Name, Line Number
-	std::string path = extract_filename(filename);
-	const char *file = path.c_str();
-#else
-	const char *file = "There is no file...";
-#endif
-
 	const char *header = "\n"
 						 "---------- DC801 Badge Panic ----------\n"
 						 "File: %s\n"
@@ -72,17 +71,13 @@ void EnginePanic(const char *filename, int lineno, const char *format, ...)
 						 "\n"
 						 "Error Details:\n";
 
-	snprintf(panic_message, sizeof(panic_message), header, file, lineno);
+	snprintf(panic_message, sizeof(panic_message), header, screen->file, screen->lineno);
 	panic_message[sizeof(panic_message) - 1] = 0;	// Null terminate
 	panic_print(panic_message, x, y);
 	y += yAdvance * 6;
 
 	// Print Message
-	va_list args;
-	va_start(args, format);
-	vsnprintf(panic_message, sizeof(panic_message), format, args);
-	panic_message[sizeof(panic_message) - 1] = 0;	// Null terminate
-	panic_print(panic_message, x, y);
+	panic_print(screen->message, x, y);
 
 	y = HEIGHT - (yAdvance * 6);
 
@@ -101,9 +96,39 @@ void EnginePanic(const char *filename, int lineno, const char *format, ...)
 #endif
 	panic_message[sizeof(panic_message) - 1] = 0;	// Null terminate
 	panic_print(panic_message, x, y);
+}
+
+void EnginePanic(const char *filename, int lineno, const char *format, ...)
+{
+#ifdef DC801_DESKTOP
+	// Print Banner, File Name, Line Number
+	std::string path = extract_filename(filename);
+	panic_screen.file = path.c_str();
+#else
+	panic_screen.file = "There is no file...";
+#endif
+	panic_screen.lineno = lineno;
+
+	// Print Message
+	va_list args;
+	va_start(args, format);
+	vsnprintf(panic_screen.message, sizeof(panic_screen.message), format, args);
+	va_end(args);
+	panic_screen.message[sizeof(panic_screen.message) - 1] = 0;	// Null terminate
+
+#ifdef DC801_DESKTOP
+	// On desktop, write to stderr as well
+	fprintf(
+		stderr,
+		"\n---------- DC801 Badge Panic ----------\nFile: %s\nLine: %d\n\nError Details:\n%s\n",
+		panic_screen.file,
+		panic_screen.lineno,
+		panic_screen.message
+	);
+#endif
 
 	// Push BSOD to screen
-	canvas.blt();
+	canvas.renderBands(panic_draw, &panic_screen);
 
 	while (EngineInput_Buttons.rjoy_center == false)
 	{
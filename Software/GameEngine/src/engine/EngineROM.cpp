@@ -4,6 +4,7 @@
 #include "FrameBuffer.h"
 #include "fonts/Monaco9.h"
 #include "games/mage/mage_defines.h"
+#include "EngineSaveLog.h"
 
 #ifdef DC801_DESKTOP
 #include <errno.h>
@@ -12,23 +13,46 @@
 
 #ifdef EMSCRIPTEN
 #include <emscripten.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #endif // EMSCRIPTEN
 
-#define DESKTOP_SAVE_FILE_PATH "MAGE/save_games/"
-
-FILE *romfile = NULL;
-uint8_t romDataInDesktopRam[ENGINE_ROM_MAX_DAT_FILE_SIZE] = {0};
-char saveFileSlotNames[ENGINE_ROM_SAVE_GAME_SLOTS][32] = {
-	DESKTOP_SAVE_FILE_PATH "save_0.dat",
-	DESKTOP_SAVE_FILE_PATH "save_1.dat",
-	DESKTOP_SAVE_FILE_PATH "save_2.dat"
-};
-
-void makeSureSaveFilePathExists() {
-	struct stat st = {0};
-	if (stat(DESKTOP_SAVE_FILE_PATH, &st) == -1) {
-		mkdir(DESKTOP_SAVE_FILE_PATH, 0777);
+// On desktop, game.dat is memory-mapped instead of being copied into a 32MB
+// static array. The whole ROM address space is reserved as an anonymous,
+// zero-filled mapping, and the file is mapped over the start of it, so reads
+// past the end of the file still return 0 like the empty QSPI chip would.
+// Pages are only faulted in as the engine actually touches them.
+// The mapping is MAP_PRIVATE and read-only; EngineROM_Write flips the pages
+// it touches to read-write, which the kernel turns into copy-on-write copies,
+// so game.dat on disk is never modified.
+// Emscripten has no real file mapping, so it keeps the old read-into-RAM path.
+uint8_t *romDataInDesktopRam = NULL;
+size_t romDataInDesktopRamSize = 0;
+
+// unprotects only the pages about to be written; the private mapping gives
+// them copy-on-write copies, leaving game.dat on disk untouched
+void makeDesktopRomWritable(uint32_t address, uint32_t length) {
+	if (romDataInDesktopRam == NULL || length > romDataInDesktopRamSize || address > romDataInDesktopRamSize - length) {
+		ENGINE_PANIC("Desktop build: ROM write out of range");
+	}
+#ifndef EMSCRIPTEN
+	uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+	uintptr_t writeStart = (uintptr_t)(romDataInDesktopRam + address);
+	uintptr_t pageStart = writeStart & ~(pageSize - 1);
+	if (mprotect(
+		(void *)pageStart,
+		(writeStart + length) - pageStart,
+		PROT_READ | PROT_WRITE
+	) != 0)
+	{
+		int error = errno;
+		fprintf(stderr, "Error: %s\n", strerror(error));
+		ENGINE_PANIC("Desktop build: Unable to unprotect ROM pages");
 	}
+#endif // EMSCRIPTEN
 }
 #endif //DC801_DESKTOP
 
@@ -38,6 +62,51 @@ extern QSPI qspiControl;
 
 #endif //DC801_EMBEDDED
 
+#define ENGINE_ROM_SD_COPY_TITLE "Comparing SD card to ROM chip"
+#define ENGINE_ROM_SD_COPY_TITLE_Y 64
+#define ENGINE_ROM_SD_COPY_PROGRESS_Y 96
+
+//everything on one of the ROM update screens,
+//so it can be drawn again for every band:
+typedef struct {
+	const char *message;
+	int messageY;
+	//shown under the message while copying, NULL if there is none:
+	const char *progress;
+} EngineROM_Screen;
+
+static void EngineROM_DrawScreen(void *data) {
+	const EngineROM_Screen *screen = (const EngineROM_Screen *)data;
+	p_canvas()->clearScreen(COLOR_BLACK);
+	if (screen->message != NULL) {
+		p_canvas()->printMessage(
+			screen->message,
+			Monaco9,
+			COLOR_WHITE,
+			16,
+			screen->messageY
+		);
+	}
+	if (screen->progress != NULL) {
+		p_canvas()->printMessage(
+			screen->progress,
+			Monaco9,
+			COLOR_WHITE,
+			16,
+			ENGINE_ROM_SD_COPY_PROGRESS_Y
+		);
+	}
+}
+
+static void EngineROM_SD_CopyProgress(const char *message) {
+	EngineROM_Screen screen = {
+		.message = ENGINE_ROM_SD_COPY_TITLE,
+		.messageY = ENGINE_ROM_SD_COPY_TITLE_Y,
+		.progress = message,
+	};
+	p_canvas()->renderBands(EngineROM_DrawScreen, &screen);
+}
+
 void EngineROM_Init()
 {
 	bool isRomPlayable = false;
@@ -136,7 +205,6 @@ void EngineROM_Init()
 
 		// show update confirmation
 		char debugString[512];
-		p_canvas()->clearScreen(COLOR_BLACK);
 		//48 chars is a good character width for screen width plus some padding
 		sprintf(
 			debugString,
@@ -151,21 +219,19 @@ void EngineROM_Init()
 			gameDatHashSDString,
 			gameDatHashROMString
 		);
-		p_canvas()->printMessage(
-			debugString,
-			Monaco9,
-			0xffff,
-			16,
-			16
-		);
-		p_canvas()->blt();
+		EngineROM_Screen screen = {
+			.message = debugString,
+			.messageY = 16,
+			.progress = NULL,
+		};
+		p_canvas()->renderBands(EngineROM_DrawScreen, &screen);
 		bool showOptions = true;
 		while (showOptions) {
 			nrf_delay_ms(10);
 			EngineHandleInput();
 			if (EngineInput_Activated.mem0) {
-				p_canvas()->clearScreen(COLOR_BLACK);
-				p_canvas()->blt();
+				screen.message = NULL;
+				p_canvas()->renderBands(EngineROM_DrawScreen, &screen);
 				return;
 			}
 			if (EngineInput_Activated.mem3) {
@@ -173,13 +239,16 @@ void EngineROM_Init()
 			}
 		}
 	}
-	if(!EngineROM_SD_Copy(gameDatFilesize, gameDat)){
+	if(!EngineROM_SD_Copy(gameDatFilesize, &gameDat, NULL)){
 		ENGINE_PANIC("SD Copy Operation was not successful.");
 	}
 	//close game.dat file when done:
 	result = f_close(&gameDat);
 #endif //DC801_EMBEDDED
 #ifdef DC801_DESKTOP
+	uint32_t romInitStartTime = millis();
+	// a reload of game.dat goes through here again, drop the old mapping first:
+	EngineROM_Deinit();
 	struct stat stats;
 	size_t romFileSize = 0;
 	if (stat(filename, &stats) == 0) {
@@ -204,7 +273,13 @@ void EngineROM_Init()
 		);
 	}
 
-	romfile = fopen(filename, "rb");
+#ifdef EMSCRIPTEN
+	romDataInDesktopRamSize = ENGINE_ROM_MAX_DAT_FILE_SIZE;
+	romDataInDesktopRam = (uint8_t *)calloc(romDataInDesktopRamSize, 1);
+	if (romDataInDesktopRam == NULL) {
+		ENGINE_PANIC("Desktop build: Unable to allocate ROM buffer");
+	}
+	FILE *romfile = fopen(filename, "rb");
 	if (romfile == NULL)
 	{
 		int error = errno;
@@ -222,6 +297,67 @@ void EngineROM_Init()
 	{
 		ENGINE_PANIC("Desktop build: ROM->RAM read failed");
 	}
+#else
+	int romFileDescriptor = open(filename, O_RDONLY);
+	if (romFileDescriptor == -1)
+	{
+		int error = errno;
+		fprintf(stderr, "Error: %s\n", strerror(error));
+		ENGINE_PANIC(
+			"Desktop build:\n"
+			"    Unable to open ROM file for reading"
+		);
+	}
+
+	// reserve the whole ROM address space, zero-filled and not yet backed by RAM:
+	void *romReservation = mmap(
+		NULL,
+		ENGINE_ROM_MAX_DAT_FILE_SIZE,
+		PROT_READ,
+		MAP_PRIVATE | MAP_ANONYMOUS,
+		-1,
+		0
+	);
+	if (romReservation == MAP_FAILED)
+	{
+		int error = errno;
+		fprintf(stderr, "Error: %s\n", strerror(error));
+		close(romFileDescriptor);
+		ENGINE_PANIC("Desktop build: Unable to reserve ROM address space");
+	}
+	romDataInDesktopRam = (uint8_t *)romReservation;
+	romDataInDesktopRamSize = ENGINE_ROM_MAX_DAT_FILE_SIZE;
+
+	// then map game.dat over the start of it:
+	if (
+		romFileSize > 0
+		&& mmap(
+			romDataInDesktopRam,
+			romFileSize,
+			PROT_READ,
+			MAP_PRIVATE | MAP_FIXED,
+			romFileDescriptor,
+			0
+		) == MAP_FAILED
+	)
+	{
+		int error = errno;
+		fprintf(stderr, "Error: %s\n", strerror(error));
+		close(romFileDescriptor);
+		ENGINE_PANIC("Desktop build: ROM file mmap failed");
+	}
+	// the mapping keeps its own reference to the file
+	close(romFileDescriptor);
+
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	fprintf(
+		stderr,
+		"EngineROM_Init - mapped game.dat in %ums, max RSS: %ld\n",
+		millis() - romInitStartTime,
+		usage.ru_maxrss
+	);
+#endif // EMSCRIPTEN
 #endif //DC801_DESKTOP
 	// Verify magic string is on ROM when we're done:
 	isRomPlayable = EngineROM_Magic();
@@ -246,74 +382,12 @@ void EngineROM_ErrorUnplayable() {
 	);
 }
 
-uint32_t getSaveSlotAddressByIndex(uint8_t slotIndex) {
-	return (
-		ENGINE_ROM_SAVE_OFFSET
-		+ (slotIndex * ENGINE_ROM_ERASE_PAGE_SIZE)
-	);
-}
-
 void EngineROM_ReadSaveSlot(
 	uint8_t slotIndex,
 	size_t length,
 	uint8_t *data
 ) {
-	#ifdef DC801_DESKTOP
-	makeSureSaveFilePathExists();
-	char *saveFileName = saveFileSlotNames[slotIndex];
-	FILE *saveFile = fopen(saveFileName, "r+b");
-	if (saveFile == NULL) {
-		saveFile = fopen(saveFileName, "w+b");
-		if (saveFile == NULL) {
-			int error = errno;
-			fprintf(stderr, "Error: %s\n", strerror(error));
-			ENGINE_PANIC("Desktop build: SAVE file missing");
-		}
-	}
-	fseek(saveFile, 0, SEEK_END);
-	size_t saveFileSize = ftell(saveFile);
-	rewind(saveFile);
-	debug_print(
-		"Save file size: %d\n",
-		saveFileSize
-	);
-	if(saveFileSize) {
-		if (fread(data, saveFileSize, 1, saveFile) != 1) {
-			fclose(saveFile);
-			ENGINE_PANIC("Desktop build: SAVE file cannot be created");
-		}
-	} else {
-		// The file save_*.dat on disk is empty?
-		// Empty out the destination.
-		for(size_t i = 0; i < length; i++) {
-			data[i] = 0;
-		}
-	}
-	fclose(saveFile);
-	#endif //DC801_DESKTOP
-
-	#ifdef DC801_EMBEDDED
-	EngineROM_Read(
-		getSaveSlotAddressByIndex(slotIndex),
-		length,
-		data,
-		"Failed to read saveGame from ROM"
-	);
-	#endif //DC801_EMBEDDED
-}
-
-void EngineROM_EraseSaveSlot(uint8_t slotIndex) {
-	#ifdef DC801_EMBEDDED
-	if(!qspiControl.erase(
-		tBlockSize::BLOCK_SIZE_256K,
-		getSaveSlotAddressByIndex(slotIndex)
-	)){
-		ENGINE_PANIC("Failed to send erase command for save slot.");
-	}
-	while(qspiControl.isBusy()){
-		// is very busy
-	}
-	#endif //DC801_EMBEDDED
+	EngineSaveLog_Read(slotIndex, length, data);
 }
 
 void EngineROM_WriteSaveSlot(
@@ -329,214 +403,390 @@ void EngineROM_WriteSaveSlot(
 	// Copy the data from the hauntedDataPointer to a locally scoped stack copy,
 	// and write to ROM from the pointer to the locally scoped stack copy.
 	// This may actually be a compiler bug, or ROM interface black magic.
+	// EngineSaveLog_StartWrite snapshots the data into its own buffer for this.
+	EngineSaveLog_StartWrite(slotIndex, length, hauntedDataPointer);
+}
+
+void EngineROM_EraseBlock(uint32_t address) {
+	#ifdef DC801_EMBEDDED
+	if(!qspiControl.erase(tBlockSize::BLOCK_SIZE_256K, address)){
+		ENGINE_PANIC("Failed to send erase comand.");
+	}
+	while(qspiControl.isBusy()){
+		// is very busy
+	}
+	#endif //DC801_EMBEDDED
 	#ifdef DC801_DESKTOP
-	makeSureSaveFilePathExists();
-	char *saveFileName = saveFileSlotNames[slotIndex];
-	FILE *saveFile = fopen(saveFileName, "r+b");
-	if (saveFile == NULL) {
-		saveFile = fopen(saveFileName, "w+b");
-		if (saveFile == NULL) {
-			int error = errno;
-			fprintf(stderr, "Error: %s\n", strerror(error));
-			ENGINE_PANIC("Desktop build: SAVE file cannot be created");
+	// an erased flash block reads back as all 1s
+	makeDesktopRomWritable(address, ENGINE_ROM_ERASE_PAGE_SIZE);
+	memset(
+		romDataInDesktopRam + address,
+		0xFF,
+		ENGINE_ROM_ERASE_PAGE_SIZE
+	);
+	#endif //DC801_DESKTOP
+}
+
+void EngineROM_EraseBlockBegin(uint32_t address) {
+	#ifdef DC801_EMBEDDED
+	// the chip can't be read while erasing, and everything reads from it,
+	// so the erase sits suspended until someone gives it time
+	if(
+		!qspiControl.eraseStart(address)
+		|| !qspiControl.eraseSuspend()
+	){
+		ENGINE_PANIC("Failed to send erase comand.");
+	}
+	#endif //DC801_EMBEDDED
+	#ifdef DC801_DESKTOP
+	EngineROM_EraseBlock(address);
+	#endif //DC801_DESKTOP
+}
+
+bool EngineROM_EraseBlockContinue(uint32_t milliseconds) {
+	#ifdef DC801_EMBEDDED
+	if(!qspiControl.eraseResume()){
+		ENGINE_PANIC("Failed to resume erase.");
+	}
+	uint32_t resumeTime = millis();
+	while(qspiControl.isBusy()){
+		if((millis() - resumeTime) >= milliseconds){
+			if(!qspiControl.eraseSuspend()){
+				ENGINE_PANIC("Failed to suspend erase.");
+			}
+			// if it happened to finish right before the suspend, the next
+			// resume is ignored by the chip and that call returns true
+			return false;
 		}
 	}
-	fwrite(
-		hauntedDataPointer,
-		sizeof(MageSaveGame),
-		1,
-		saveFile
+	#endif //DC801_EMBEDDED
+	return true;
+}
+
+static void EngineROM_SD_ReadChunk(
+	FIL *gameDat,
+	uint32_t address,
+	uint32_t length,
+	uint8_t *buffer
+) {
+	FRESULT result;
+	UINT count;
+	//seek to the address on the SD card:
+	result = f_lseek(gameDat, address);
+	if (result != FR_OK) {
+		ENGINE_PANIC("Error seeking to game.dat position\nduring ROM copy procedure.");
+	}
+	//then read the next set of bytes into the buffer:
+	result = f_read(
+		gameDat,
+		buffer,
+		length,
+		&count
 	);
-	fclose(saveFile);
+	if (result != FR_OK || count != length) {
+		ENGINE_PANIC("Error reading game.dat from SD card\nduring ROM copy procedure.");
+	}
+}
 
-	#ifdef EMSCRIPTEN
-	// triggers a call to the FS.syncfs, asking IDBFS
-	// "pls actually do your job and save for reals"
-	// It's async, so good luck if you interrupt it
-	// ¯\_(ツ)_/¯
-	emscripten_run_script("Module.persistSaveFiles();");
-	#endif // EMSCRIPTEN
+//compares one erase block of game.dat on the SD card against what is already on
+//the ROM chip, one SD chunk at a time, stopping at the first chunk that differs.
+static bool EngineROM_SD_BlockMatchesROM(
+	FIL *gameDat,
+	uint32_t blockAddress,
+	uint32_t blockSize,
+	uint8_t *chunkBuffer
+) {
+	uint32_t offset = 0;
+	while(offset < blockSize){
+		uint32_t chunkSize = MIN(ENGINE_ROM_SD_CHUNK_READ_SIZE, (blockSize - offset));
+		EngineROM_SD_ReadChunk(
+			gameDat,
+			blockAddress + offset,
+			chunkSize,
+			chunkBuffer
+		);
+		if(memcmp(
+			chunkBuffer,
+			EngineROM_View(blockAddress + offset, chunkSize),
+			chunkSize
+		) != 0){
+			return false;
+		}
+		offset += chunkSize;
+	}
+	return true;
+}
 
-	#endif // DC801_DESKTOP
+static void EngineROM_SD_ReadNext(
+	FIL *gameDat,
+	uint32_t length,
+	uint8_t *buffer
+) {
+	UINT count;
+	FRESULT result = f_read(
+		gameDat,
+		buffer,
+		length,
+		&count
+	);
+	if (result != FR_OK || count != length) {
+		ENGINE_PANIC("Error reading game.dat from SD card\nduring ROM copy procedure.");
+	}
+}
 
+//starts programming one page of the ROM chip and returns without waiting for
+//it, EngineROM_SD_WriteEnd does the waiting. data is sent from while the chip
+//programs, so it has to be left alone until then. Desktop writes it right away.
+static void EngineROM_SD_WriteBegin(
+	uint32_t address,
+	uint32_t length,
+	uint8_t *data
+) {
 	#ifdef DC801_EMBEDDED
-	uint8_t localUnHauntedSaveDataCopy[length];
-	memcpy(
-		&localUnHauntedSaveDataCopy,
-		hauntedDataPointer,
-		length
-	);
-	EngineROM_EraseSaveSlot(slotIndex);
+	if(length % sizeof(uint32_t)){
+		ENGINE_PANIC(
+			"Length of write is not aligned to uint32_t\n"
+			"You can't do this, fix whatever is\n"
+			"sending an unaligned write."
+		);
+	}
+	if(!qspiControl.writeStart(data, length, address)){
+		ENGINE_PANIC("Failed to write buffer to ROM chip\nduring ROM copy procedure.");
+	}
+	#endif //DC801_EMBEDDED
+	#ifdef DC801_DESKTOP
 	EngineROM_Write(
-		getSaveSlotAddressByIndex(slotIndex),
+		address,
 		length,
-		// hauntedDataPointer, // DO NOT USE, HAUNTED!!!
-		(uint8_t *)&localUnHauntedSaveDataCopy,
-		"Failed to write currentSave into ROM"
+		data,
+		"Failed to write buffer to ROM chip\nduring ROM copy procedure."
 	);
-	#endif // DC801_EMBEDDED
+	#endif //DC801_DESKTOP
+}
+
+static void EngineROM_SD_WriteEnd() {
+	#ifdef DC801_EMBEDDED
+	qspiControl.waitReady();
+	#endif //DC801_EMBEDDED
+}
+
+//erases one block of the ROM chip and programs it from game.dat on the SD card.
+//The chunk buffer is split in two: while one half is being programmed into the
+//ROM a page at a time, the next piece of game.dat is read from the SD card into
+//the other half. Each page write is only started before the SD read, and waited
+//for after it, so the card is read while the chip is busy programming.
+//The game.dat header is held back (left erased) so it can be written last,
+//after the whole copy has been checked against its crc32.
+static void EngineROM_SD_FlashBlock(
+	FIL *gameDat,
+	uint32_t blockAddress,
+	uint32_t blockSize,
+	uint8_t *chunkBuffer
+) {
+	uint8_t *buffers[2] = {
+		chunkBuffer,
+		chunkBuffer + ENGINE_ROM_SD_PIPELINE_BUFFER_SIZE
+	};
+	uint8_t programIndex = 0;
+	uint32_t blockEnd = blockAddress + blockSize;
+	uint32_t programAddress = blockAddress;
+	uint32_t programLength = MIN(ENGINE_ROM_SD_PIPELINE_BUFFER_SIZE, blockSize);
+
+	EngineROM_EraseBlock(blockAddress);
+
+	//every read after this one is sequential, so only seek once per block:
+	EngineROM_SD_ReadChunk(
+		gameDat,
+		programAddress,
+		programLength,
+		buffers[programIndex]
+	);
+	while(programAddress < blockEnd){
+		uint32_t readAddress = programAddress + programLength;
+		uint32_t readLength = MIN(ENGINE_ROM_SD_PIPELINE_BUFFER_SIZE, (blockEnd - readAddress));
+		uint32_t readOffset = 0;
+		uint8_t *programBuffer = buffers[programIndex];
+		uint8_t *readBuffer = buffers[programIndex ^ 1];
+		for(uint32_t pageOffset = 0; pageOffset < programLength; pageOffset += ENGINE_ROM_WRITE_PAGE_SIZE){
+			uint32_t pageAddress = programAddress + pageOffset;
+			uint32_t writeSize = MIN(ENGINE_ROM_WRITE_PAGE_SIZE, (programLength - pageOffset));
+			uint32_t headerBytes = (pageAddress < ENGINE_ROM_MAGIC_HASH_LENGTH)
+				? (ENGINE_ROM_MAGIC_HASH_LENGTH - pageAddress)
+				: 0;
+			EngineROM_SD_WriteBegin(
+				pageAddress + headerBytes,
+				writeSize - headerBytes,
+				programBuffer + pageOffset + headerBytes
+			);
+			//while the chip programs that page, pull the next slice off the SD card:
+			if(readOffset < readLength){
+				uint32_t sliceSize = MIN(ENGINE_ROM_WRITE_PAGE_SIZE, (readLength - readOffset));
+				EngineROM_SD_ReadNext(gameDat, sliceSize, readBuffer + readOffset);
+				readOffset += sliceSize;
+			}
+			EngineROM_SD_WriteEnd();
+		}
+		if(readOffset < readLength){
+			EngineROM_SD_ReadNext(gameDat, readLength - readOffset, readBuffer + readOffset);
+		}
+		programAddress = readAddress;
+		programLength = readLength;
+		programIndex ^= 1;
+	}
 }
 
-#ifdef DC801_EMBEDDED
 //this will copy from the file `MAGE/game.dat` on the SD card into the ROM chip.
-bool EngineROM_SD_Copy(uint32_t gameDatFilesize, FIL gameDat){
+//Each ENGINE_ROM_ERASE_PAGE_SIZE block is compared against the ROM first,
+//and only blocks that differ are erased and programmed, so small edits to a
+//large game.dat don't cost a full reflash.
+//Instead of reading back every page after writing it, a running crc32 of the
+//ROM is built as each block is finished and compared to the crc32 in the
+//game.dat header at the end. Only then is the header itself written, so an
+//interrupted or bad copy never looks like a playable game.dat on the next boot.
+bool EngineROM_SD_Copy(
+	uint32_t gameDatFilesize,
+	FIL *gameDat,
+	EngineROM_CopyStats *stats
+){
 	if(gameDatFilesize > ENGINE_ROM_MAX_DAT_FILE_SIZE){
 		ENGINE_PANIC("Your game.dat is larger than 33550336 bytes.\nYou will need to reduce its size to use it\non this board.");
 	}
+	if(gameDatFilesize < ENGINE_ROM_MAGIC_HASH_LENGTH){
+		ENGINE_PANIC("Your game.dat is too small to have a header.");
+	}
 	char debugString[128];
-	FRESULT result;
-	UINT count;
-	p_canvas()->clearScreen(COLOR_BLACK);
-	p_canvas()->printMessage(
-		"Erasing ROM chip",
-		Monaco9,
-		COLOR_WHITE,
-		16,
-		96
+	uint32_t copyStartTime = millis();
+	EngineROM_SD_CopyProgress(NULL);
+	//both get programmed straight from, and QSPI needs them word aligned:
+	alignas(4) uint8_t strBuffer[ENGINE_ROM_SD_CHUNK_READ_SIZE] {0};
+	alignas(4) uint8_t gameDatHeader[ENGINE_ROM_MAGIC_HASH_LENGTH];
+	EngineROM_SD_ReadChunk(
+		gameDat,
+		0,
+		ENGINE_ROM_MAGIC_HASH_LENGTH,
+		gameDatHeader
 	);
-	p_canvas()->blt();
-	//then write the entire SD card game.dat file to the ROM chip MAGE_SD_CHUNK_READ_SIZE bytes at a time.
-	uint32_t currentAddress = 0;
-	uint8_t strBuffer[ENGINE_ROM_SD_CHUNK_READ_SIZE] {0};
-	// I mean, you _COULD_ start by erasing the whole chip...
-	// if(!qspiControl.chipErase()){
-	// 	ENGINE_PANIC("Failed to erase ROM Chip.");
-	// }
-	// or you could do it one page at a time, so it saves a LOT of time
-	while(currentAddress < gameDatFilesize){
-		if(!qspiControl.erase(tBlockSize::BLOCK_SIZE_256K, currentAddress)){
-			ENGINE_PANIC("Failed to send erase comand.");
+	uint32_t headerCRC32;
+	uint32_t headerLength;
+	memcpy(&headerCRC32, gameDatHeader + ENGINE_ROM_IDENTIFIER_STRING_LENGTH, sizeof(headerCRC32));
+	memcpy(&headerLength, gameDatHeader + ENGINE_ROM_IDENTIFIER_STRING_LENGTH + ENGINE_ROM_CRC32_LENGTH, sizeof(headerLength));
+	headerCRC32 = ROM_ENDIAN_U4_VALUE(headerCRC32);
+	headerLength = MIN(ROM_ENDIAN_U4_VALUE(headerLength), gameDatFilesize);
+	uint32_t romCRC32 = 0;
+	bool headerWasErased = false;
+	EngineROM_CopyStats copyStats = {
+		.blocksTotal = (
+			(gameDatFilesize + ENGINE_ROM_ERASE_PAGE_SIZE - 1)
+			/ ENGINE_ROM_ERASE_PAGE_SIZE
+		),
+		.blocksSkipped = 0,
+		.blocksWritten = 0,
+		.bytesWritten = 0,
+		.milliseconds = 0,
+	};
+	for(uint32_t blockIndex = 0; blockIndex < copyStats.blocksTotal; blockIndex++){
+		uint32_t blockAddress = blockIndex * ENGINE_ROM_ERASE_PAGE_SIZE;
+		uint32_t blockSize = MIN(ENGINE_ROM_ERASE_PAGE_SIZE, (gameDatFilesize - blockAddress));
+		if(EngineROM_SD_BlockMatchesROM(gameDat, blockAddress, blockSize, strBuffer)){
+			copyStats.blocksSkipped++;
+		} else {
+			EngineROM_SD_FlashBlock(gameDat, blockAddress, blockSize, strBuffer);
+			copyStats.blocksWritten++;
+			copyStats.bytesWritten += blockSize;
+			headerWasErased |= (blockAddress == 0);
 		}
-		while(qspiControl.isBusy()){
-			// is very busy
+		//add what is now on the ROM for this block to the running crc32:
+		uint32_t crcStart = MAX(blockAddress, ENGINE_ROM_MAGIC_HASH_LENGTH);
+		uint32_t crcEnd = MIN(blockAddress + blockSize, headerLength);
+		if(crcEnd > crcStart){
+			romCRC32 = crc32_update(
+				romCRC32,
+				EngineROM_View(crcStart, crcEnd - crcStart),
+				crcEnd - crcStart
+			);
 		}
 		//Debug Print:
 		sprintf(
 			debugString,
-			"Erasing currentAddress: %08u\ngameDatFilesize:%08u",
-			currentAddress,
-			gameDatFilesize
-		);
-		p_canvas()->fillRect(
-			0,
-			96,
-			WIDTH,
-			96,
-			COLOR_BLACK
-		);
-		p_canvas()->printMessage(
-			debugString,
-			Monaco9,
-			COLOR_WHITE,
-			16,
-			96
+			"Block: %4u/%4u\n"
+			"Written: %4u\n"
+			"Skipped: %4u",
+			blockIndex + 1,
+			copyStats.blocksTotal,
+			copyStats.blocksWritten,
+			copyStats.blocksSkipped
 		);
-		p_canvas()->blt();
-		currentAddress += ENGINE_ROM_ERASE_PAGE_SIZE;
+		EngineROM_SD_CopyProgress(debugString);
 	}
 
-	// erase save games at the end of ROM chip too when copying
-	// because new dat files means new save flags and variables
-	for(uint8_t i = 0; i < ENGINE_ROM_SAVE_GAME_SLOTS; i++) {
-		EngineROM_EraseSaveSlot(i);
-	}
-
-	currentAddress = 0;
-	while(currentAddress < gameDatFilesize){
-		uint32_t chunkSize = MIN(ENGINE_ROM_SD_CHUNK_READ_SIZE, (gameDatFilesize - currentAddress));
-		//seek to the currentAddress on the SD card:
-		result = f_lseek(&gameDat, currentAddress);
-		if (result != FR_OK) {
-			ENGINE_PANIC("Error seeking to game.dat position\nduring ROM erase procedure.");
-		}
-		//then read the next set of bytes into the buffer:
-		result = f_read(
-			&gameDat,
-			strBuffer,
-			chunkSize,
-			&count
-		);
-		if (result != FR_OK) {
-			ENGINE_PANIC("Error reading game.dat from SD card\nduring ROM erase procedure.");
-		}
-		//write the buffer to the ROM chip:
-		uint32_t romPagesToWrite = chunkSize / ENGINE_ROM_WRITE_PAGE_SIZE;
-		uint32_t partialPageBytesLeftOver = chunkSize % ENGINE_ROM_WRITE_PAGE_SIZE;
-		if(partialPageBytesLeftOver){
-			romPagesToWrite += 1;
-		}
-		for(uint32_t i=0; i<romPagesToWrite; i++)
-		{
-			//debug_print("Writing ROM Page %d/%d offset from %d", i, romPagesToWrite, currentAddress);
-			uint32_t romPageOffset = i*ENGINE_ROM_WRITE_PAGE_SIZE;
-			bool shouldUsePartialBytes = (i == (romPagesToWrite - 1)) && (partialPageBytesLeftOver != 0);
-			uint32_t writeSize = shouldUsePartialBytes
-				? partialPageBytesLeftOver
-				: ENGINE_ROM_WRITE_PAGE_SIZE;
-
-			if(i == (romPagesToWrite - 1)){
-				debug_print("Write Size at %d is %d", i, writeSize);
-			}
-			EngineROM_Write(
-				currentAddress + romPageOffset,
-				writeSize,
-				(uint8_t *)(strBuffer + romPageOffset),
-				"Failed to write buffer to ROM chip\nduring ROM erase procedure."
-			);
-			//verify that the data was correctly written or return false.
-			EngineROM_Verify(
-				currentAddress + romPageOffset,
-				writeSize,
-				(uint8_t *)(strBuffer + romPageOffset),
-				true
-			);
-		}
-		//Debug Print:
+	if(romCRC32 != headerCRC32){
 		sprintf(
 			debugString,
-			"Copying currentAddress: %08u\ngameDatFilesize:%08u",
-			currentAddress,
-			gameDatFilesize
+			"ROM chip crc32 does not match game.dat\n"
+			"after copy.\n"
+			"game.dat: %08X\n"
+			"     ROM: %08X",
+			(unsigned int)headerCRC32,
+			(unsigned int)romCRC32
 		);
-		p_canvas()->fillRect(
+		ENGINE_PANIC(debugString);
+	}
+	//the copy checks out, now make it playable:
+	if(headerWasErased){
+		EngineROM_Write(
 			0,
-			96,
-			WIDTH,
-			96,
-			COLOR_BLACK
+			ENGINE_ROM_MAGIC_HASH_LENGTH,
+			gameDatHeader,
+			"Failed to write game.dat header to ROM chip."
 		);
-		p_canvas()->printMessage(
-			debugString,
-			Monaco9,
-			COLOR_WHITE,
-			16,
-			96
+		EngineROM_Verify(
+			0,
+			ENGINE_ROM_MAGIC_HASH_LENGTH,
+			gameDatHeader,
+			true
 		);
-		p_canvas()->blt();
-		currentAddress += chunkSize;
 	}
+
+	// erase save games at the end of ROM chip too when anything was copied
+	// because new dat files means new save flags and variables
+	#ifdef DC801_EMBEDDED
+	if(copyStats.blocksWritten){
+		EngineSaveLog_EraseAll();
+	}
+	#endif //DC801_EMBEDDED
+	copyStats.milliseconds = millis() - copyStartTime;
+
 	//print success message:
-	p_canvas()->fillRect(
-		0,
-		96,
-		WIDTH,
-		96,
-		0x0000
+	sprintf(
+		debugString,
+		"SD -> ROM chip copy success\n"
+		"Written: %4u blocks\n"
+		"Skipped: %4u blocks\n"
+		"Took: %ums",
+		copyStats.blocksWritten,
+		copyStats.blocksSkipped,
+		copyStats.milliseconds
 	);
-	p_canvas()->printMessage(
-		"SD -> ROM chip copy success",
-		Monaco9,
-		0xffff,
-		16,
-		96
-	);
-	p_canvas()->blt();
+	EngineROM_SD_CopyProgress(debugString);
+	if(stats != NULL){
+		*stats = copyStats;
+	}
 	return true;
 }
-#endif //DC801_EMBEDDED
 
 void EngineROM_Deinit() {
 #ifdef DC801_DESKTOP
+	if (romDataInDesktopRam == NULL) {
+		return;
+	}
+#ifdef EMSCRIPTEN
+	free(romDataInDesktopRam);
+#else
+	// also releases any copy-on-write pages made by EngineROM_Write
+	munmap(romDataInDesktopRam, romDataInDesktopRamSize);
+#endif // EMSCRIPTEN
+	romDataInDesktopRam = NULL;
+	romDataInDesktopRamSize = 0;
 #endif // DC801_DESKTOP
 }
 
@@ -578,11 +828,58 @@ bool EngineROM_Read(
 	}
 #endif // DC801_EMBEDDED
 #ifdef DC801_DESKTOP
+	if (romDataInDesktopRam == NULL || data == NULL)
+	{
+		ENGINE_PANIC("EngineROM_Read: Game Data is not loaded");
+	}
+	if (length > romDataInDesktopRamSize || address > romDataInDesktopRamSize - length)
+	{
+		ENGINE_PANIC(errorString);
+	}
 	memcpy(data, romDataInDesktopRam + address, length);
 #endif // DC801_DESKTOP
 	return true;
 }
 
+static EngineROM_ViewStats viewStats = {};
+
+const uint8_t *EngineROM_View(
+	uint32_t address,
+	uint32_t length
+)
+{
+	viewStats.views++;
+	viewStats.bytes += length;
+#ifdef DC801_EMBEDDED
+	if (address + length > ENGINE_ROM_QSPI_CHIP_SIZE)
+	{
+		ENGINE_PANIC("EngineROM_View: Address out of range");
+	}
+	return (const uint8_t *)(ROM_START_ADDRESS + address);
+#endif // DC801_EMBEDDED
+#ifdef DC801_DESKTOP
+	if (romDataInDesktopRam == NULL)
+	{
+		ENGINE_PANIC("EngineROM_View: Game Data is not loaded");
+	}
+	if (length > romDataInDesktopRamSize || address > romDataInDesktopRamSize - length)
+	{
+		ENGINE_PANIC("EngineROM_View: Address out of range");
+	}
+	return romDataInDesktopRam + address;
+#endif // DC801_DESKTOP
+}
+
+const EngineROM_ViewStats *EngineROM_GetViewStats()
+{
+	return &viewStats;
+}
+
+void EngineROM_ResetViewStats()
+{
+	viewStats = {};
+}
+
 bool EngineROM_Write(
 	uint32_t address,
 	uint32_t length,
@@ -597,6 +894,13 @@ bool EngineROM_Write(
 			"sending an unaligned write."
 		);
 	}
+	if((uintptr_t)data % sizeof(uint32_t)){
+		ENGINE_PANIC(
+			"Data of write is not aligned to uint32_t\n"
+			"The QSPI driver can't send it, fix\n"
+			"whatever is passing an unaligned buffer."
+		);
+	}
 #ifdef DC801_EMBEDDED
 	if (data == NULL)
 	{
@@ -610,17 +914,17 @@ bool EngineROM_Write(
 	return true;
 #endif // DC801_EMBEDDED
 #ifdef DC801_DESKTOP
-	if (romfile == NULL || data == NULL)
+	if (romDataInDesktopRam == NULL || data == NULL)
 	{
-		ENGINE_PANIC("Game Data file is not open");
+		ENGINE_PANIC("Game Data is not loaded");
 	}
-
-	if (fseek(romfile, address, SEEK_SET) != 0)
+	if (length > romDataInDesktopRamSize || address > romDataInDesktopRamSize - length)
 	{
-		ENGINE_PANIC("Failed to seek into Game Data");
+		ENGINE_PANIC(errorString);
 	}
-
-	return fwrite(data, sizeof(uint8_t), length, romfile) == length;
+	makeDesktopRomWritable(address, length);
+	memcpy(romDataInDesktopRam + address, data, length);
+	return true;
 #endif // DC801_DESKTOP
 }
 
@@ -4,6 +4,10 @@
 //size of chunk to be read/written when writing game.dat to ROM per loop
 #define ENGINE_ROM_SD_CHUNK_READ_SIZE 65536
 
+//the SD -> ROM copy splits its chunk buffer in two, so the next half can be
+//read from the SD card while the previous half is being programmed
+#define ENGINE_ROM_SD_PIPELINE_BUFFER_SIZE (ENGINE_ROM_SD_CHUNK_READ_SIZE / 2)
+
 //This is the smallest page we know how to erase on our chip,
 //because the smaller values provided by nordic are incorrect, 
 //and this is the only one that has worked for us so far
@@ -62,6 +66,25 @@ bool EngineROM_Read(
 	uint8_t *data,
 	const char *errorString
 );
+//Returns a pointer straight into ROM without copying anything:
+//on embedded this is the memory-mapped QSPI (XIP) window at ROM_START_ADDRESS,
+//on desktop it is the mapped game.dat buffer. The whole range is bounds checked.
+//Both backings start on a (at least) 4 byte boundary, so the pointer has exactly
+//the alignment of `address`. Data in game.dat is padded to 4 bytes, but if you
+//can't prove the field you want is aligned, memcpy it out of the view instead
+//of casting the pointer. The data is still ROM endian, use ROM_ENDIAN_* on it.
+const uint8_t *EngineROM_View(
+	uint32_t address,
+	uint32_t length
+);
+//how much has been asked of EngineROM_View since EngineROM_ResetViewStats,
+//which is what has to come over QSPI on the badge:
+typedef struct {
+	uint32_t views;
+	uint32_t bytes;
+} EngineROM_ViewStats;
+const EngineROM_ViewStats *EngineROM_GetViewStats();
+void EngineROM_ResetViewStats();
 bool EngineROM_Write(
 	uint32_t address,
 	uint32_t length,
@@ -74,18 +97,40 @@ uint32_t EngineROM_Verify(
 	const uint8_t *data,
 	bool throwErrorWithLog
 );
-uint32_t getSaveSlotAddressByIndex(uint8_t slotIndex);
 void EngineROM_ReadSaveSlot(
 	uint8_t slotIndex,
 	size_t length,
 	uint8_t *data
 );
-void EngineROM_EraseSaveSlot(uint8_t slotIndex);
+//only starts the save, it is finished in the background by EngineSaveLog_Step.
+//the data is copied, so it can be changed again as soon as this returns:
 void EngineROM_WriteSaveSlot(
 	uint8_t slotIndex,
 	size_t length,
 	uint8_t *hauntedDataPointer
 );
-bool EngineROM_SD_Copy(uint32_t gameDatFilesize, FIL gameDat);
+void EngineROM_EraseBlock(uint32_t address);
+//Starts erasing a block without waiting for it. The erase only makes progress
+//inside EngineROM_EraseBlockContinue, so the ROM chip stays readable (and the
+//game keeps running) between calls. Nothing else may be written to the chip
+//until EngineROM_EraseBlockContinue has returned true.
+void EngineROM_EraseBlockBegin(uint32_t address);
+//Lets the erase run for up to `milliseconds`, returns true once it is done:
+bool EngineROM_EraseBlockContinue(uint32_t milliseconds);
+
+//how many ENGINE_ROM_ERASE_PAGE_SIZE blocks an SD -> ROM copy had to touch
+typedef struct {
+	uint32_t blocksTotal;
+	uint32_t blocksSkipped;
+	uint32_t blocksWritten;
+	uint32_t bytesWritten;
+	uint32_t milliseconds;
+} EngineROM_CopyStats;
+
+bool EngineROM_SD_Copy(
+	uint32_t gameDatFilesize,
+	FIL *gameDat,
+	EngineROM_CopyStats *stats
+);
 
 #endif
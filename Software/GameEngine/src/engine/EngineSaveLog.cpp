@@ -0,0 +1,754 @@
+#include "EngineSaveLog.h"
+#include "EnginePanic.h"
+
+#include <stddef.h>
+
+#ifdef DC801_DESKTOP
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef EMSCRIPTEN
+#include <emscripten.h>
+#else
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif // EMSCRIPTEN
+
+#define DESKTOP_SAVE_FILE_PATH "MAGE/save_games/"
+
+//test builds point this somewhere else so they don't eat your saves:
+#ifndef DESKTOP_SAVE_LOG_FILE_PATH
+#define DESKTOP_SAVE_LOG_FILE_PATH DESKTOP_SAVE_FILE_PATH "save_log.dat"
+#endif
+
+//the one-file-per-slot saves from before the log, imported into an empty log:
+#define DESKTOP_LEGACY_SAVE_FILE_PATH DESKTOP_SAVE_FILE_PATH "save_%d.dat"
+
+//typical timings for our ROM chip (S25FL256S), from its datasheet:
+#define DESKTOP_FLASH_PAGE_SIZE 512
+#define DESKTOP_FLASH_PAGE_PROGRAM_MICROSECONDS 340
+#define DESKTOP_FLASH_SEGMENT_ERASE_MICROSECONDS 520000
+
+//The desktop build doesn't keep saves on a ROM chip, so this emulates the
+//save area of one in RAM: an erase sets every bit to 1, and programming can
+//only clear bits, same as the real thing, so the log gets exercised the same
+//way it does on a badge. It is backed by a file so saves survive a restart.
+uint8_t saveLogInDesktopRam[ENGINE_ROM_SAVE_RESERVED_MEMORY_SIZE];
+
+typedef struct {
+	uint32_t offset;
+	uint32_t length;
+	//erases set the whole range to 0xFF, programs AND `data` into it:
+	bool erase;
+	uint32_t microseconds;
+	#ifndef EMSCRIPTEN
+	std::vector<uint8_t> data;
+	#else
+	const uint8_t *data;
+	#endif // EMSCRIPTEN
+} DesktopFlashOperation;
+
+#ifndef EMSCRIPTEN
+//Flash operations are handed to a worker thread that applies them and then
+//sleeps for as long as the real chip would take, so the game loop sees the
+//same "busy for a while" behaviour it gets on a badge.
+static std::mutex saveLogWorkerMutex;
+static std::condition_variable saveLogWorkerWake;
+static std::deque<DesktopFlashOperation> saveLogWorkerQueue;
+static std::atomic<uint32_t> saveLogWorkerPending(0);
+static bool saveLogWorkerQuit = false;
+static std::thread saveLogWorkerThread;
+#endif // EMSCRIPTEN
+
+void makeSureSaveFilePathExists() {
+	struct stat st = {0};
+	if (stat(DESKTOP_SAVE_FILE_PATH, &st) == -1) {
+		mkdir(DESKTOP_SAVE_FILE_PATH, 0777);
+	}
+}
+
+static void saveLogPersistDesktop(uint32_t offset, uint32_t length) {
+	makeSureSaveFilePathExists();
+	FILE *saveLogFile = fopen(DESKTOP_SAVE_LOG_FILE_PATH, "r+b");
+	if (saveLogFile == NULL) {
+		int error = errno;
+		fprintf(stderr, "Error: %s\n", strerror(error));
+		ENGINE_PANIC("Desktop build: SAVE log file missing");
+	}
+	fseek(saveLogFile, offset, SEEK_SET);
+	fwrite(
+		saveLogInDesktopRam + offset,
+		length,
+		1,
+		saveLogFile
+	);
+	fclose(saveLogFile);
+}
+
+static void saveLogLoadDesktop() {
+	makeSureSaveFilePathExists();
+	FILE *saveLogFile = fopen(DESKTOP_SAVE_LOG_FILE_PATH, "rb");
+	bool loaded = false;
+	if (saveLogFile != NULL) {
+		loaded = fread(
+			saveLogInDesktopRam,
+			ENGINE_ROM_SAVE_RESERVED_MEMORY_SIZE,
+			1,
+			saveLogFile
+		) == 1;
+		fclose(saveLogFile);
+	}
+	if (!loaded) {
+		// missing or the wrong size, start over with a freshly erased one
+		memset(saveLogInDesktopRam, 0xFF, ENGINE_ROM_SAVE_RESERVED_MEMORY_SIZE);
+		saveLogFile = fopen(DESKTOP_SAVE_LOG_FILE_PATH, "wb");
+		if (saveLogFile == NULL) {
+			int error = errno;
+			fprintf(stderr, "Error: %s\n", strerror(error));
+			ENGINE_PANIC("Desktop build: SAVE log file cannot be created");
+		}
+		fwrite(
+			saveLogInDesktopRam,
+			ENGINE_ROM_SAVE_RESERVED_MEMORY_SIZE,
+			1,
+			saveLogFile
+		);
+		fclose(saveLogFile);
+	}
+}
+
+static void saveLogApplyDesktop(const DesktopFlashOperation &operation) {
+	uint8_t *flash = saveLogInDesktopRam + operation.offset;
+	if (operation.erase) {
+		memset(flash, 0xFF, operation.length);
+	} else {
+		const uint8_t *data = &operation.data[0];
+		bool programmedOverZeros = false;
+		for (uint32_t i = 0; i < operation.length; i++) {
+			programmedOverZeros |= (data[i] & ~flash[i]) != 0;
+			flash[i] &= data[i];
+		}
+		if (programmedOverZeros) {
+			// a real chip can't do that, so this is a bug in the log
+			debug_print("SAVE log: programmed over bits that were not erased at %u", operation.offset);
+		}
+	}
+	saveLogPersistDesktop(operation.offset, operation.length);
+}
+
+#ifndef EMSCRIPTEN
+static void saveLogWorker() {
+	while (true) {
+		std::unique_lock<std::mutex> lock(saveLogWorkerMutex);
+		saveLogWorkerWake.wait(lock, [] {
+			return saveLogWorkerQuit || !saveLogWorkerQueue.empty();
+		});
+		//everything it was handed gets to the file before it quits:
+		if (saveLogWorkerQueue.empty()) {
+			break;
+		}
+		DesktopFlashOperation operation = std::move(saveLogWorkerQueue.front());
+		saveLogWorkerQueue.pop_front();
+		lock.unlock();
+		saveLogApplyDesktop(operation);
+		std::this_thread::sleep_for(std::chrono::microseconds(operation.microseconds));
+		saveLogWorkerPending--;
+	}
+}
+
+static void stopSaveLogWorker();
+#endif // EMSCRIPTEN
+
+static void saveLogSubmitDesktop(DesktopFlashOperation operation) {
+	#ifndef EMSCRIPTEN
+	if (!saveLogWorkerThread.joinable()) {
+		static bool stopRegistered = false;
+		saveLogWorkerQuit = false;
+		saveLogWorkerThread = std::thread(saveLogWorker);
+		//exit() from a panic or a test skips EngineSaveLog_Deinit, and a
+		//std::thread that's still running when it gets destroyed aborts:
+		if (!stopRegistered) {
+			atexit(stopSaveLogWorker);
+			stopRegistered = true;
+		}
+	}
+	saveLogWorkerPending++;
+	{
+		std::lock_guard<std::mutex> lock(saveLogWorkerMutex);
+		saveLogWorkerQueue.push_back(std::move(operation));
+	}
+	saveLogWorkerWake.notify_one();
+	#else
+	// no threads here, so the web build just saves right away
+	saveLogApplyDesktop(operation);
+	#endif // EMSCRIPTEN
+}
+#endif //DC801_DESKTOP
+
+typedef enum {
+	SAVE_LOG_IDLE = 0,
+	//copying live records out of the segment about to be erased:
+	SAVE_LOG_MOVING_RECORDS,
+	SAVE_LOG_ERASING,
+	SAVE_LOG_PROGRAMMING_DATA,
+	SAVE_LOG_PROGRAMMING_HEADER,
+	//waiting on the header to finish programming:
+	SAVE_LOG_FINISHING,
+} EngineSaveLog_WriteState;
+
+static EngineSaveLog_Stats saveLogStats = {};
+//the sector holding the live record of each slot, or ENGINE_SAVE_LOG_NO_RECORD:
+static uint32_t slotRecordSectors[ENGINE_ROM_SAVE_GAME_SLOTS];
+static uint32_t nextSequence = 0;
+//where the next record goes; writeSectorInSegment can reach
+//ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT, meaning the segment is full
+static uint8_t writeSegment = 0;
+static uint32_t writeSectorInSegment = 0;
+
+static EngineSaveLog_WriteState writeState = SAVE_LOG_IDLE;
+//the save being written: room for a record header, followed by a snapshot of
+//the data passed to EngineSaveLog_StartWrite, so the game can keep changing
+//its copy while this one is written. This also means the data is never written
+//from the pointer we were given, see `hauntedDataPointer` in
+//EngineROM_WriteSaveSlot for why that matters.
+//the QSPI driver only takes word aligned buffers, so both of these are:
+alignas(4) static uint8_t stagingRecord[ENGINE_SAVE_LOG_SECTOR_SIZE];
+//a live record on its way out of the segment about to be erased. it can't
+//go through stagingRecord, that's still holding the save waiting behind it:
+alignas(4) static uint8_t movingRecord[ENGINE_SAVE_LOG_SECTOR_SIZE];
+static uint8_t stagingSlotIndex = 0;
+static uint32_t stagingLength = 0;
+static uint32_t stagingSector = 0;
+#ifdef DC801_EMBEDDED
+static bool eraseInProgress = false;
+#endif //DC801_EMBEDDED
+
+static const uint8_t *saveLogView(uint32_t offset, uint32_t length) {
+	#ifdef DC801_EMBEDDED
+	return EngineROM_View(ENGINE_ROM_SAVE_OFFSET + offset, length);
+	#endif //DC801_EMBEDDED
+	#ifdef DC801_DESKTOP
+	if (offset + length > ENGINE_ROM_SAVE_RESERVED_MEMORY_SIZE) {
+		ENGINE_PANIC("Desktop build: SAVE log read out of range");
+	}
+	return saveLogInDesktopRam + offset;
+	#endif //DC801_DESKTOP
+}
+
+//a page program is well under a millisecond, so
+//the embedded build just does them on the spot
+static void saveLogProgram(uint32_t offset, uint32_t length, uint8_t *data) {
+	//EngineROM_Write checks this too, but desktop saves don't go through it:
+	if ((uintptr_t)data % sizeof(uint32_t)) {
+		ENGINE_PANIC("Save log data is not word aligned");
+	}
+	#ifdef DC801_EMBEDDED
+	uint32_t programStartTime = millis();
+	for (uint32_t written = 0; written < length; written += ENGINE_ROM_WRITE_PAGE_SIZE) {
+		EngineROM_Write(
+			ENGINE_ROM_SAVE_OFFSET + offset + written,
+			MIN(ENGINE_ROM_WRITE_PAGE_SIZE, (length - written)),
+			data + written,
+			"Failed to write save data into ROM"
+		);
+	}
+	saveLogStats.programMicroseconds += (millis() - programStartTime) * 1000;
+	#endif //DC801_EMBEDDED
+	#ifdef DC801_DESKTOP
+	uint32_t pagesTouched = (
+		((offset + length - 1) / DESKTOP_FLASH_PAGE_SIZE)
+		- (offset / DESKTOP_FLASH_PAGE_SIZE)
+		+ 1
+	);
+	DesktopFlashOperation operation;
+	operation.offset = offset;
+	operation.length = length;
+	operation.erase = false;
+	operation.microseconds = pagesTouched * DESKTOP_FLASH_PAGE_PROGRAM_MICROSECONDS;
+	#ifndef EMSCRIPTEN
+	operation.data.assign(data, data + length);
+	#else
+	operation.data = data;
+	#endif // EMSCRIPTEN
+	saveLogStats.programMicroseconds += operation.microseconds;
+	saveLogSubmitDesktop(std::move(operation));
+	#endif //DC801_DESKTOP
+	saveLogStats.bytesProgrammed += length;
+}
+
+//only starts the erase, saveLogFlashBusy() says when it's done
+static void saveLogEraseSegment(uint8_t segmentIndex) {
+	uint32_t offset = segmentIndex * ENGINE_SAVE_LOG_SEGMENT_SIZE;
+	#ifdef DC801_EMBEDDED
+	EngineROM_EraseBlockBegin(ENGINE_ROM_SAVE_OFFSET + offset);
+	eraseInProgress = true;
+	#endif //DC801_EMBEDDED
+	#ifdef DC801_DESKTOP
+	DesktopFlashOperation operation;
+	operation.offset = offset;
+	operation.length = ENGINE_SAVE_LOG_SEGMENT_SIZE;
+	operation.erase = true;
+	operation.microseconds = DESKTOP_FLASH_SEGMENT_ERASE_MICROSECONDS;
+	saveLogStats.eraseMicroseconds += operation.microseconds;
+	saveLogSubmitDesktop(std::move(operation));
+	#endif //DC801_DESKTOP
+	saveLogStats.segmentErases++;
+}
+
+//true while the flash is still working on something. on embedded,
+//this is also what gives a pending erase its next slice of time.
+static bool saveLogFlashBusy() {
+	#ifdef DC801_EMBEDDED
+	if (eraseInProgress) {
+		uint32_t eraseStartTime = millis();
+		eraseInProgress = !EngineROM_EraseBlockContinue(
+			ENGINE_SAVE_LOG_ERASE_TIME_SLICE_MILLISECONDS
+		);
+		saveLogStats.eraseMicroseconds += (millis() - eraseStartTime) * 1000;
+	}
+	return eraseInProgress;
+	#endif //DC801_EMBEDDED
+	#ifdef DC801_DESKTOP
+	#ifndef EMSCRIPTEN
+	return saveLogWorkerPending != 0;
+	#else
+	return false;
+	#endif // EMSCRIPTEN
+	#endif //DC801_DESKTOP
+}
+
+static void saveLogFlashWait() {
+	while (saveLogFlashBusy()) {
+		#ifdef DC801_DESKTOP
+		#ifndef EMSCRIPTEN
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		#endif // EMSCRIPTEN
+		#endif //DC801_DESKTOP
+	}
+}
+
+static bool saveLogReadRecordHeader(
+	uint32_t sector,
+	EngineSaveLog_RecordHeader *header
+) {
+	const uint8_t identifier[] = ENGINE_SAVE_LOG_IDENTIFIER_STRING;
+	uint32_t offset = sector * ENGINE_SAVE_LOG_SECTOR_SIZE;
+	memcpy(header, saveLogView(offset, sizeof(*header)), sizeof(*header));
+	if (memcmp(header->identifier, identifier, ENGINE_ROM_IDENTIFIER_STRING_LENGTH) != 0) {
+		return false;
+	}
+	header->sequence = ROM_ENDIAN_U4_VALUE(header->sequence);
+	header->length = ROM_ENDIAN_U4_VALUE(header->length);
+	header->crc32 = ROM_ENDIAN_U4_VALUE(header->crc32);
+	if (
+		header->slotIndex >= ENGINE_ROM_SAVE_GAME_SLOTS
+		|| header->length > ENGINE_SAVE_LOG_MAX_RECORD_LENGTH
+	) {
+		return false;
+	}
+	uint32_t crc = crc32_update(
+		0,
+		saveLogView(offset, offsetof(EngineSaveLog_RecordHeader, crc32)),
+		offsetof(EngineSaveLog_RecordHeader, crc32)
+	);
+	crc = crc32_update(
+		crc,
+		saveLogView(offset + sizeof(*header), header->length),
+		header->length
+	);
+	return crc == header->crc32;
+}
+
+static bool saveLogSectorIsErased(uint32_t sector) {
+	const uint8_t *data = saveLogView(
+		sector * ENGINE_SAVE_LOG_SECTOR_SIZE,
+		ENGINE_SAVE_LOG_SECTOR_SIZE
+	);
+	for (uint32_t i = 0; i < ENGINE_SAVE_LOG_SECTOR_SIZE; i++) {
+		if (data[i] != 0xFF) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static uint32_t saveLogAlignedRecordLength(uint32_t length) {
+	// ROM writes must be uint32_t aligned
+	return (sizeof(EngineSaveLog_RecordHeader) + length + 3) & ~3;
+}
+
+//claims the next free sector and fills in the header of a record
+//whose data is already sitting right after it
+static uint32_t saveLogPrepareRecord(
+	uint8_t *record,
+	uint8_t slotIndex,
+	uint32_t length
+) {
+	if (writeSectorInSegment >= ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT) {
+		ENGINE_PANIC("Save log has no room left in this segment");
+	}
+	uint32_t sector = (writeSegment * ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT) + writeSectorInSegment;
+	writeSectorInSegment++;
+	// the alignment tail is left erased
+	uint32_t recordLength = saveLogAlignedRecordLength(length);
+	memset(
+		record + sizeof(EngineSaveLog_RecordHeader) + length,
+		0xFF,
+		recordLength - sizeof(EngineSaveLog_RecordHeader) - length
+	);
+	EngineSaveLog_RecordHeader header = {
+		.identifier = ENGINE_SAVE_LOG_IDENTIFIER_STRING,
+		.sequence = ROM_ENDIAN_U4_VALUE(nextSequence),
+		.length = ROM_ENDIAN_U4_VALUE(length),
+		.slotIndex = slotIndex,
+		.paddingA = 0,
+		.paddingB = 0,
+		.paddingC = 0,
+		.crc32 = 0,
+	};
+	nextSequence++;
+	uint32_t crc = crc32_update(
+		0,
+		(uint8_t *)&header,
+		offsetof(EngineSaveLog_RecordHeader, crc32)
+	);
+	crc = crc32_update(crc, record + sizeof(header), length);
+	header.crc32 = ROM_ENDIAN_U4_VALUE(crc);
+	memcpy(record, &header, sizeof(header));
+	return sector;
+}
+
+// the data goes in before the header, so a record cut short
+// by a power loss never has a valid identifier
+static void saveLogProgramRecordData(
+	uint32_t sector,
+	uint32_t length,
+	uint8_t *record
+) {
+	saveLogProgram(
+		(sector * ENGINE_SAVE_LOG_SECTOR_SIZE) + sizeof(EngineSaveLog_RecordHeader),
+		saveLogAlignedRecordLength(length) - sizeof(EngineSaveLog_RecordHeader),
+		record + sizeof(EngineSaveLog_RecordHeader)
+	);
+}
+
+static void saveLogProgramRecordHeader(uint32_t sector, uint8_t *record) {
+	saveLogProgram(
+		sector * ENGINE_SAVE_LOG_SECTOR_SIZE,
+		sizeof(EngineSaveLog_RecordHeader),
+		record
+	);
+}
+
+static uint8_t saveLogLiveRecordsInSegment(
+	uint8_t segmentIndex,
+	uint8_t *firstSlotIndex
+) {
+	uint8_t count = 0;
+	for (uint8_t i = ENGINE_ROM_SAVE_GAME_SLOTS; i > 0; i--) {
+		uint32_t sector = slotRecordSectors[i - 1];
+		if (
+			sector != ENGINE_SAVE_LOG_NO_RECORD
+			&& (sector / ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT) == segmentIndex
+		) {
+			*firstSlotIndex = i - 1;
+			count++;
+		}
+	}
+	return count;
+}
+
+//copies the live record of a slot out of the segment about to be
+//erased, into the end of the current one
+static void saveLogMoveRecord(uint8_t slotIndex) {
+	uint32_t sector = slotRecordSectors[slotIndex];
+	EngineSaveLog_RecordHeader header;
+	if (!saveLogReadRecordHeader(sector, &header)) {
+		ENGINE_PANIC("Save log record went bad before it could be moved");
+	}
+	uint8_t *record = movingRecord;
+	memcpy(
+		record + sizeof(header),
+		saveLogView(
+			(sector * ENGINE_SAVE_LOG_SECTOR_SIZE) + sizeof(header),
+			header.length
+		),
+		header.length
+	);
+	uint32_t newSector = saveLogPrepareRecord(record, slotIndex, header.length);
+	saveLogProgramRecordData(newSector, header.length, record);
+	saveLogProgramRecordHeader(newSector, record);
+	slotRecordSectors[slotIndex] = newSector;
+	saveLogStats.recordsMoved++;
+}
+
+void EngineSaveLog_Init() {
+	EngineSaveLog_Flush();
+	#ifdef DC801_DESKTOP
+	saveLogLoadDesktop();
+	#endif //DC801_DESKTOP
+	uint32_t slotSequences[ENGINE_ROM_SAVE_GAME_SLOTS] = {0};
+	uint32_t newestSector = ENGINE_SAVE_LOG_NO_RECORD;
+	uint32_t newestSequence = 0;
+	for (uint8_t i = 0; i < ENGINE_ROM_SAVE_GAME_SLOTS; i++) {
+		slotRecordSectors[i] = ENGINE_SAVE_LOG_NO_RECORD;
+	}
+	for (uint32_t sector = 0; sector < ENGINE_SAVE_LOG_SECTOR_COUNT; sector++) {
+		EngineSaveLog_RecordHeader header;
+		if (!saveLogReadRecordHeader(sector, &header)) {
+			continue;
+		}
+		uint8_t slotIndex = header.slotIndex;
+		if (
+			slotRecordSectors[slotIndex] == ENGINE_SAVE_LOG_NO_RECORD
+			|| header.sequence > slotSequences[slotIndex]
+		) {
+			slotRecordSectors[slotIndex] = sector;
+			slotSequences[slotIndex] = header.sequence;
+		}
+		if (
+			newestSector == ENGINE_SAVE_LOG_NO_RECORD
+			|| header.sequence > newestSequence
+		) {
+			newestSector = sector;
+			newestSequence = header.sequence;
+		}
+	}
+	if (newestSector == ENGINE_SAVE_LOG_NO_RECORD) {
+		nextSequence = 0;
+		writeSegment = 0;
+		writeSectorInSegment = 0;
+	} else {
+		nextSequence = newestSequence + 1;
+		writeSegment = newestSector / ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT;
+		writeSectorInSegment = (newestSector % ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT) + 1;
+	}
+	// step over anything left half written by a power loss:
+	while (
+		writeSectorInSegment < ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT
+		&& !saveLogSectorIsErased(
+			(writeSegment * ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT) + writeSectorInSegment
+		)
+	) {
+		writeSectorInSegment++;
+	}
+	debug_print(
+		"EngineSaveLog_Init - next sequence: %u, segment: %u, sector: %u",
+		nextSequence,
+		writeSegment,
+		writeSectorInSegment
+	);
+	#ifdef DC801_DESKTOP
+	if (newestSector == ENGINE_SAVE_LOG_NO_RECORD) {
+		for (uint8_t i = 0; i < ENGINE_ROM_SAVE_GAME_SLOTS; i++) {
+			char legacySaveFileName[32];
+			uint8_t legacySave[ENGINE_SAVE_LOG_MAX_RECORD_LENGTH];
+			sprintf(legacySaveFileName, DESKTOP_LEGACY_SAVE_FILE_PATH, i);
+			FILE *legacySaveFile = fopen(legacySaveFileName, "rb");
+			if (legacySaveFile == NULL) {
+				continue;
+			}
+			size_t legacySaveLength = fread(
+				legacySave,
+				1,
+				sizeof(legacySave),
+				legacySaveFile
+			);
+			fclose(legacySaveFile);
+			if (legacySaveLength) {
+				debug_print("SAVE log: importing %s", legacySaveFileName);
+				EngineSaveLog_Write(i, legacySaveLength, legacySave);
+			}
+		}
+	}
+	#endif //DC801_DESKTOP
+}
+
+bool EngineSaveLog_Read(
+	uint8_t slotIndex,
+	uint32_t length,
+	uint8_t *data
+) {
+	EngineSaveLog_Flush();
+	EngineSaveLog_RecordHeader header;
+	uint32_t sector = (slotIndex < ENGINE_ROM_SAVE_GAME_SLOTS)
+		? slotRecordSectors[slotIndex]
+		: ENGINE_SAVE_LOG_NO_RECORD;
+	if (
+		sector == ENGINE_SAVE_LOG_NO_RECORD
+		|| !saveLogReadRecordHeader(sector, &header)
+	) {
+		// The slot was never saved?
+		// Empty out the destination.
+		memset(data, 0, length);
+		return false;
+	}
+	uint32_t recordLength = MIN(length, header.length);
+	memcpy(
+		data,
+		saveLogView(
+			(sector * ENGINE_SAVE_LOG_SECTOR_SIZE) + sizeof(header),
+			recordLength
+		),
+		recordLength
+	);
+	memset(data + recordLength, 0, length - recordLength);
+	return true;
+}
+
+void EngineSaveLog_StartWrite(
+	uint8_t slotIndex,
+	uint32_t length,
+	const uint8_t *data
+) {
+	if (slotIndex >= ENGINE_ROM_SAVE_GAME_SLOTS) {
+		ENGINE_PANIC("Invalid save slot index");
+	}
+	if (length > ENGINE_SAVE_LOG_MAX_RECORD_LENGTH) {
+		ENGINE_PANIC("Save data is too large for a save log record");
+	}
+	EngineSaveLog_Flush();
+	memcpy(stagingRecord + sizeof(EngineSaveLog_RecordHeader), data, length);
+	stagingSlotIndex = slotIndex;
+	stagingLength = length;
+	uint8_t nextSegment = (writeSegment + 1) % ENGINE_SAVE_LOG_SEGMENT_COUNT;
+	uint8_t firstSlotIndex;
+	uint32_t liveRecordsInNextSegment = saveLogLiveRecordsInSegment(nextSegment, &firstSlotIndex);
+	uint32_t sectorsLeft = ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT - writeSectorInSegment;
+	// leave enough room to move the next segment's live records out of the way:
+	if (sectorsLeft < (1 + liveRecordsInNextSegment + ENGINE_SAVE_LOG_SPARE_SECTORS)) {
+		if (sectorsLeft < liveRecordsInNextSegment) {
+			ENGINE_PANIC("Save log has no room left to move saves");
+		}
+		writeState = SAVE_LOG_MOVING_RECORDS;
+	} else {
+		writeState = SAVE_LOG_PROGRAMMING_DATA;
+	}
+}
+
+//every step starts at most one thing on the flash chip,
+//and none start until the last one is done
+void EngineSaveLog_Step() {
+	if (
+		writeState == SAVE_LOG_IDLE
+		|| saveLogFlashBusy()
+	) {
+		return;
+	}
+	uint8_t nextSegment = (writeSegment + 1) % ENGINE_SAVE_LOG_SEGMENT_COUNT;
+	uint8_t movingSlotIndex;
+	switch (writeState) {
+		case SAVE_LOG_MOVING_RECORDS:
+			if (saveLogLiveRecordsInSegment(nextSegment, &movingSlotIndex)) {
+				saveLogMoveRecord(movingSlotIndex);
+			} else {
+				saveLogEraseSegment(nextSegment);
+				writeState = SAVE_LOG_ERASING;
+			}
+			break;
+		case SAVE_LOG_ERASING:
+			writeSegment = nextSegment;
+			writeSectorInSegment = 0;
+			writeState = SAVE_LOG_PROGRAMMING_DATA;
+			break;
+		case SAVE_LOG_PROGRAMMING_DATA:
+			stagingSector = saveLogPrepareRecord(
+				stagingRecord,
+				stagingSlotIndex,
+				stagingLength
+			);
+			saveLogProgramRecordData(stagingSector, stagingLength, stagingRecord);
+			writeState = SAVE_LOG_PROGRAMMING_HEADER;
+			break;
+		case SAVE_LOG_PROGRAMMING_HEADER:
+			saveLogProgramRecordHeader(stagingSector, stagingRecord);
+			writeState = SAVE_LOG_FINISHING;
+			break;
+		case SAVE_LOG_FINISHING:
+			slotRecordSectors[stagingSlotIndex] = stagingSector;
+			saveLogStats.recordsWritten++;
+			writeState = SAVE_LOG_IDLE;
+			#ifdef EMSCRIPTEN
+			// triggers a call to the FS.syncfs, asking IDBFS
+			// "pls actually do your job and save for reals"
+			// It's async, so good luck if you interrupt it
+			// ¯\_(ツ)_/¯
+			emscripten_run_script("Module.persistSaveFiles();");
+			#endif // EMSCRIPTEN
+			break;
+		default:
+			ENGINE_PANIC("Save log is in an unknown state");
+	}
+}
+
+bool EngineSaveLog_IsBusy() {
+	return writeState != SAVE_LOG_IDLE;
+}
+
+void EngineSaveLog_Flush() {
+	while (writeState != SAVE_LOG_IDLE) {
+		saveLogFlashWait();
+		EngineSaveLog_Step();
+	}
+}
+
+void EngineSaveLog_Write(
+	uint8_t slotIndex,
+	uint32_t length,
+	const uint8_t *data
+) {
+	EngineSaveLog_StartWrite(slotIndex, length, data);
+	EngineSaveLog_Flush();
+}
+
+void EngineSaveLog_EraseAll() {
+	EngineSaveLog_Flush();
+	for (uint8_t i = 0; i < ENGINE_SAVE_LOG_SEGMENT_COUNT; i++) {
+		saveLogEraseSegment(i);
+		saveLogFlashWait();
+	}
+	for (uint8_t i = 0; i < ENGINE_ROM_SAVE_GAME_SLOTS; i++) {
+		slotRecordSectors[i] = ENGINE_SAVE_LOG_NO_RECORD;
+	}
+	nextSequence = 0;
+	writeSegment = 0;
+	writeSectorInSegment = 0;
+}
+
+#ifdef DC801_DESKTOP
+#ifndef EMSCRIPTEN
+//finishes the save in progress, then lets the worker apply everything
+//that takes before it quits, so no save is lost on the way out:
+static void stopSaveLogWorker() {
+	if (!saveLogWorkerThread.joinable()) {
+		return;
+	}
+	EngineSaveLog_Flush();
+	{
+		std::lock_guard<std::mutex> lock(saveLogWorkerMutex);
+		saveLogWorkerQuit = true;
+	}
+	saveLogWorkerWake.notify_all();
+	saveLogWorkerThread.join();
+}
+#endif // EMSCRIPTEN
+#endif //DC801_DESKTOP
+
+void EngineSaveLog_Deinit() {
+	EngineSaveLog_Flush();
+	#ifdef DC801_DESKTOP
+	#ifndef EMSCRIPTEN
+	stopSaveLogWorker();
+	#endif // EMSCRIPTEN
+	#endif //DC801_DESKTOP
+}
+
+const EngineSaveLog_Stats *EngineSaveLog_GetStats() {
+	return &saveLogStats;
+}
@@ -0,0 +1,109 @@
+#ifndef ENGINE_SAVE_LOG_H_
+#define ENGINE_SAVE_LOG_H_
+
+#include "common.h"
+
+//Save games are kept as a log in the ENGINE_ROM_SAVE_RESERVED_MEMORY_SIZE
+//at the end of the ROM chip, instead of erasing and rewriting one whole
+//256KB block every time a slot is saved.
+//Every save appends a new record for its slot into the next free sector,
+//and the record with the highest sequence number for a slot is the live one.
+//A segment (one erase block) is only erased once the log has gone all the way
+//around and needs it again, which spreads the erases over all of them.
+
+//each record takes up one sector, records are always sector aligned:
+#define ENGINE_SAVE_LOG_SECTOR_SIZE 4096
+
+//the smallest erase that works on our chip, see ENGINE_ROM_ERASE_PAGE_SIZE
+#define ENGINE_SAVE_LOG_SEGMENT_SIZE ENGINE_ROM_ERASE_PAGE_SIZE
+#define ENGINE_SAVE_LOG_SEGMENT_COUNT (ENGINE_ROM_SAVE_RESERVED_MEMORY_SIZE / ENGINE_SAVE_LOG_SEGMENT_SIZE)
+#define ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT (ENGINE_SAVE_LOG_SEGMENT_SIZE / ENGINE_SAVE_LOG_SECTOR_SIZE)
+#define ENGINE_SAVE_LOG_SECTOR_COUNT (ENGINE_SAVE_LOG_SEGMENT_COUNT * ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT)
+
+//before the next segment is erased, any live saves still in it are copied
+//to the end of the current one, so a save is never only in an erased block.
+//this many sectors are kept free on top of that, so a sector left half
+//written by a power loss can't eat the room those copies need.
+#define ENGINE_SAVE_LOG_SPARE_SECTORS 1
+
+//the last character is the record format version:
+#define ENGINE_SAVE_LOG_IDENTIFIER_STRING {'M','A','G','E','L','O','G','1'}
+
+//value used for a slot that has no record in the log:
+#define ENGINE_SAVE_LOG_NO_RECORD 0xFFFFFFFF
+
+//how long a segment erase gets to run every time EngineSaveLog_Step is called.
+//the game can't read anything from ROM while it does, so this comes straight
+//out of the frame that called it:
+#define ENGINE_SAVE_LOG_ERASE_TIME_SLICE_MILLISECONDS 4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	char identifier[ENGINE_ROM_IDENTIFIER_STRING_LENGTH];
+	//increases by one with every record written, across all slots:
+	uint32_t sequence;
+	//length of the save data following this header:
+	uint32_t length;
+	uint8_t slotIndex;
+	uint8_t paddingA;
+	uint8_t paddingB;
+	uint8_t paddingC;
+	//crc32 of this header up to here, followed by the save data:
+	uint32_t crc32;
+} EngineSaveLog_RecordHeader;
+
+#define ENGINE_SAVE_LOG_MAX_RECORD_LENGTH (ENGINE_SAVE_LOG_SECTOR_SIZE - sizeof(EngineSaveLog_RecordHeader))
+
+typedef struct {
+	uint32_t recordsWritten;
+	uint32_t recordsMoved;
+	uint32_t segmentErases;
+	uint32_t bytesProgrammed;
+	//time spent waiting on the flash chip. on desktop this is simulated
+	//from the chip's datasheet timings instead of measured.
+	uint32_t eraseMicroseconds;
+	uint32_t programMicroseconds;
+} EngineSaveLog_Stats;
+
+//scans the log for the newest valid record of each slot:
+void EngineSaveLog_Init();
+//false (and data zeroed) if the slot has never been saved.
+//finishes any save in progress first:
+bool EngineSaveLog_Read(
+	uint8_t slotIndex,
+	uint32_t length,
+	uint8_t *data
+);
+//copies the data and returns straight away, the save itself is done a bit at
+//a time by EngineSaveLog_Step. finishes any save in progress first:
+void EngineSaveLog_StartWrite(
+	uint8_t slotIndex,
+	uint32_t length,
+	const uint8_t *data
+);
+//moves the save in progress along, if there is one. call once per game loop:
+void EngineSaveLog_Step();
+bool EngineSaveLog_IsBusy();
+//blocks until the save in progress is done:
+void EngineSaveLog_Flush();
+//EngineSaveLog_StartWrite + EngineSaveLog_Flush:
+void EngineSaveLog_Write(
+	uint8_t slotIndex,
+	uint32_t length,
+	const uint8_t *data
+);
+//forgets every save, used when a new game.dat is copied to the ROM chip:
+void EngineSaveLog_EraseAll();
+//finishes the save in progress, and on desktop stops the
+//thread emulating the flash chip once it's all in the file:
+void EngineSaveLog_Deinit();
+const EngineSaveLog_Stats *EngineSaveLog_GetStats();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
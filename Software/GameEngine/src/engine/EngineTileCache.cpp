@@ -0,0 +1,257 @@
+#include "EngineTileCache.h"
+#include "EngineROM.h"
+#include "FrameBuffer.h"
+
+static EngineTileCache_Stats tileCacheStats = {};
+static bool tileCacheEnabled = true;
+
+#if ENGINE_TILE_CACHE_TILE_COUNT > 0
+
+#define ENGINE_TILE_CACHE_BUCKET_COUNT (ENGINE_TILE_CACHE_TILE_COUNT * 2)
+
+static uint16_t tileCachePixels[ENGINE_TILE_CACHE_PIXELS];
+static EngineTileCache_Tile tileCacheTiles[ENGINE_TILE_CACHE_TILE_COUNT];
+static uint16_t tileCacheBuckets[ENGINE_TILE_CACHE_BUCKET_COUNT];
+//in the order they were cached, the oldest one is the next to be thrown out:
+static uint16_t tileCacheOldest = ENGINE_TILE_CACHE_NO_TILE;
+static uint16_t tileCacheNewest = ENGINE_TILE_CACHE_NO_TILE;
+static uint16_t tileCacheFree = ENGINE_TILE_CACHE_NO_TILE;
+//where the pixels of the next tile go. the tiles from before it last went
+//back to the start of tileCachePixels are all after it:
+static uint32_t tileCacheHead = 0;
+//how many of tileCachePixels it uses, see EngineTileCache_SetLimit:
+static uint32_t tileCacheLimit = ENGINE_TILE_CACHE_PIXELS;
+static bool tileCacheInitialized = false;
+
+static uint32_t tileCacheBucketIndex(
+	uint32_t address,
+	const MageColorPalette *colorPalette,
+	uint8_t flags
+) {
+	uint32_t hash = address * 2654435761u;
+	hash ^= (uint32_t)((uintptr_t)colorPalette >> 3) * 40503u;
+	hash ^= flags * 16777619u;
+	return hash % ENGINE_TILE_CACHE_BUCKET_COUNT;
+}
+
+static void tileCacheBucketRemove(uint16_t tileIndex) {
+	EngineTileCache_Tile *tile = &tileCacheTiles[tileIndex];
+	uint16_t *link = &tileCacheBuckets[
+		tileCacheBucketIndex(tile->address, tile->colorPalette, tile->flags)
+	];
+	while (*link != ENGINE_TILE_CACHE_NO_TILE) {
+		if (*link == tileIndex) {
+			*link = tile->bucketNext;
+			return;
+		}
+		link = &tileCacheTiles[*link].bucketNext;
+	}
+}
+
+static void tileCacheEvictOldest() {
+	uint16_t tileIndex = tileCacheOldest;
+	EngineTileCache_Tile *tile = &tileCacheTiles[tileIndex];
+	tileCacheBucketRemove(tileIndex);
+	tileCacheOldest = tile->newer;
+	if (tileCacheOldest == ENGINE_TILE_CACHE_NO_TILE) {
+		tileCacheNewest = ENGINE_TILE_CACHE_NO_TILE;
+	}
+	tile->newer = tileCacheFree;
+	tileCacheFree = tileIndex;
+	tileCacheStats.evictions++;
+}
+
+//whether the oldest tile is one from before the last time around the ring,
+//with any of its pixels before end:
+static bool tileCacheOldestBefore(uint32_t end) {
+	if (tileCacheOldest == ENGINE_TILE_CACHE_NO_TILE) {
+		return false;
+	}
+	uint32_t offset = tileCacheTiles[tileCacheOldest].pixels - tileCachePixels;
+	return offset >= tileCacheHead && offset < end;
+}
+
+//throws out the oldest tiles until there's a free tile and room for
+//this many pixels at the head, and returns where they go:
+static uint16_t *tileCacheAllocate(uint32_t pixels) {
+	if (tileCacheHead + pixels > tileCacheLimit) {
+		//no room left before the end, so back to the start,
+		//and everything from here to the end is in the way:
+		while (tileCacheOldestBefore(ENGINE_TILE_CACHE_PIXELS)) {
+			tileCacheEvictOldest();
+		}
+		tileCacheHead = 0;
+	}
+	while (tileCacheOldestBefore(tileCacheHead + pixels)) {
+		tileCacheEvictOldest();
+	}
+	if (tileCacheFree == ENGINE_TILE_CACHE_NO_TILE) {
+		tileCacheEvictOldest();
+	}
+	uint16_t *destination = &tileCachePixels[tileCacheHead];
+	tileCacheHead += pixels;
+	return destination;
+}
+
+//looks up every pixel in the palette and applies the flips, so the result
+//is exactly what the tileToBuffer* functions would have put on the screen
+static void tileCacheDecode(EngineTileCache_Tile *tile) {
+	RenderFlagsUnion flagSplit;
+	flagSplit.i = tile->flags;
+	bool flip_x    = flagSplit.f.horizontal;
+	bool flip_y    = flagSplit.f.vertical;
+	bool flip_diag = flagSplit.f.diagonal;
+	uint16_t width = tile->width;
+	uint16_t height = tile->height;
+	bool packed = tile->colorPalette->packed();
+	const uint8_t *source = EngineROM_View(
+		tile->address,
+		EngineImage_Bytes(width * height, packed)
+	);
+	const uint16_t *colors = tile->colorPalette->colors.get();
+	uint16_t *destination = tile->pixels;
+	bool opaque = true;
+	for (uint16_t y = 0; y < height; y++) {
+		uint16_t tile_y = flip_y ? (height - 1 - y) : y;
+		for (uint16_t x = 0; x < width; x++) {
+			uint16_t tile_x = flip_x ? (width - 1 - x) : x;
+			uint32_t tile_index = flip_diag
+				? (tile_y + (tile_x * width)) //transposed
+				: (tile_x + (tile_y * width));
+			uint16_t color = colors[EngineImage_Pixel(source, tile_index, packed)];
+			opaque &= color != tile->transparentColor;
+			*destination++ = color;
+		}
+	}
+	tile->opaque = opaque;
+}
+
+const EngineTileCache_Tile *EngineTileCache_Get(
+	uint32_t address,
+	const MageColorPalette *colorPalette,
+	uint16_t width,
+	uint16_t height,
+	uint16_t transparentColor,
+	uint8_t flags
+) {
+	if (!tileCacheInitialized) {
+		EngineTileCache_Invalidate();
+	}
+	uint32_t pixels = (uint32_t)width * height;
+	if (
+		!tileCacheEnabled
+		|| pixels > ENGINE_TILE_CACHE_MAX_TILE_PIXELS
+		|| pixels > tileCacheLimit
+	) {
+		tileCacheStats.uncached++;
+		return NULL;
+	}
+	uint32_t bucketIndex = tileCacheBucketIndex(address, colorPalette, flags);
+	uint16_t tileIndex = tileCacheBuckets[bucketIndex];
+	while (tileIndex != ENGINE_TILE_CACHE_NO_TILE) {
+		EngineTileCache_Tile *tile = &tileCacheTiles[tileIndex];
+		if (
+			tile->address == address
+			&& tile->colorPalette == colorPalette
+			&& tile->flags == flags
+			&& tile->width == width
+			&& tile->height == height
+			&& tile->transparentColor == transparentColor
+		) {
+			tileCacheStats.hits++;
+			return tile;
+		}
+		tileIndex = tile->bucketNext;
+	}
+	tileCacheStats.misses++;
+	uint16_t *destination = tileCacheAllocate(pixels);
+	tileIndex = tileCacheFree;
+	EngineTileCache_Tile *tile = &tileCacheTiles[tileIndex];
+	tileCacheFree = tile->newer;
+	tile->address = address;
+	tile->colorPalette = colorPalette;
+	tile->width = width;
+	tile->height = height;
+	tile->transparentColor = transparentColor;
+	tile->flags = flags;
+	tile->pixels = destination;
+	tileCacheDecode(tile);
+	tile->bucketNext = tileCacheBuckets[bucketIndex];
+	tileCacheBuckets[bucketIndex] = tileIndex;
+	tile->newer = ENGINE_TILE_CACHE_NO_TILE;
+	if (tileCacheNewest != ENGINE_TILE_CACHE_NO_TILE) {
+		tileCacheTiles[tileCacheNewest].newer = tileIndex;
+	} else {
+		tileCacheOldest = tileIndex;
+	}
+	tileCacheNewest = tileIndex;
+	return tile;
+}
+
+void EngineTileCache_Invalidate() {
+	for (uint32_t i = 0; i < ENGINE_TILE_CACHE_BUCKET_COUNT; i++) {
+		tileCacheBuckets[i] = ENGINE_TILE_CACHE_NO_TILE;
+	}
+	for (uint32_t i = 0; i < ENGINE_TILE_CACHE_TILE_COUNT; i++) {
+		tileCacheTiles[i].newer = (i + 1 < ENGINE_TILE_CACHE_TILE_COUNT)
+			? i + 1
+			: ENGINE_TILE_CACHE_NO_TILE;
+	}
+	tileCacheFree = 0;
+	tileCacheOldest = ENGINE_TILE_CACHE_NO_TILE;
+	tileCacheNewest = ENGINE_TILE_CACHE_NO_TILE;
+	tileCacheHead = 0;
+	tileCacheInitialized = true;
+	tileCacheStats = {};
+}
+
+void EngineTileCache_SetLimit(uint32_t bytes) {
+	tileCacheLimit = MIN(bytes, ENGINE_TILE_CACHE_BYTES) / sizeof(uint16_t);
+	EngineTileCache_Invalidate();
+}
+
+#else
+
+const EngineTileCache_Tile *EngineTileCache_Get(
+	uint32_t address,
+	const MageColorPalette *colorPalette,
+	uint16_t width,
+	uint16_t height,
+	uint16_t transparentColor,
+	uint8_t flags
+) {
+	tileCacheStats.uncached++;
+	return NULL;
+}
+
+void EngineTileCache_Invalidate() {
+	tileCacheStats = {};
+}
+
+void EngineTileCache_SetLimit(uint32_t bytes) {
+	EngineTileCache_Invalidate();
+}
+
+#endif //ENGINE_TILE_CACHE_TILE_COUNT > 0
+
+void EngineTileCache_SetEnabled(bool enabled) {
+	tileCacheEnabled = enabled;
+}
+
+const EngineTileCache_Stats *EngineTileCache_GetStats() {
+	return &tileCacheStats;
+}
+
+void EngineTileCache_LogStats(const char *label) {
+	uint32_t lookups = tileCacheStats.hits + tileCacheStats.misses;
+	debug_print(
+		"Tile cache (%s): %u hits, %u misses (%u%% hit), %u evictions, %u uncached, %uKB",
+		label,
+		tileCacheStats.hits,
+		tileCacheStats.misses,
+		lookups ? (tileCacheStats.hits * 100) / lookups : 0,
+		tileCacheStats.evictions,
+		tileCacheStats.uncached,
+		(uint32_t)(ENGINE_TILE_CACHE_BYTES / 1024)
+	);
+}
@@ -0,0 +1,94 @@
+#ifndef ENGINE_TILE_CACHE_H_
+#define ENGINE_TILE_CACHE_H_
+
+#include "common.h"
+#include "games/mage/mage_color_palette.h"
+
+//Tiles drawn by FrameBuffer::drawChunkWithFlags are kept here fully decoded:
+//already looked up in their color palette, flipped, and laid out the way they
+//go on the screen, so drawing one again is only a copy. Each tile takes only
+//its own width * height of the cache's pixels, one after the other around
+//a ring, and the oldest tiles are thrown out to make room for new ones.
+
+//RAM budget for the pixels of the whole cache, per target. 0 turns it off.
+#ifndef ENGINE_TILE_CACHE_BYTES
+#ifdef DC801_DESKTOP
+#define ENGINE_TILE_CACHE_BYTES (4 * 1024 * 1024)
+#else
+//the two frame buffer bands take 50KB of the badge's 256KB, this is about
+//the most the other budgets in mage_defines.h leave it. 64 16px tiles,
+//so maps with more different tiles on the screen than that still miss:
+#define ENGINE_TILE_CACHE_BYTES (32 * 1024)
+#endif //DC801_DESKTOP
+#endif //ENGINE_TILE_CACHE_BYTES
+
+//tiles bigger than this (like portraits) are drawn without the cache,
+//they'd throw too much of it out:
+#ifndef ENGINE_TILE_CACHE_MAX_TILE_PIXELS
+#define ENGINE_TILE_CACHE_MAX_TILE_PIXELS (64 * 64)
+#endif //ENGINE_TILE_CACHE_MAX_TILE_PIXELS
+
+//2 bytes a pixel:
+#define ENGINE_TILE_CACHE_PIXELS (ENGINE_TILE_CACHE_BYTES / 2)
+//how many tiles it can keep track of, enough for it to be full of 16px ones.
+//smaller tiles run out of these before they run out of pixels:
+#ifndef ENGINE_TILE_CACHE_TILE_COUNT
+#define ENGINE_TILE_CACHE_TILE_COUNT (ENGINE_TILE_CACHE_PIXELS / (16 * 16))
+#endif //ENGINE_TILE_CACHE_TILE_COUNT
+#if ENGINE_TILE_CACHE_TILE_COUNT >= 0xFFFF
+#error "ENGINE_TILE_CACHE_TILE_COUNT has to fit in a uint16_t, below ENGINE_TILE_CACHE_NO_TILE"
+#endif
+
+//used for the end of the lists of tiles and of the hash buckets:
+#define ENGINE_TILE_CACHE_NO_TILE 0xFFFF
+
+typedef struct {
+	//everything that changes what the decoded tile looks like:
+	uint32_t address; //ROM address of the first pixel of the tile
+	const MageColorPalette *colorPalette;
+	uint16_t width;
+	uint16_t height;
+	uint16_t transparentColor;
+	uint8_t flags;
+	//true if none of the pixels are transparentColor, so rows can be copied whole
+	bool opaque;
+	//the tile cached after this one, or the next free one:
+	uint16_t newer;
+	uint16_t bucketNext;
+	//screen endian colors, width * height of them, with the flips applied.
+	//a pixel that should not be drawn is transparentColor.
+	uint16_t *pixels;
+} EngineTileCache_Tile;
+
+typedef struct {
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t evictions;
+	//tiles drawn without the cache, because they're
+	//too big for it or the cache is turned off:
+	uint32_t uncached;
+} EngineTileCache_Stats;
+
+//returns the decoded tile, decoding it into the cache first if needed,
+//or NULL if this tile can't be cached. transparentColor is screen endian.
+const EngineTileCache_Tile *EngineTileCache_Get(
+	uint32_t address,
+	const MageColorPalette *colorPalette,
+	uint16_t width,
+	uint16_t height,
+	uint16_t transparentColor,
+	uint8_t flags
+);
+//forgets every tile, needed whenever a color palette that's in use could change.
+//also resets the stats.
+void EngineTileCache_Invalidate();
+//false makes every tile go through the tile blitter like on the badge,
+//so tests can compare and time it on desktop. on by default.
+void EngineTileCache_SetEnabled(bool enabled);
+//only uses that many of its ENGINE_TILE_CACHE_BYTES, so tests can see it
+//throwing tiles out with a budget like the badge's. forgets every tile:
+void EngineTileCache_SetLimit(uint32_t bytes);
+const EngineTileCache_Stats *EngineTileCache_GetStats();
+void EngineTileCache_LogStats(const char *label);
+
+#endif //ENGINE_TILE_CACHE_H_
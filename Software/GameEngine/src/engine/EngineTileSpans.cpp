@@ -0,0 +1,66 @@
+#include "EngineTileSpans.h"
+
+uint32_t EngineTileSpans_Build(
+	const uint8_t *pixels,
+	bool packed,
+	const uint16_t *colors,
+	uint16_t tile_width,
+	uint16_t tile_height,
+	uint16_t transparent_color,
+	uint8_t *spans,
+	uint32_t *opaquePixels
+) {
+	uint32_t length = 0;
+	for (uint16_t y = 0; y < tile_height; y++) {
+		uint32_t row = y * tile_width;
+		uint32_t countIndex = length++;
+		uint8_t runCount = 0;
+		uint16_t x = 0;
+		while (x < tile_width) {
+			while (
+				x < tile_width
+				&& colors[EngineImage_Pixel(pixels, row + x, packed)] == transparent_color
+			) {
+				x++;
+			}
+			if (x == tile_width) {
+				break;
+			}
+			uint16_t start = x;
+			while (
+				x < tile_width
+				&& colors[EngineImage_Pixel(pixels, row + x, packed)] != transparent_color
+			) {
+				x++;
+			}
+			if (spans != NULL) {
+				spans[length] = start;
+				spans[length + 1] = x - start;
+			}
+			if (opaquePixels != NULL) {
+				*opaquePixels += x - start;
+			}
+			length += 2;
+			runCount++;
+		}
+		if (spans != NULL) {
+			spans[countIndex] = runCount;
+		}
+	}
+	return length;
+}
+
+uint32_t EngineTileSpans_OpaquePixels(
+	const uint8_t *spans,
+	uint16_t tile_height
+) {
+	uint32_t pixels = 0;
+	for (uint16_t y = 0; y < tile_height; y++) {
+		uint8_t runCount = *spans++;
+		for (uint8_t run = 0; run < runCount; run++) {
+			pixels += spans[1];
+			spans += 2;
+		}
+	}
+	return pixels;
+}
@@ -0,0 +1,50 @@
+#ifndef ENGINE_TILE_SPANS_H_
+#define ENGINE_TILE_SPANS_H_
+
+#include "common.h"
+#include "EngineImage.h"
+
+//Most sprites are transparent all around their edges, so instead of checking
+//every pixel of a tile for the transparent color, FrameBuffer::drawChunkWithFlags
+//can be given the tile's spans: the runs of pixels on each row that are not
+//transparent. Those get copied, and everything between them is skipped.
+
+//The spans of one tile are laid out row by row from the top, in the tile's own
+//unflipped layout. Every row is one byte with how many runs it has, followed
+//by a start column byte and a length byte for each run, left to right.
+
+//tiles wider than this can't have spans, the columns have to fit in a byte:
+#define ENGINE_TILE_SPANS_MAX_WIDTH 255
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//works out the spans of the tile_width * tile_height palette indexes in pixels,
+//two to a byte if packed (see EngineImage.h),
+//and writes them to spans, or only counts them if spans is NULL.
+//transparent_color is screen endian, like the colors.
+//adds the number of pixels the spans cover to opaquePixels, if it isn't NULL.
+//returns how many bytes the spans take.
+uint32_t EngineTileSpans_Build(
+	const uint8_t *pixels,
+	bool packed,
+	const uint16_t *colors,
+	uint16_t tile_width,
+	uint16_t tile_height,
+	uint16_t transparent_color,
+	uint8_t *spans,
+	uint32_t *opaquePixels
+);
+
+//how many of the pixels of a tile the spans cover:
+uint32_t EngineTileSpans_OpaquePixels(
+	const uint8_t *spans,
+	uint16_t tile_height
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ENGINE_TILE_SPANS_H_
@@ -1,5 +1,13 @@
 #include "EngineWindowFrame.h"
 #include "EnginePanic.h"
+#include "utility.h"
+
+#if ENGINE_WINDOW_FRAME_PRESENT_THREAD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif //ENGINE_WINDOW_FRAME_PRESENT_THREAD
+
 #define FRAME_ASSETS_PATH "MAGE/desktop_assets"
 
 SDL_Window *window = nullptr;
@@ -11,11 +19,120 @@ SDL_Texture *frameButtonTexture = nullptr;
 SDL_Surface *frameLEDSurface = nullptr;
 SDL_Texture *frameLEDTexture = nullptr;
 SDL_Texture *gameViewportTexture = nullptr;
+//the window frame with the buttons and LEDs on it, put together again only
+//when one of them changes. nullptr if the renderer can't draw into
+//textures, then all of it is drawn again for every present:
+SDL_Texture *frameCompositeTexture = nullptr;
+static bool frameCompositeValid = false;
+static bool frameCompositeButtonStates[KEYBOARD_NUM_KEYS];
+static uint8_t frameCompositeLEDStates[LED_COUNT];
 
 const int SCREEN_MULTIPLIER = 2;
 int SCREEN_WIDTH = 0;
 int SCREEN_HEIGHT = 0;
 
+#define NO_PRESENT_BUFFER -1
+
+static FrameBuffer_PresentStats presentStats = {};
+
+#if ENGINE_WINDOW_FRAME_PRESENT_THREAD
+//two copies of the frame: the game queues into one while the present thread
+//draws the other. everything here is guarded by presentMutex.
+static uint16_t presentBuffers[2][FRAMEBUFFER_SIZE];
+//the parts of each that have to be copied into the texture:
+static Rectangle presentRects[2][FRAMEBUFFER_DIRTY_RECT_COUNT];
+static uint8_t presentRectCounts[2];
+//the buttons and LEDs as they were when each was queued, the game thread
+//keeps changing the live ones while the present thread draws:
+static bool presentButtonStates[2][KEYBOARD_NUM_KEYS];
+static uint8_t presentLEDStates[2][LED_COUNT];
+static int8_t presentQueuedBuffer = NO_PRESENT_BUFFER;
+static int8_t presentDrawingBuffer = NO_PRESENT_BUFFER;
+static bool presentThreadQuit = false;
+//the renderer belongs to the present thread, this says it has made it:
+static bool presentThreadReady = false;
+static std::mutex presentMutex;
+static std::condition_variable presentWake;
+static std::thread presentThread;
+#else
+static uint16_t presentBuffers[1][FRAMEBUFFER_SIZE];
+static bool presentButtonStates[1][KEYBOARD_NUM_KEYS];
+static uint8_t presentLEDStates[1][LED_COUNT];
+#endif //ENGINE_WINDOW_FRAME_PRESENT_THREAD
+
+static void createRenderer();
+static uint32_t presentFrame(
+	const uint16_t *frame,
+	const Rectangle *rects,
+	uint8_t rectCount,
+	const bool *buttonStates,
+	const uint8_t *LEDStates
+);
+static void destroyRenderer();
+
+//copies just the rects of frame into buffer:
+static void copyRects(uint16_t *buffer, const uint16_t *frame, const Rectangle *rects, uint8_t rectCount)
+{
+	for (uint8_t index = 0; index < rectCount; index++) {
+		const Rectangle &rect = rects[index];
+		for (int32_t y = rect.y; y < rect.y + rect.height; y++) {
+			uint32_t offset = (y * WIDTH) + rect.x;
+			memcpy(buffer + offset, frame + offset, rect.width * sizeof(uint16_t));
+		}
+	}
+}
+
+//copies the buttons and LEDs the frame in buffer gets drawn with:
+static void copyFrameStates(uint8_t buffer)
+{
+	for (int i = 0; i < KEYBOARD_NUM_KEYS; ++i) {
+		presentButtonStates[buffer][i] = *buttonBoolPointerArray[i];
+	}
+	memcpy(presentLEDStates[buffer], led_states, sizeof(presentLEDStates[buffer]));
+}
+
+#if ENGINE_WINDOW_FRAME_PRESENT_THREAD
+static void stopPresentThread();
+
+static void presentThreadMain()
+{
+	createRenderer();
+	{
+		std::lock_guard<std::mutex> lock(presentMutex);
+		presentThreadReady = true;
+	}
+	presentWake.notify_all();
+	while (true) {
+		std::unique_lock<std::mutex> lock(presentMutex);
+		presentWake.wait(lock, [] {
+			return presentThreadQuit || presentQueuedBuffer != NO_PRESENT_BUFFER;
+		});
+		if (presentThreadQuit) {
+			break;
+		}
+		presentDrawingBuffer = presentQueuedBuffer;
+		presentQueuedBuffer = NO_PRESENT_BUFFER;
+		lock.unlock();
+		uint32_t start = micros();
+		uint32_t pixels = presentFrame(
+			presentBuffers[presentDrawingBuffer],
+			presentRects[presentDrawingBuffer],
+			presentRectCounts[presentDrawingBuffer],
+			presentButtonStates[presentDrawingBuffer],
+			presentLEDStates[presentDrawingBuffer]
+		);
+		uint32_t presentTime = micros() - start;
+		lock.lock();
+		presentStats.framesPresented++;
+		presentStats.presentMicroseconds += presentTime;
+		presentStats.pixelsTransferred += pixels;
+		presentStats.rectsTransferred += presentRectCounts[presentDrawingBuffer];
+		presentDrawingBuffer = NO_PRESENT_BUFFER;
+	}
+	destroyRenderer();
+}
+#endif //ENGINE_WINDOW_FRAME_PRESENT_THREAD
+
 void EngineWindowFrameInit()
 {
 	if(SDL_Init(SDL_INIT_VIDEO) < 0)
@@ -48,17 +165,13 @@ void EngineWindowFrameInit()
 	SCREEN_WIDTH = frameSurface->w * SCREEN_MULTIPLIER;
 	SCREEN_HEIGHT = frameSurface->h * SCREEN_MULTIPLIER;
 
-	SDL_CreateWindowAndRenderer(
+	window = SDL_CreateWindow(
+		"DC801 MAGE GAME",
+		SDL_WINDOWPOS_UNDEFINED,
+		SDL_WINDOWPOS_UNDEFINED,
 		SCREEN_WIDTH,
 		SCREEN_HEIGHT,
-		SDL_WINDOW_SHOWN,
-		&window,
-		&renderer
-	);
-
-	SDL_SetWindowTitle(
-		window,
-		"DC801 MAGE GAME"
+		SDL_WINDOW_SHOWN
 	);
 
 	if(window == nullptr)
@@ -66,6 +179,35 @@ void EngineWindowFrameInit()
 		ENGINE_PANIC("Failed to create SDL Window\nSDL_Error: %s\n", SDL_GetError());
 	}
 
+	#if ENGINE_WINDOW_FRAME_PRESENT_THREAD
+	presentThreadQuit = false;
+	presentThreadReady = false;
+	presentThread = std::thread(presentThreadMain);
+	//exit() from a panic or a test skips EngineWindowFrameDestroy, and a
+	//std::thread that's still running when it gets destroyed aborts:
+	atexit(stopPresentThread);
+	{
+		std::unique_lock<std::mutex> lock(presentMutex);
+		presentWake.wait(lock, [] { return presentThreadReady; });
+	}
+	#else
+	createRenderer();
+	#endif //ENGINE_WINDOW_FRAME_PRESENT_THREAD
+
+	if(renderer == nullptr)
+	{
+		ENGINE_PANIC("Failed to create SDL Renderer\nSDL_Error: %s\n", SDL_GetError());
+	}
+}
+
+static void createRenderer()
+{
+	renderer = SDL_CreateRenderer(window, -1, 0);
+	if (renderer == nullptr)
+	{
+		return;
+	}
+
 	SDL_RenderSetLogicalSize(renderer, frameSurface->w, frameSurface->h);
 
 	frameTexture = SDL_CreateTextureFromSurface(renderer, frameSurface);
@@ -81,6 +223,19 @@ void EngineWindowFrameInit()
 		WIDTH,
 		HEIGHT
 	);
+
+	if (SDL_RenderTargetSupported(renderer))
+	{
+		frameCompositeTexture = SDL_CreateTexture(
+			renderer,
+			SDL_PIXELFORMAT_RGBA8888,
+			SDL_TEXTUREACCESS_TARGET,
+			frameSurface->w,
+			frameSurface->h
+		);
+		SDL_SetTextureBlendMode(frameCompositeTexture, SDL_BLENDMODE_NONE);
+	}
+	frameCompositeValid = false;
 }
 
 const SDL_Rect gameViewportSrcRect = {0, 0, WIDTH, HEIGHT};
@@ -124,14 +279,14 @@ const SDL_Point buttonDestPoints[] = {
 	{38, 98 - 42},
 };
 
-void drawButtonStates ()
+void drawButtonStates (const bool *buttonStates)
 {
 	SDL_Point buttonPoint;
 	bool buttonState;
 	for (int i = 0; i < KEYBOARD_NUM_KEYS; ++i)
 	{
 		buttonPoint = buttonDestPoints[i];
-		buttonState = *buttonBoolPointerArray[i];
+		buttonState = buttonStates[i];
 		buttonTargetRect.x = buttonPoint.x - buttonHalf.x;
 		buttonTargetRect.y = buttonPoint.y - buttonHalf.y;
 		SDL_RenderCopy(
@@ -165,14 +320,14 @@ const SDL_Point LEDDestPoints[LED_COUNT] = {
 	{468, 112 - 42}, //LED_SD
 };
 
-void drawLEDStates ()
+void drawLEDStates (const uint8_t *LEDStates)
 {
 	SDL_Point LEDPoint;
 	uint8_t LEDState;
 	for (int i = 0; i < LED_COUNT; ++i)
 	{
 		LEDPoint = LEDDestPoints[i];
-		LEDState = led_states[i];
+		LEDState = LEDStates[i];
 		LEDTargetRect.x = LEDPoint.x - LEDHalf.x;
 		LEDTargetRect.y = LEDPoint.y - LEDHalf.y;
 		SDL_SetTextureAlphaMod(frameLEDTexture, 255);
@@ -194,35 +349,190 @@ void drawLEDStates ()
 	}
 }
 
-void EngineWindowFrameGameBlt(uint16_t *frame)
+void EngineWindowFrameGameBlt(uint16_t *frame, const Rectangle *rects, uint8_t rectCount)
 {
-	void *pixels;
-	int pitch;
-
 	if (frame == nullptr) {
 		return;
 	}
-	uint16_t correctEndianScreenBuffer[FRAMEBUFFER_SIZE] = {0};
-	memcpy(correctEndianScreenBuffer, frame, FRAMEBUFFER_SIZE * sizeof(uint16_t));
-	// Sorry for this monster;
-	// The game.dat stores the image buffer data in BigEndian
-	// SDL reads FrameBuffers in Platform Native Endian,
-	// so we need to convert if Desktop is LittleEndian
-	#ifndef IS_SCREEN_BIG_ENDIAN
-		#ifdef IS_LITTLE_ENDIAN
-			convert_endian_u2_buffer(correctEndianScreenBuffer, FRAMEBUFFER_SIZE);
-		#endif
-	#endif
-	SDL_LockTexture(gameViewportTexture, nullptr, &pixels, &pitch);
-	memcpy(pixels, correctEndianScreenBuffer, FRAMEBUFFER_SIZE * sizeof(uint16_t));
-	SDL_UnlockTexture(gameViewportTexture);
+	#if ENGINE_WINDOW_FRAME_PRESENT_THREAD
+	uint32_t start = micros();
+	{
+		std::lock_guard<std::mutex> lock(presentMutex);
+		uint32_t waited = micros() - start;
+		presentStats.waitMicroseconds += waited;
+		presentStats.maxWaitMicroseconds = MAX(presentStats.maxWaitMicroseconds, waited);
+		int8_t buffer = presentQueuedBuffer;
+		if (buffer != NO_PRESENT_BUFFER) {
+			//the present thread is still busy with the one before it, whose
+			//changes still have to make it to the screen. one rect around
+			//both keeps them from overlapping:
+			presentStats.framesDropped++;
+			Rectangle *queued = presentRects[buffer];
+			uint8_t queuedCount = presentRectCounts[buffer];
+			if (queuedCount + rectCount > 0) {
+				const Rectangle &first = queuedCount ? queued[0] : rects[0];
+				int32_t left = first.x;
+				int32_t top = first.y;
+				int32_t right = first.x + first.width;
+				int32_t bottom = first.y + first.height;
+				for (uint8_t index = 0; index < queuedCount + rectCount; index++) {
+					const Rectangle &rect = index < queuedCount
+						? queued[index]
+						: rects[index - queuedCount];
+					left = MIN(left, rect.x);
+					top = MIN(top, rect.y);
+					right = MAX(right, rect.x + rect.width);
+					bottom = MAX(bottom, rect.y + rect.height);
+				}
+				queued[0] = Rectangle(left, top, right - left, bottom - top);
+				presentRectCounts[buffer] = 1;
+			}
+		} else {
+			buffer = presentDrawingBuffer == 0 ? 1 : 0;
+			memcpy(presentRects[buffer], rects, rectCount * sizeof(Rectangle));
+			presentRectCounts[buffer] = rectCount;
+		}
+		copyRects(presentBuffers[buffer], frame, presentRects[buffer], presentRectCounts[buffer]);
+		copyFrameStates(buffer);
+		presentQueuedBuffer = buffer;
+		presentStats.framesQueued++;
+	}
+	presentWake.notify_one();
+	#else
+	uint32_t start = micros();
+	copyRects(presentBuffers[0], frame, rects, rectCount);
+	copyFrameStates(0);
+	uint32_t pixels = presentFrame(
+		presentBuffers[0],
+		rects,
+		rectCount,
+		presentButtonStates[0],
+		presentLEDStates[0]
+	);
+	uint32_t presentTime = micros() - start;
+	//the game waits for all of it here:
+	presentStats.framesQueued++;
+	presentStats.framesPresented++;
+	presentStats.waitMicroseconds += presentTime;
+	presentStats.maxWaitMicroseconds = MAX(presentStats.maxWaitMicroseconds, presentTime);
+	presentStats.presentMicroseconds += presentTime;
+	presentStats.pixelsTransferred += pixels;
+	presentStats.rectsTransferred += rectCount;
+	#endif //ENGINE_WINDOW_FRAME_PRESENT_THREAD
+}
+
+const FrameBuffer_PresentStats *EngineWindowFrameGetPresentStats()
+{
+	#if ENGINE_WINDOW_FRAME_PRESENT_THREAD
+	//the present thread keeps counting, so hand out a copy:
+	static FrameBuffer_PresentStats snapshot;
+	std::lock_guard<std::mutex> lock(presentMutex);
+	snapshot = presentStats;
+	return &snapshot;
+	#else
+	return &presentStats;
+	#endif //ENGINE_WINDOW_FRAME_PRESENT_THREAD
+}
 
+void EngineWindowFrameResetPresentStats()
+{
+	#if ENGINE_WINDOW_FRAME_PRESENT_THREAD
+	std::lock_guard<std::mutex> lock(presentMutex);
+	#endif //ENGINE_WINDOW_FRAME_PRESENT_THREAD
+	presentStats = {};
+}
+
+static void drawFrameLayers(const bool *buttonStates, const uint8_t *LEDStates)
+{
 	SDL_RenderCopy(
 		renderer,
 		frameTexture,
 		&frameSurface->clip_rect,
 		&frameSurface->clip_rect
 	);
+	drawButtonStates(buttonStates);
+	drawLEDStates(LEDStates);
+}
+
+//the buttons and LEDs are drawn next to the game viewport, never over it,
+//so they can all go under it in the composite:
+static void drawFrameComposite(const bool *buttonStates, const uint8_t *LEDStates)
+{
+	if (frameCompositeTexture == nullptr)
+	{
+		drawFrameLayers(buttonStates, LEDStates);
+		return;
+	}
+	bool changed = !frameCompositeValid;
+	for (int i = 0; i < KEYBOARD_NUM_KEYS; ++i)
+	{
+		if (frameCompositeButtonStates[i] != buttonStates[i])
+		{
+			frameCompositeButtonStates[i] = buttonStates[i];
+			changed = true;
+		}
+	}
+	if (memcmp(frameCompositeLEDStates, LEDStates, sizeof(frameCompositeLEDStates)) != 0)
+	{
+		memcpy(frameCompositeLEDStates, LEDStates, sizeof(frameCompositeLEDStates));
+		changed = true;
+	}
+	if (changed)
+	{
+		SDL_SetRenderTarget(renderer, frameCompositeTexture);
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+		SDL_RenderClear(renderer);
+		drawFrameLayers(buttonStates, LEDStates);
+		SDL_SetRenderTarget(renderer, nullptr);
+		frameCompositeValid = true;
+	}
+	SDL_RenderCopy(
+		renderer,
+		frameCompositeTexture,
+		&frameSurface->clip_rect,
+		&frameSurface->clip_rect
+	);
+}
+
+//only rects get copied into the texture, the rest of it is still the frame
+//before. the window frame is drawn with the buttons and LEDs given, not the
+//live ones. returns how many pixels that was:
+static uint32_t presentFrame(
+	const uint16_t *frame,
+	const Rectangle *rects,
+	uint8_t rectCount,
+	const bool *buttonStates,
+	const uint8_t *LEDStates
+)
+{
+	uint32_t pixels = 0;
+	for (uint8_t index = 0; index < rectCount; index++) {
+		const Rectangle &rect = rects[index];
+		const uint16_t *topLeft = frame + (rect.y * WIDTH) + rect.x;
+		SDL_Rect textureRect = { rect.x, rect.y, rect.width, rect.height };
+		void *texturePixels;
+		int texturePitch;
+		//a streaming texture only fails to lock when it's given a bad rect:
+		if (SDL_LockTexture(gameViewportTexture, &textureRect, &texturePixels, &texturePitch) != 0) {
+			continue;
+		}
+		for (int32_t row = 0; row < rect.height; row++) {
+			uint16_t *textureRow = (uint16_t *)((uint8_t *)texturePixels + (row * texturePitch));
+			// The game.dat stores the image buffer data in BigEndian
+			// SDL reads FrameBuffers in Platform Native Endian,
+			// so we need to convert if Desktop is LittleEndian.
+			// It goes straight into the texture on the way.
+			#if !defined(IS_SCREEN_BIG_ENDIAN) && defined(IS_LITTLE_ENDIAN)
+				convert_endian_u2_copy(textureRow, topLeft + (row * WIDTH), rect.width);
+			#else
+				memcpy(textureRow, topLeft + (row * WIDTH), rect.width * sizeof(uint16_t));
+			#endif
+		}
+		SDL_UnlockTexture(gameViewportTexture);
+		pixels += rect.width * rect.height;
+	}
+
+	drawFrameComposite(buttonStates, LEDStates);
 
 	SDL_RenderCopy(
 		renderer,
@@ -231,30 +541,54 @@ void EngineWindowFrameGameBlt(uint16_t *frame)
 		&gameViewportDstRect
 	);
 
-	drawButtonStates();
-	drawLEDStates();
-
 	SDL_RenderPresent(renderer);
+	return pixels;
 }
 
-void EngineWindowFrameDestroy()
+static void destroyRenderer()
 {
+	SDL_DestroyTexture(frameCompositeTexture);
+	frameCompositeTexture = nullptr;
 	SDL_DestroyTexture(gameViewportTexture);
 	gameViewportTexture = nullptr;
 	SDL_DestroyTexture(frameTexture);
 	frameTexture = nullptr;
 	SDL_DestroyTexture(frameButtonTexture);
 	frameButtonTexture = nullptr;
-	SDL_FreeSurface(frameButtonSurface);
-	frameButtonSurface = nullptr;
 	SDL_DestroyTexture(frameLEDTexture);
 	frameLEDTexture = nullptr;
+	SDL_DestroyRenderer(renderer);
+	renderer = nullptr;
+}
+
+#if ENGINE_WINDOW_FRAME_PRESENT_THREAD
+static void stopPresentThread()
+{
+	if (!presentThread.joinable()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(presentMutex);
+		presentThreadQuit = true;
+	}
+	presentWake.notify_all();
+	presentThread.join();
+}
+#endif //ENGINE_WINDOW_FRAME_PRESENT_THREAD
+
+void EngineWindowFrameDestroy()
+{
+	#if ENGINE_WINDOW_FRAME_PRESENT_THREAD
+	stopPresentThread();
+	#else
+	destroyRenderer();
+	#endif //ENGINE_WINDOW_FRAME_PRESENT_THREAD
+	SDL_FreeSurface(frameButtonSurface);
+	frameButtonSurface = nullptr;
 	SDL_FreeSurface(frameLEDSurface);
 	frameLEDSurface = nullptr;
 	SDL_FreeSurface(frameSurface);
 	frameSurface = nullptr;
-	SDL_DestroyRenderer(renderer);
-	renderer = nullptr;
 	SDL_DestroyWindow(window);
 	window = nullptr;
 
@@ -6,9 +6,29 @@
 #include <SDL.h>
 #include <SDL_image.h>
 
+//The window is drawn by a present thread of its own, so the game can go on
+//drawing its next frame while SDL is busy presenting the last one.
+//SDL only promises rendering works from the main thread, so it's off by
+//default on Windows, macOS and Emscripten, where that is known to matter.
+//Set this to 0 to present from the game thread instead.
+#ifndef ENGINE_WINDOW_FRAME_PRESENT_THREAD
+#if defined(EMSCRIPTEN) || defined(__APPLE__) || defined(_WIN32)
+#define ENGINE_WINDOW_FRAME_PRESENT_THREAD 0
+#else
+#define ENGINE_WINDOW_FRAME_PRESENT_THREAD 1
+#endif
+#endif //ENGINE_WINDOW_FRAME_PRESENT_THREAD
+
 void EngineWindowFrameInit();
 
-void EngineWindowFrameGameBlt(uint16_t *frame);
+//copies the rects of the frame that changed into the present queue and
+//returns, only those get copied into the window's texture. if the present
+//thread hasn't got to the frame queued before this one yet, that one is
+//dropped, and its rects are sent along with these.
+void EngineWindowFrameGameBlt(uint16_t *frame, const Rectangle *rects, uint8_t rectCount);
+
+const FrameBuffer_PresentStats *EngineWindowFrameGetPresentStats();
+void EngineWindowFrameResetPresentStats();
 
 void EngineWindowFrameDestroy();
 
@@ -12,6 +12,12 @@
 	#include "shim_timer.h"
 	#include "EngineWindowFrame.h"
 	#include <SDL.h>
+	//fills are done 8 pixels at a time where the desktop CPU can:
+	#if defined(__SSE2__)
+		#include <emmintrin.h>
+	#elif defined(__ARM_NEON)
+		#include <arm_neon.h>
+	#endif
 #endif
 
 #ifndef min
@@ -32,9 +38,28 @@ static uint16_t m_color = COLOR_WHITE;
 static bool m_wrap = true;
 static volatile bool m_stop = false;
 
+#if FRAMEBUFFER_FULL_FRAME
 uint16_t frame[FRAMEBUFFER_SIZE];
+#endif //FRAMEBUFFER_FULL_FRAME
+//one band can be drawn while the display is still reading the other:
+static uint16_t bandBuffers[2][FRAMEBUFFER_BAND_SIZE];
+static FrameBuffer_BandStats bandStats = {};
+#ifdef DC801_EMBEDDED
+static FrameBuffer_PresentStats presentStats = {};
+#endif
+//the columns of every screen row drawn to since it was last sent, left up
+//to right, nothing when they're the same. every frame is drawn whole, so a
+//hash of what was sent tells which of those rows really changed:
+static int16_t dirtyLeft[HEIGHT];
+static int16_t dirtyRight[HEIGHT];
+//0 is a row whose pixels on the screen aren't known:
+static uint64_t sentRowHashes[HEIGHT];
+static uint32_t pixelsRefreshed = 0;
 FrameBuffer canvas;
 
+void draw_raw_async(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *p_raw);
+void draw_rect_async(const Rectangle &rect, const uint16_t *p_raw, uint16_t pitch);
+
 extern "C" {
 	FrameBuffer *p_canvas()
 	{
@@ -46,57 +71,307 @@ FrameBuffer::FrameBuffer() {
 	fadeFraction = 0.0f;
 	isFading = false;
 	fadeColor = 0x0000;
+	bandRendering = FRAMEBUFFER_BAND_RENDERING;
+	frameCount = 0;
+	resetBand();
 }
 FrameBuffer::~FrameBuffer() {}
 
-void FrameBuffer::clearScreen(uint16_t color) {
-	for (uint32_t i = 0; i < FRAMEBUFFER_SIZE; ++i)
-	{
-		frame[i] = SCREEN_ENDIAN_U2_VALUE(color);
+void FrameBuffer::setBand(uint16_t *pixels, int32_t top, int32_t bottom) {
+	bandPixels = pixels;
+	bandTop = top;
+	bandBottom = bottom;
+	resetDrawTarget();
+}
+
+void FrameBuffer::markDirty(int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+	x1 = MAX(x1, 0);
+	y1 = MAX(y1, 0);
+	x2 = MIN(x2, WIDTH);
+	y2 = MIN(y2, HEIGHT);
+	if (x1 >= x2) {
+		return;
+	}
+	for (int32_t y = y1; y < y2; y++) {
+		if (dirtyLeft[y] >= dirtyRight[y]) {
+			dirtyLeft[y] = x1;
+			dirtyRight[y] = x2;
+		} else {
+			dirtyLeft[y] = MIN(dirtyLeft[y], x1);
+			dirtyRight[y] = MAX(dirtyRight[y], x2);
+		}
 	}
 }
 
-void FrameBuffer::drawPixel(int x, int y, uint16_t color) {
-	frame[y * WIDTH + x] = SCREEN_ENDIAN_U2_VALUE(color);
+//64 bit FNV-1a of the pixels left up to right of a row, and where they are.
+//keeping a copy of every row sent to compare against instead would take
+//another frame of RAM the badge doesn't have, so this takes the chance of
+//two different rows hashing the same, about one in 2^64 for each row of a
+//frame. when it happens the old row is left on the screen until it changes
+//again, or FRAMEBUFFER_REFRESH_ROWS comes around to it:
+static uint64_t hashRow(const uint16_t *row, int32_t left, int32_t right) {
+	uint64_t hash = 14695981039346656037ull ^ (uint64_t)(left | (right << 16));
+	for (int32_t x = left; x < right; x++) {
+		hash = (hash ^ row[x]) * 1099511628211ull;
+	}
+	return hash != 0 ? hash : 1;
 }
 
-void FrameBuffer::drawHorizontalLine(int x1, int y, int x2, uint16_t color) {
-	int s1 = min(x1, x2);
-	int s2 = max(x1, x2);
-	if (y < 0 || y >= HEIGHT) { return; }
-	for (int x = s1; x <= s2; ++x) {
+uint8_t FrameBuffer::takeDirtyRects(
+	const uint16_t *pixels,
+	int32_t top,
+	int32_t bottom,
+	Rectangle *rects
+) {
+	uint8_t count = 0;
+	//the rows of this frame's turn, in one piece so they take one rect:
+	int32_t refreshTop = (frameCount % (HEIGHT / FRAMEBUFFER_REFRESH_ROWS)) * FRAMEBUFFER_REFRESH_ROWS;
+	for (int32_t y = top; y < bottom; y++) {
+		int32_t left = dirtyLeft[y];
+		int32_t right = dirtyRight[y];
+		dirtyLeft[y] = 0;
+		dirtyRight[y] = 0;
+		if (left >= right) {
+			continue;
+		}
+		uint64_t hash = hashRow(pixels + ((y - top) * WIDTH), left, right);
+		if (hash == sentRowHashes[y]) {
+			if (y < refreshTop || y >= refreshTop + FRAMEBUFFER_REFRESH_ROWS) {
+				continue;
+			}
+			pixelsRefreshed += right - left;
+		}
+		sentRowHashes[y] = hash;
+		Rectangle *last = count != 0 ? &rects[count - 1] : NULL;
 		if (
-			x >= 0
-			&& x < WIDTH
+			last != NULL
+			&& (
+				last->y + last->height == y
+				|| count == FRAMEBUFFER_DIRTY_RECT_COUNT
+			)
 		) {
-			frame[x + (y * WIDTH)] = SCREEN_ENDIAN_U2_VALUE(color);
+			//the row right under it, or there's no room for another one:
+			int32_t lastRight = last->x + last->width;
+			last->x = MIN(last->x, left);
+			last->width = MAX(lastRight, right) - last->x;
+			last->height = (y + 1) - last->y;
+		} else {
+			rects[count++] = Rectangle(left, y, right - left, 1);
+		}
+	}
+	return count;
+}
+
+void FrameBuffer::invalidateScreen() {
+	memset(sentRowHashes, 0, sizeof(sentRowHashes));
+}
+
+void FrameBuffer::resetBand() {
+	#if FRAMEBUFFER_FULL_FRAME
+	setBand(frame, 0, HEIGHT);
+	#else
+	//nothing outside of renderBands makes it to the screen without a frame,
+	//but it still needs somewhere to go:
+	setBand(bandBuffers[0], 0, FRAMEBUFFER_BAND_HEIGHT);
+	#endif //FRAMEBUFFER_FULL_FRAME
+}
+
+void FrameBuffer::setDrawTarget(uint16_t *buffer, int32_t width, int32_t height) {
+	drawTarget = buffer;
+	drawTargetWidth = width;
+	drawTargetHeight = height;
+	drawTargetTop = 0;
+}
+
+void FrameBuffer::resetDrawTarget() {
+	setDrawTarget(bandPixels, WIDTH, bandBottom - bandTop);
+	drawTargetTop = bandTop;
+}
+
+void FrameBuffer::renderBands(void (*draw)(void *data), void *data) {
+	frameCount++;
+	if (!bandRendering) {
+		#if FRAMEBUFFER_FULL_FRAME
+		waitForPresent();
+		draw(data);
+		blt();
+		#endif //FRAMEBUFFER_FULL_FRAME
+		return;
+	}
+	for (int32_t band = 0; band < FRAMEBUFFER_BAND_COUNT; band++) {
+		//the band before this one may still be on its way to the screen,
+		//but it's in the other buffer:
+		uint16_t *pixels = bandBuffers[band & 1];
+		int32_t top = band * FRAMEBUFFER_BAND_HEIGHT;
+		uint32_t start = micros();
+		setBand(pixels, top, top + FRAMEBUFFER_BAND_HEIGHT);
+		draw(data);
+		uint32_t drawn = micros();
+		presentBand(pixels, top);
+		bandStats.drawMicroseconds[band] += drawn - start;
+		bandStats.waitMicroseconds[band] += micros() - drawn;
+	}
+	bandStats.frames++;
+	resetBand();
+	#if FRAMEBUFFER_FULL_FRAME
+	//the bands were put together in the frame:
+	blt();
+	#endif //FRAMEBUFFER_FULL_FRAME
+}
+
+void FrameBuffer::presentBand(const uint16_t *pixels, int32_t top) {
+	#if FRAMEBUFFER_FULL_FRAME
+	//only what was drawn into the band, the same as the badge sends, so a
+	//draw that doesn't cover all of it leaves the rest of the frame alone:
+	for (int32_t y = top; y < top + FRAMEBUFFER_BAND_HEIGHT; y++) {
+		if (dirtyLeft[y] < dirtyRight[y]) {
+			memcpy(
+				&frame[(y * WIDTH) + dirtyLeft[y]],
+				pixels + ((y - top) * WIDTH) + dirtyLeft[y],
+				(dirtyRight[y] - dirtyLeft[y]) * sizeof(uint16_t)
+			);
 		}
 	}
+	#else
+	//the display takes one transfer at a time, and this buffer can't be
+	//drawn into again until the one after this is drawn, so it's done by then:
+	Rectangle rects[FRAMEBUFFER_DIRTY_RECT_COUNT];
+	uint8_t rectCount = takeDirtyRects(pixels, top, top + FRAMEBUFFER_BAND_HEIGHT, rects);
+	waitForPresent();
+	for (uint8_t index = 0; index < rectCount; index++) {
+		const Rectangle &rect = rects[index];
+		draw_rect_async(rect, pixels + ((rect.y - top) * WIDTH) + rect.x, WIDTH);
+		presentStats.pixelsTransferred += rect.width * rect.height;
+	}
+	presentStats.rectsTransferred += rectCount;
+	if (top + FRAMEBUFFER_BAND_HEIGHT == HEIGHT) {
+		presentStats.framesQueued++;
+		presentStats.framesPresented++;
+	}
+	#endif //FRAMEBUFFER_FULL_FRAME
+}
+
+void FrameBuffer::setBandRendering(bool enabled) {
+	#if FRAMEBUFFER_FULL_FRAME
+	bandRendering = enabled;
+	#endif //FRAMEBUFFER_FULL_FRAME
+}
+
+bool FrameBuffer::getBandRendering() {
+	return bandRendering;
+}
+
+uint32_t FrameBuffer::getFrameCount() {
+	return frameCount;
+}
+
+int32_t FrameBuffer::getBandTop() {
+	return bandTop;
+}
+
+int32_t FrameBuffer::getBandBottom() {
+	return bandBottom;
+}
+
+const FrameBuffer_BandStats *FrameBuffer::getBandStats() {
+	return &bandStats;
+}
+
+void FrameBuffer::resetBandStats() {
+	bandStats = {};
+}
+
+void FrameBuffer::logBandStats(const char *label) {
+	if (bandStats.frames == 0) {
+		return;
+	}
+	debug_print("Bands (%s): %u frames", label, bandStats.frames);
+	for (int32_t band = 0; band < FRAMEBUFFER_BAND_COUNT; band++) {
+		debug_print(
+			"  rows %3d-%3d: draw %5uus wait %5uus",
+			band * FRAMEBUFFER_BAND_HEIGHT,
+			((band + 1) * FRAMEBUFFER_BAND_HEIGHT) - 1,
+			bandStats.drawMicroseconds[band] / bandStats.frames,
+			bandStats.waitMicroseconds[band] / bandStats.frames
+		);
+	}
+}
+
+//fills count pixels starting at destination with color, which has to be
+//screen endian already. Two pixels go in every 32 bit store, and on desktop
+//eight go in every 128 bit one.
+static void fillPixels(uint16_t *destination, int32_t count, uint16_t color) {
+	if (count <= 0) {
+		return;
+	}
+	//the word stores need destination 4 byte aligned:
+	if (((uintptr_t)destination & 0x02) != 0) {
+		*destination++ = color;
+		count--;
+	}
+	#if defined(DC801_DESKTOP) && defined(__SSE2__)
+	__m128i wide = _mm_set1_epi16((int16_t)color);
+	for (; count >= 8; count -= 8, destination += 8) {
+		_mm_storeu_si128((__m128i *)destination, wide);
+	}
+	#elif defined(DC801_DESKTOP) && defined(__ARM_NEON)
+	uint16x8_t wide = vdupq_n_u16(color);
+	for (; count >= 8; count -= 8, destination += 8) {
+		vst1q_u16(destination, wide);
+	}
+	#endif
+	uint32_t pair = color | ((uint32_t)color << 16);
+	for (; count >= 2; count -= 2, destination += 2) {
+		memcpy(destination, &pair, sizeof(pair));
+	}
+	if (count != 0) {
+		*destination = color;
+	}
+}
+
+void FrameBuffer::clearScreen(uint16_t color) {
+	markDirty(0, bandTop, WIDTH, bandBottom);
+	fillPixels(bandPixels, (bandBottom - bandTop) * WIDTH, SCREEN_ENDIAN_U2_VALUE(color));
+}
+
+void FrameBuffer::drawPixel(int x, int y, uint16_t color) {
+	if (x < 0 || x >= WIDTH || y < bandTop || y >= bandBottom) { return; }
+	markDirty(x, y, x + 1, y + 1);
+	bandRow(y)[x] = SCREEN_ENDIAN_U2_VALUE(color);
+}
+
+void FrameBuffer::drawHorizontalLine(int x1, int y, int x2, uint16_t color) {
+	if (y < bandTop || y >= bandBottom) { return; }
+	int s1 = max(min(x1, x2), 0);
+	int s2 = min(max(x1, x2), WIDTH - 1);
+	markDirty(s1, y, s2 + 1, y + 1);
+	fillPixels(bandRow(y) + s1, (s2 - s1) + 1, SCREEN_ENDIAN_U2_VALUE(color));
 }
 
 void FrameBuffer::drawVerticalLine(int x, int y1, int y2, uint16_t color) {
-	int s1 = min(y1, y2);
-	int s2 = max(y1, y2);
 	if (x < 0 || x >= WIDTH) { return; }
+	int s1 = max(min(y1, y2), bandTop);
+	int s2 = min(max(y1, y2), bandBottom - 1);
+	if (s1 > s2) { return; }
+	markDirty(x, s1, x + 1, s2 + 1);
+	color = SCREEN_ENDIAN_U2_VALUE(color);
+	uint16_t *destination = bandRow(s1) + x;
 	for (int y = s1; y <= s2; ++y) {
-		if (
-			y >= 0
-			&& y < HEIGHT
-		) {
-			frame[x + (y * WIDTH)] = SCREEN_ENDIAN_U2_VALUE(color);
-		}
+		*destination = color;
+		destination += WIDTH;
 	}
 }
 
 void FrameBuffer::drawImage(int x, int y, int w, int h, const uint16_t *data)
 {
-	int idx = 0;
-
-	for (int j = y; j < (y + h); ++j)
+	markDirty(x, max(y, bandTop), x + w, min(y + h, bandBottom));
+	for (int j = max(y, bandTop); j < min(y + h, bandBottom); ++j)
 	{
+		int idx = (j - y) * w;
+		uint16_t *row = bandRow(j);
 		for (int i = x; i < (x + w); ++i)
 		{
-			frame[j * WIDTH + i] = data[idx++];
+			row[i] = data[idx++];
 		}
 	}
 
@@ -104,17 +379,18 @@ void FrameBuffer::drawImage(int x, int y, int w, int h, const uint16_t *data)
 
 void FrameBuffer::drawImage(int x, int y, int w, int h, const uint16_t *data, uint16_t transparent_color)
 {
-	int idx = 0;
-
-	for (int j = y; j < (y + h); ++j)
+	markDirty(x, max(y, bandTop), x + w, min(y + h, bandBottom));
+	for (int j = max(y, bandTop); j < min(y + h, bandBottom); ++j)
 	{
+		int idx = (j - y) * w;
+		uint16_t *row = bandRow(j);
 		for (int i=x; i < (x + w); ++i)
 		{
 			uint16_t c = data[idx++];
 
 			if (c != SCREEN_ENDIAN_U2_VALUE(transparent_color))
 			{
-				frame[j*WIDTH+i] = c;
+				row[i] = c;
 			}
 		}
 	}
@@ -122,26 +398,28 @@ void FrameBuffer::drawImage(int x, int y, int w, int h, const uint16_t *data, ui
 
 void FrameBuffer::drawImage(int x, int y, int w, int h, const uint8_t *data)
 {
-	int idx = 0;
-
-	for (int j = y; j < (y + h); ++j)
+	markDirty(x, max(y, bandTop), x + w, min(y + h, bandBottom));
+	for (int j = max(y, bandTop); j < min(y + h, bandBottom); ++j)
 	{
+		int idx = (j - y) * w * 2;
+		uint16_t *row = bandRow(j);
 		for (int i = x; i < (x + w); ++i)
 		{
 			uint8_t d1 = data[idx++];
 			uint8_t d2 = data[idx++];
 
-			frame[j * WIDTH + i] = ((uint16_t) d1 << 8) | d2;
+			row[i] = ((uint16_t) d1 << 8) | d2;
 		}
 	}
 }
 
 void FrameBuffer::drawImage(int x, int y, int w, int h, const uint8_t *data, uint16_t transparent_color)
 {
-	int idx = 0;
-
-	for (int j = y; j < (y + h); ++j)
+	markDirty(x, max(y, bandTop), x + w, min(y + h, bandBottom));
+	for (int j = max(y, bandTop); j < min(y + h, bandBottom); ++j)
 	{
+		int idx = (j - y) * w * 2;
+		uint16_t *row = bandRow(j);
 		for (int i = x; i < (x + w); ++i)
 		{
 			uint8_t d1 = data[idx++];
@@ -150,7 +428,7 @@ void FrameBuffer::drawImage(int x, int y, int w, int h, const uint8_t *data, uin
 
 			if (c != SCREEN_ENDIAN_U2_VALUE(transparent_color))
 			{
-				frame[j * WIDTH + i] = c;
+				row[i] = c;
 			}
 		}
 	}
@@ -158,9 +436,83 @@ void FrameBuffer::drawImage(int x, int y, int w, int h, const uint8_t *data, uin
 
 void FrameBuffer::drawImage(int x, int y, int w, int h, const uint16_t *data, int fx, int fy, int pitch)
 {
-	for (int i = 0, idx = pitch * fy + fx; i < h; ++i, idx += pitch)
+	int last = min(y + h, bandBottom) - y;
+	markDirty(x, max(y, bandTop), x + w, y + last);
+	for (int i = max(y, bandTop) - y; i < last; ++i)
+	{
+		memcpy(bandRow(y + i) + x, &data[pitch * (fy + i) + fx], sizeof(uint16_t) * w);
+	}
+}
+
+uint32_t FrameBuffer::buildImageSpans(const uint16_t *data, int w, int h, uint16_t transparent_color, uint16_t *spans)
+{
+	uint32_t length = 0;
+	for (int row = 0; row < h; ++row)
 	{
-		memcpy(&frame[(y + i) * WIDTH + x], &data[idx], sizeof(uint16_t) * w);
+		const uint16_t *source = &data[row * w];
+		uint32_t countIndex = length++;
+		uint16_t runCount = 0;
+		int col = 0;
+		while (col < w)
+		{
+			while (col < w && source[col] == transparent_color)
+			{
+				++col;
+			}
+			if (col == w)
+			{
+				break;
+			}
+			int start = col;
+			while (col < w && source[col] != transparent_color)
+			{
+				++col;
+			}
+			if (spans != NULL)
+			{
+				spans[length] = start;
+				spans[length + 1] = col - start;
+			}
+			length += 2;
+			runCount++;
+		}
+		if (spans != NULL)
+		{
+			spans[countIndex] = runCount;
+		}
+	}
+	return length;
+}
+
+void FrameBuffer::drawImageSpans(int x, int y, int w, int h, const uint16_t *data, const uint16_t *spans)
+{
+	int first = max(y, bandTop);
+	int last = min(y + h, bandBottom);
+	if (first >= last || x >= WIDTH || x + w <= 0)
+	{
+		return;
+	}
+	markDirty(max(x, 0), first, min(x + w, WIDTH), last);
+	for (int row = y; row < last; ++row)
+	{
+		uint16_t runCount = *spans++;
+		if (row < first)
+		{
+			spans += runCount * 2;
+			continue;
+		}
+		const uint16_t *source = &data[(row - y) * w];
+		for (uint16_t run = 0; run < runCount; ++run)
+		{
+			int start = max(x + spans[0], 0);
+			int end = min(x + spans[0] + spans[1], WIDTH);
+			spans += 2;
+			if (start >= end)
+			{
+				continue;
+			}
+			memcpy(bandRow(row) + start, &source[start - x], sizeof(uint16_t) * (end - start));
+		}
 	}
 }
 
@@ -177,7 +529,8 @@ void FrameBuffer::drawImage(
 ) {
 	int32_t current_x = 0;
 	int32_t current_y = 0;
-	for (int offsetY = 0; (offsetY < h) && (current_y < HEIGHT); ++offsetY)
+	markDirty(x, max(y, bandTop), x + w, min(y + h, bandBottom));
+	for (int offsetY = 0; (offsetY < h) && (current_y < bandBottom); ++offsetY)
 	{
 		current_y = offsetY + y;
 		current_x = 0;
@@ -187,14 +540,14 @@ void FrameBuffer::drawImage(
 			if (
 				current_x >= 0
 				&& current_x < WIDTH
-				&& current_y >= 0
-				&& current_y < HEIGHT
+				&& current_y >= bandTop
+				&& current_y < bandBottom
 			)
 			{
 				uint16_t color = data[pitch * (fy + offsetY) + offsetX + fx];
 				if (color != SCREEN_ENDIAN_U2_VALUE(transparent_color))
 				{
-					frame[(current_y * WIDTH) + current_x] = color;
+					bandRow(current_y)[current_x] = color;
 				}
 			}
 		}
@@ -222,7 +575,8 @@ void FrameBuffer::drawImageWithFlags(
 	bool flip_x    = flags & FLIPPED_HORIZONTALLY_FLAG;
 	bool flip_y    = flags & FLIPPED_VERTICALLY_FLAG;
 	bool flip_diag = flags & FLIPPED_DIAGONALLY_FLAG;
-	for (int offset_y = 0; (offset_y < h) && (current_y < HEIGHT); ++offset_y)
+	markDirty(x, max(y, bandTop), x + w, min(y + h, bandBottom));
+	for (int offset_y = 0; (offset_y < h) && (current_y < bandBottom); ++offset_y)
 	{
 		current_y = offset_y + y;
 		current_x = 0;
@@ -232,8 +586,8 @@ void FrameBuffer::drawImageWithFlags(
 			if (
 				current_x >= 0
 				&& current_x < WIDTH
-				&& current_y >= 0
-				&& current_y < HEIGHT
+				&& current_y >= bandTop
+				&& current_y < bandBottom
 			)
 			{
 				source_x = flip_diag ? offset_y : offset_x;
@@ -247,7 +601,7 @@ void FrameBuffer::drawImageWithFlags(
 				uint16_t color = data[(pitch * sprite_y) + sprite_x];
 				if (color != SCREEN_ENDIAN_U2_VALUE(transparent_color))
 				{
-					frame[(current_y * WIDTH) + current_x] = color;
+					bandRow(current_y)[current_x] = color;
 				}
 			}
 		}
@@ -265,679 +619,464 @@ void FrameBuffer::drawChunkWithFlags(
 	uint16_t source_y, // top-left corner of source image coordinates to READ FROM
 	uint16_t pitch, // The width of the source image in pixels
 	uint16_t transparent_color,
-	uint8_t flags
+	uint8_t flags,
+	const uint8_t *spans
 )
 {
-	MageColorPalette colorPaletteFaded;
 	MageColorPalette *colorPalette = colorPaletteOriginal;
 	RenderFlagsUnion flagSplit;
 	flagSplit.i = flags;
-	bool flip_x    = flagSplit.f.horizontal;
-	bool flip_y    = flagSplit.f.vertical;
 	bool flip_diag = flagSplit.f.diagonal;
 	bool glitched = flagSplit.f.glitched;
 	transparent_color = SCREEN_ENDIAN_U2_VALUE(transparent_color);
+	//from here on, y is a row of the draw target:
+	screen_y -= drawTargetTop;
 	if(glitched) {
 		screen_x += tile_width * 0.125;
 		tile_width *= 0.75;
 	}
 	if (
 		screen_x + tile_width < 0	||
-		screen_x >= WIDTH			||
-		screen_y + tile_width < 0	||
-		screen_y >= HEIGHT
+		screen_x >= drawTargetWidth			||
+		screen_y + tile_height < 0	||
+		screen_y >= drawTargetHeight
 	) {
 		return;
 	}
-	uint8_t pixels[tile_width * tile_height];
-
-	EngineROM_Read(
-		address + ((source_y * pitch) + source_x),
-		tile_width * tile_height,
-		(uint8_t *)&pixels,
-		"Failed to read pixel data"
-	);
+	if (drawTarget == bandPixels) {
+		//and not the layer cache:
+		markDirty(
+			screen_x,
+			MAX(screen_y, 0) + drawTargetTop,
+			screen_x + tile_width,
+			MIN(screen_y + tile_height, drawTargetHeight) + drawTargetTop
+		);
+	}
+	//spans are only worked out for TRANSPARENCY_COLOR and the tile's real size,
+	//and a glitched tile is read with a different width:
+	if (
+		flip_diag
+		|| glitched
+		|| transparent_color != SCREEN_ENDIAN_U2_VALUE(TRANSPARENCY_COLOR)
+	) {
+		spans = NULL;
+	}
+	//the source is counted in pixels, and those can be two to a byte:
+	bool packed = colorPaletteOriginal->packed();
+	address += EngineImage_Offset((source_y * pitch) + source_x, packed);
+	uint32_t tile_bytes = EngineImage_Bytes(tile_width * tile_height, packed);
+	if(fadeFraction == 0) {
+		//every frame of a fade would be a different palette, so those skip the cache
+		const EngineTileCache_Tile *tile = EngineTileCache_Get(
+			address,
+			colorPaletteOriginal,
+			tile_width,
+			tile_height,
+			transparent_color,
+			flags
+		);
+		if(tile != NULL) {
+			tileToBufferCached(tile, screen_x, screen_y);
+			return;
+		}
+	}
+	const uint8_t *pixels = EngineROM_View(address, tile_bytes);
 
 	if(fadeFraction != 0) {
-		colorPaletteFaded = MageColorPalette(
-			colorPaletteOriginal,
+		colorPalette = colorPaletteOriginal->getFadedPalette(
 			transparent_color,
 			fadeColor,
 			fadeFraction
 		);
-		colorPalette = &colorPaletteFaded;
 	}
 
-	if(flip_x == false && flip_y == false && flip_diag == false) {
-		tileToBufferNoXNoYNoZ(
-			pixels,
-			colorPalette,
-			screen_x,
-			screen_y,
-			tile_width,
-			tile_height,
-			source_x,
-			source_y,
-			pitch,
-			transparent_color
-		);
-	} else if (flip_x == true && flip_y == false && flip_diag == false) {
-		tileToBufferYesXNoYNoZ(
-			pixels,
-			colorPalette,
-			screen_x,
-			screen_y,
-			tile_width,
-			tile_height,
-			source_x,
-			source_y,
-			pitch,
-			transparent_color
-		);
-	} else if (flip_x == false && flip_y == true && flip_diag == false) {
-		tileToBufferNoXYesYNoZ(
-			pixels,
-			colorPalette,
-			screen_x,
-			screen_y,
-			tile_width,
-			tile_height,
-			source_x,
-			source_y,
-			pitch,
-			transparent_color
-		);
-	} else if (flip_x == true && flip_y == true && flip_diag == false) {
-		tileToBufferYesXYesYNoZ(
-			pixels,
-			colorPalette,
-			screen_x,
-			screen_y,
-			tile_width,
-			tile_height,
-			source_x,
-			source_y,
-			pitch,
-			transparent_color
-		);
-	} else if(flip_x == false && flip_y == false && flip_diag == true) {
-		tileToBufferNoXNoYYesZ(
-			pixels,
-			colorPalette,
-			screen_x,
-			screen_y,
-			tile_width,
-			tile_height,
-			source_x,
-			source_y,
-			pitch,
-			transparent_color
-		);
-	} else if (flip_x == true && flip_y == false && flip_diag == true) {
-		tileToBufferYesXNoYYesZ(
-			pixels,
-			colorPalette,
-			screen_x,
-			screen_y,
-			tile_width,
-			tile_height,
-			source_x,
-			source_y,
-			pitch,
-			transparent_color
-		);
-	} else if (flip_x == false && flip_y == true && flip_diag == true) {
-		tileToBufferNoXYesYYesZ(
-			pixels,
-			colorPalette,
-			screen_x,
-			screen_y,
-			tile_width,
-			tile_height,
-			source_x,
-			source_y,
-			pitch,
-			transparent_color
+	//a palette without the transparent color can't make any pixel transparent:
+	bool keyed = !colorPalette->opaque
+		|| transparent_color != SCREEN_ENDIAN_U2_VALUE(TRANSPARENCY_COLOR);
+	blitTile(
+		drawTarget,
+		pixels,
+		packed,
+		spans,
+		colorPalette->colors.get(),
+		screen_x,
+		screen_y,
+		tile_width,
+		tile_height,
+		keyed,
+		transparent_color,
+		flags
+	);
+}
+
+void FrameBuffer::blitTile(
+	uint16_t *target,
+	const uint8_t *pixels,
+	bool packed,
+	const uint8_t *spans,
+	const uint16_t *colors,
+	int32_t screen_x,
+	int32_t screen_y,
+	uint16_t tile_width,
+	uint16_t tile_height,
+	bool keyed,
+	uint16_t transparent_color,
+	uint8_t flags
+)
+{
+	RenderFlagsUnion flagSplit;
+	flagSplit.i = flags;
+	bool flip_x    = flagSplit.f.horizontal;
+	bool flip_y    = flagSplit.f.vertical;
+	bool flip_diag = flagSplit.f.diagonal;
+	//indexed by flags & 0x07: diagonal is bit 0, vertical bit 1, horizontal bit 2
+	typedef void (FrameBuffer::*TileBlitter)(
+		uint16_t *target,
+		const uint8_t *pixels,
+		const uint16_t *colors,
+		int32_t screen_x,
+		int32_t screen_y,
+		uint16_t tile_width,
+		uint16_t tile_height,
+		uint16_t transparent_color
+	);
+	static const TileBlitter keyedBlitters[8] = {
+		&FrameBuffer::tileToBuffer<false, false, false, true>,
+		&FrameBuffer::tileToBuffer<false, false, true, true>,
+		&FrameBuffer::tileToBuffer<false, true, false, true>,
+		&FrameBuffer::tileToBuffer<false, true, true, true>,
+		&FrameBuffer::tileToBuffer<true, false, false, true>,
+		&FrameBuffer::tileToBuffer<true, false, true, true>,
+		&FrameBuffer::tileToBuffer<true, true, false, true>,
+		&FrameBuffer::tileToBuffer<true, true, true, true>,
+	};
+	static const TileBlitter opaqueBlitters[8] = {
+		&FrameBuffer::tileToBuffer<false, false, false, false>,
+		&FrameBuffer::tileToBuffer<false, false, true, false>,
+		&FrameBuffer::tileToBuffer<false, true, false, false>,
+		&FrameBuffer::tileToBuffer<false, true, true, false>,
+		&FrameBuffer::tileToBuffer<true, false, false, false>,
+		&FrameBuffer::tileToBuffer<true, false, true, false>,
+		&FrameBuffer::tileToBuffer<true, true, false, false>,
+		&FrameBuffer::tileToBuffer<true, true, true, false>,
+	};
+	if (keyed && spans != NULL) {
+		typedef void (FrameBuffer::*SpanBlitter)(
+			uint16_t *target,
+			const uint8_t *pixels,
+			const uint8_t *spans,
+			const uint16_t *colors,
+			int32_t screen_x,
+			int32_t screen_y,
+			uint16_t tile_width,
+			uint16_t tile_height
 		);
-	} else if (flip_x == true && flip_y == true && flip_diag == true) {
-		tileToBufferYesXYesYYesZ(
+		static const SpanBlitter spanBlitters[8] = {
+			&FrameBuffer::tileSpansToBuffer<false, false, false>,
+			&FrameBuffer::tileSpansToBuffer<false, true, false>,
+			&FrameBuffer::tileSpansToBuffer<true, false, false>,
+			&FrameBuffer::tileSpansToBuffer<true, true, false>,
+			&FrameBuffer::tileSpansToBuffer<false, false, true>,
+			&FrameBuffer::tileSpansToBuffer<false, true, true>,
+			&FrameBuffer::tileSpansToBuffer<true, false, true>,
+			&FrameBuffer::tileSpansToBuffer<true, true, true>,
+		};
+		(this->*spanBlitters[(packed << 2) | (flip_x << 1) | flip_y])(
+			target,
 			pixels,
-			colorPalette,
+			spans,
+			colors,
 			screen_x,
 			screen_y,
 			tile_width,
-			tile_height,
-			source_x,
-			source_y,
-			pitch,
-			transparent_color
+			tile_height
 		);
+		return;
 	}
-}
-
-void FrameBuffer::tileToBufferNoXNoYNoZ(
-	uint8_t * pixels,
-	MageColorPalette * colorPalette,
-	int32_t screen_x,
-	int32_t screen_y,
-	uint16_t tile_width,
-	uint16_t tile_height,
-	uint16_t source_x,
-	uint16_t source_y,
-	uint16_t pitch,
-	uint16_t transparent_color
-) {
-	uint16_t color = transparent_color;
-	int32_t screen_x_start = 0;
-	int32_t screen_y_start = 0;
-	uint32_t screen_index = 0;
-	uint32_t tile_index = 0;
-	Point a = { .x = 0, .y = 0 };
-	Point d = { .x = 0, .y = 0 };
-	if(screen_x < 0){
-		a.x = -screen_x;
-		d.x = tile_width;
-		screen_x_start = 0;
-	} else if (screen_x+tile_width >= WIDTH) {
-		a.x = 0;
-		d.x = WIDTH - screen_x;
-		screen_x_start = screen_x;
-	} else {
-		a.x = 0;
-		d.x = tile_width;
-		screen_x_start = screen_x;
-	}
-	if(screen_y < 0){
-		a.y = -screen_y;
-		d.y= tile_height;
-		screen_y_start = 0;
-	} else if (screen_y+tile_height >= HEIGHT) {
-		a.y = 0;
-		d.y = HEIGHT - screen_y;
-		screen_y_start = screen_y;
-	} else {
-		a.y = 0;
-		d.y = tile_height;
-		screen_y_start = screen_y;
-	}
-	uint16_t num_rows = d.y - a.y;
-	uint16_t num_cols = d.x - a.x;
-	for (uint16_t row = 0; row< num_rows; row++){
-		for(uint16_t col = 0; col < num_cols; col++) {
-			screen_index =(
-				(screen_x_start + col) + //x
-				((screen_y_start + row) * WIDTH) //y
+	if (packed) {
+		if (keyed) {
+			tileNibblesToBuffer<true>(
+				target,
+				pixels,
+				colors,
+				screen_x,
+				screen_y,
+				tile_width,
+				tile_height,
+				transparent_color,
+				flags
 			);
-			tile_index = (
-				(a.x + col) + //x
-				((a.y + row) * tile_width) //y
+		} else {
+			tileNibblesToBuffer<false>(
+				target,
+				pixels,
+				colors,
+				screen_x,
+				screen_y,
+				tile_width,
+				tile_height,
+				transparent_color,
+				flags
 			);
-			uint8_t color_index = pixels[tile_index];
-			color = colorPalette->colors[color_index];
-			if (color != transparent_color) {
-				frame[screen_index] = color;
-			}
 		}
+		return;
 	}
+	const TileBlitter blitter = (keyed ? keyedBlitters : opaqueBlitters)[
+		(flip_x << 2) | (flip_y << 1) | flip_diag
+	];
+	(this->*blitter)(
+		target,
+		pixels,
+		colors,
+		screen_x,
+		screen_y,
+		tile_width,
+		tile_height,
+		transparent_color
+	);
 }
 
-void FrameBuffer::tileToBufferYesXNoYNoZ(
-	uint8_t * pixels,
-	MageColorPalette * colorPalette,
+void FrameBuffer::tileToBufferCached(
+	const EngineTileCache_Tile *tile,
 	int32_t screen_x,
-	int32_t screen_y,
-	uint16_t tile_width,
-	uint16_t tile_height,
-	uint16_t source_x,
-	uint16_t source_y,
-	uint16_t pitch,
-	uint16_t transparent_color
+	int32_t screen_y
 ) {
-	uint16_t color = transparent_color;
-	int32_t screen_x_start = 0;
-	int32_t screen_y_start = 0;
-	uint32_t screen_index = 0;
-	uint32_t tile_index = 0;
-	Point a = { .x = 0, .y = 0 };
-	Point d = { .x = 0, .y = 0 };
-	if(screen_x < 0){
-		a.x = screen_x + tile_width;
-		d.x = 0;
-		screen_x_start = 0;
-	} else if (screen_x+tile_width >= WIDTH) {
-		a.x = tile_width;
-		d.x = (screen_x + tile_width) - WIDTH;
-		screen_x_start = screen_x;
-	} else {
-		a.x = tile_width;
-		d.x = 0;
-		screen_x_start = screen_x;
-	}
-	if(screen_y < 0){
-		a.y = -screen_y;
-		d.y= tile_height;
-		screen_y_start = 0;
-	} else if (screen_y+tile_height >= HEIGHT) {
-		a.y = 0;
-		d.y = HEIGHT - screen_y;
-		screen_y_start = screen_y;
-	} else {
-		a.y = 0;
-		d.y = tile_height;
-		screen_y_start = screen_y;
-	}
-	uint16_t num_rows = d.y - a.y;
-	uint16_t num_cols = a.x - d.x;
-	for (uint16_t row = 0; row< num_rows; row++){
-		for(uint16_t col = 0; col < num_cols; col++) {
-			screen_index =(
-				(screen_x_start + col) + //x
-				((screen_y_start + row) * WIDTH) //y
-			);
-			tile_index = (
-				(a.x - (col+1)) + //x (+1 to get back to zero-index)
-				((a.y + row) * tile_width) //y
-			);
-			uint8_t color_index = pixels[tile_index];
-			color = colorPalette->colors[color_index];
-			if (color != transparent_color) {
-				frame[screen_index] = color;
-			}
-		}
+	//the flips were already applied when the tile was decoded,
+	//so this only has to clip it to the screen and copy it
+	int32_t first_col = screen_x < 0 ? -screen_x : 0;
+	int32_t first_row = screen_y < 0 ? -screen_y : 0;
+	int32_t last_col = MIN(tile->width, drawTargetWidth - screen_x);
+	int32_t last_row = MIN(tile->height, drawTargetHeight - screen_y);
+	if (first_col >= last_col || first_row >= last_row) {
+		return;
 	}
-}
-
-void FrameBuffer::tileToBufferNoXYesYNoZ(
-	uint8_t * pixels,
-	MageColorPalette * colorPalette,
-	int32_t screen_x,
-	int32_t screen_y,
-	uint16_t tile_width,
-	uint16_t tile_height,
-	uint16_t source_x,
-	uint16_t source_y,
-	uint16_t pitch,
-	uint16_t transparent_color
-) {
-	uint16_t color = transparent_color;
-	int32_t screen_x_start = 0;
-	int32_t screen_y_start = 0;
-	uint32_t screen_index = 0;
-	uint32_t tile_index = 0;
-	Point a = { .x = 0, .y = 0 };
-	Point d = { .x = 0, .y = 0 };
-	if(screen_x < 0){
-		a.x = -screen_x;
-		d.x = tile_width;
-		screen_x_start = 0;
-	} else if (screen_x+tile_width >= WIDTH) {
-		a.x = 0;
-		d.x = WIDTH - screen_x;
-		screen_x_start = screen_x;
-	} else {
-		a.x = 0;
-		d.x = tile_width;
-		screen_x_start = screen_x;
-	}
-	if(screen_y < 0){
-		a.y = screen_y + tile_height;
-		d.y = 0;
-		screen_y_start = 0;
-	} else if (screen_y+tile_height >= HEIGHT) {
-		a.y = tile_height;
-		d.y = (screen_y + tile_height) - HEIGHT;
-		screen_y_start = screen_y;
-	} else {
-		a.y = tile_height;
-		d.y = 0;
-		screen_y_start = screen_y;
-	}
-	uint16_t num_rows = a.y - d.y;
-	uint16_t num_cols = d.x - a.x;
-	for (uint16_t row = 0; row< num_rows; row++){
-		for(uint16_t col = 0; col < num_cols; col++) {
-			screen_index =(
-				(screen_x_start + col) + //x
-				((screen_y_start + row) * WIDTH) //y
-			);
-			tile_index = (
-				(a.x + col) + //x
-				((a.y - (row + 1)) * tile_width) //y (+1 to get back to zero-index)
-			);
-			uint8_t color_index = pixels[tile_index];
-			color = colorPalette->colors[color_index];
-			if (color != transparent_color) {
-				frame[screen_index] = color;
+	uint16_t num_cols = last_col - first_col;
+	uint16_t transparent_color = tile->transparentColor;
+	for (int32_t row = first_row; row < last_row; row++) {
+		const uint16_t *source = &tile->pixels[(row * tile->width) + first_col];
+		uint16_t *destination = &drawTarget[((screen_y + row) * drawTargetWidth) + screen_x + first_col];
+		if (tile->opaque) {
+			memcpy(destination, source, num_cols * sizeof(uint16_t));
+		} else {
+			for (uint16_t col = 0; col < num_cols; col++) {
+				if (source[col] != transparent_color) {
+					destination[col] = source[col];
+				}
 			}
 		}
 	}
 }
 
-void FrameBuffer::tileToBufferYesXYesYNoZ(
-	uint8_t * pixels,
-	MageColorPalette * colorPalette,
+template <bool FlipX, bool FlipY, bool FlipDiagonal, bool Keyed>
+void FrameBuffer::tileToBuffer(
+	uint16_t *target,
+	const uint8_t *pixels,
+	const uint16_t *colors,
 	int32_t screen_x,
 	int32_t screen_y,
 	uint16_t tile_width,
 	uint16_t tile_height,
-	uint16_t source_x,
-	uint16_t source_y,
-	uint16_t pitch,
 	uint16_t transparent_color
-) {
-	uint16_t color = transparent_color;
-	int32_t screen_x_start = 0;
-	int32_t screen_y_start = 0;
-	uint32_t screen_index = 0;
-	uint32_t tile_index = 0;
-	Point a = { .x = 0, .y = 0 };
-	Point d = { .x = 0, .y = 0 };
-	if(screen_x < 0){
-		a.x = screen_x + tile_width;
-		d.x = 0;
-		screen_x_start = 0;
-	} else if (screen_x+tile_width >= WIDTH) {
-		a.x = tile_width;
-		d.x = (screen_x + tile_width) - WIDTH;
-		screen_x_start = screen_x;
-	} else {
-		a.x = tile_width;
-		d.x = 0;
-		screen_x_start = screen_x;
-	}
-	if(screen_y < 0){
-		a.y = screen_y + tile_height;
-		d.y = 0;
-		screen_y_start = 0;
-	} else if (screen_y+tile_height >= HEIGHT) {
-		a.y = tile_height;
-		d.y = (screen_y + tile_height) - HEIGHT;
-		screen_y_start = screen_y;
-	} else {
-		a.y = tile_height;
-		d.y = 0;
-		screen_y_start = screen_y;
-	}
-	uint16_t num_rows = a.y - d.y;
-	uint16_t num_cols = a.x - d.x;
-	for (uint16_t row = 0; row< num_rows; row++){
-		for(uint16_t col = 0; col < num_cols; col++) {
-			screen_index =(
-				(screen_x_start + col) + //x
-				((screen_y_start + row) * WIDTH) //y
-			);
-			tile_index = (
-				(a.x - (col+1)) + //x (+1 to get back to zero-index)
-				((a.y - (row+1)) * tile_width) //y (+1 to get back to zero-index)
-			);
-			uint8_t color_index = pixels[tile_index];
-			color = colorPalette->colors[color_index];
-			if (color != transparent_color) {
-				frame[screen_index] = color;
+)
+{
+	//the part of the tile that lands on the draw target, in tile space:
+	int32_t first_col = MAX(0, -screen_x);
+	int32_t first_row = MAX(0, -screen_y);
+	int32_t last_col = MIN((int32_t)tile_width, drawTargetWidth - screen_x);
+	int32_t last_row = MIN((int32_t)tile_height, drawTargetHeight - screen_y);
+	if (first_col >= last_col || first_row >= last_row) {
+		return;
+	}
+	int32_t num_cols = last_col - first_col;
+	//the screen pixel at (col, row) of the tile comes from
+	//tile_x = FlipX ? tile_width - 1 - col : col,
+	//tile_y = FlipY ? tile_height - 1 - row : row,
+	//and the diagonal flip swaps which of those is the row in pixels.
+	//stepping right or down on the screen is then a fixed step through pixels:
+	const int32_t col_step = (FlipDiagonal ? tile_width : 1) * (FlipX ? -1 : 1);
+	const int32_t row_step = (FlipDiagonal ? 1 : tile_width) * (FlipY ? -1 : 1);
+	int32_t tile_x = FlipX ? tile_width - 1 - first_col : first_col;
+	int32_t tile_y = FlipY ? tile_height - 1 - first_row : first_row;
+	const uint8_t *source_row = pixels + (FlipDiagonal
+		? tile_y + (tile_x * tile_width)
+		: tile_x + (tile_y * tile_width));
+	uint16_t *destination_row = target
+		+ ((screen_y + first_row) * drawTargetWidth)
+		+ (screen_x + first_col);
+	for (int32_t row = first_row; row < last_row; row++) {
+		const uint8_t *source = source_row;
+		uint16_t *destination = destination_row;
+		if (Keyed) {
+			for (int32_t col = 0; col < num_cols; col++) {
+				uint16_t color = colors[*source];
+				if (color != transparent_color) {
+					*destination = color;
+				}
+				source += col_step;
+				destination++;
+			}
+		} else {
+			//nothing to skip, so every pixel of the row is written
+			for (int32_t col = 0; col < num_cols; col++) {
+				*destination++ = colors[*source];
+				source += col_step;
 			}
 		}
+		source_row += row_step;
+		destination_row += drawTargetWidth;
 	}
 }
 
-void FrameBuffer::tileToBufferNoXNoYYesZ(
-	uint8_t * pixels,
-	MageColorPalette * colorPalette,
+template <bool Keyed>
+void FrameBuffer::tileNibblesToBuffer(
+	uint16_t *target,
+	const uint8_t *pixels,
+	const uint16_t *colors,
 	int32_t screen_x,
 	int32_t screen_y,
 	uint16_t tile_width,
 	uint16_t tile_height,
-	uint16_t source_x,
-	uint16_t source_y,
-	uint16_t pitch,
-	uint16_t transparent_color
-) {
-	uint16_t color = transparent_color;
-	int32_t screen_x_start = 0;
-	int32_t screen_y_start = 0;
-	uint32_t screen_index = 0;
-	uint32_t tile_index = 0;
-	Point a = { .x = 0, .y = 0 };
-	Point d = { .x = 0, .y = 0 };
-	if(screen_x < 0){
-		a.x = -screen_x;
-		d.x = tile_width;
-		screen_x_start = 0;
-	} else if (screen_x+tile_width >= WIDTH) {
-		a.x = 0;
-		d.x = WIDTH - screen_x;
-		screen_x_start = screen_x;
-	} else {
-		a.x = 0;
-		d.x = tile_width;
-		screen_x_start = screen_x;
-	}
-	if(screen_y < 0){
-		a.y = -screen_y;
-		d.y= tile_height;
-		screen_y_start = 0;
-	} else if (screen_y+tile_height >= HEIGHT) {
-		a.y = 0;
-		d.y = HEIGHT - screen_y;
-		screen_y_start = screen_y;
-	} else {
-		a.y = 0;
-		d.y = tile_height;
-		screen_y_start = screen_y;
-	}
-	uint16_t num_rows = d.y - a.y;
-	uint16_t num_cols = d.x - a.x;
-	for (uint16_t row = 0; row< num_rows; row++){
-		for(uint16_t col = 0; col < num_cols; col++) {
-			screen_index =(
-				(screen_x_start + col) + //x
-				((screen_y_start + row) * WIDTH) //y
-			);
-			tile_index = (
-				(a.y + row) + //transposed x
-				((a.x + col) * tile_width) //transposed y
-			);
-			uint8_t color_index = pixels[tile_index];
-			color = colorPalette->colors[color_index];
-			if (color != transparent_color) {
-				frame[screen_index] = color;
+	uint16_t transparent_color,
+	uint8_t flags
+)
+{
+	RenderFlagsUnion flagSplit;
+	flagSplit.i = flags;
+	bool flip_x    = flagSplit.f.horizontal;
+	bool flip_y    = flagSplit.f.vertical;
+	bool flip_diag = flagSplit.f.diagonal;
+	int32_t first_col = MAX(0, -screen_x);
+	int32_t first_row = MAX(0, -screen_y);
+	int32_t last_col = MIN((int32_t)tile_width, drawTargetWidth - screen_x);
+	int32_t last_row = MIN((int32_t)tile_height, drawTargetHeight - screen_y);
+	if (first_col >= last_col || first_row >= last_row) {
+		return;
+	}
+	int32_t num_cols = last_col - first_col;
+	//the same steps as tileToBuffer, only through pixel indexes:
+	const int32_t col_step = (flip_diag ? tile_width : 1) * (flip_x ? -1 : 1);
+	const int32_t row_step = (flip_diag ? 1 : tile_width) * (flip_y ? -1 : 1);
+	int32_t tile_x = flip_x ? tile_width - 1 - first_col : first_col;
+	int32_t tile_y = flip_y ? tile_height - 1 - first_row : first_row;
+	int32_t source_row = flip_diag
+		? tile_y + (tile_x * tile_width)
+		: tile_x + (tile_y * tile_width);
+	uint16_t *destination_row = target
+		+ ((screen_y + first_row) * drawTargetWidth)
+		+ (screen_x + first_col);
+	for (int32_t row = first_row; row < last_row; row++) {
+		int32_t source = source_row;
+		uint16_t *destination = destination_row;
+		int32_t col = 0;
+		if (!flip_diag) {
+			//both pixels of a byte come out of one read, so a row that starts
+			//on the second pixel of a byte has that one done on its own first.
+			//flipped, the low nibble comes first and the bytes go backwards:
+			if ((source & 1) != flip_x) {
+				uint16_t color = colors[EngineImage_Pixel(pixels, source, true)];
+				if (!Keyed || color != transparent_color) {
+					*destination = color;
+				}
+				destination++;
+				source += col_step;
+				col++;
+			}
+			int32_t pair = source >> 1;
+			for (; col + 1 < num_cols; col += 2) {
+				uint8_t high = pixels[pair] >> 4;
+				uint8_t low = pixels[pair] & 0x0F;
+				uint16_t first = colors[flip_x ? low : high];
+				uint16_t second = colors[flip_x ? high : low];
+				pair += col_step;
+				if (!Keyed || first != transparent_color) {
+					destination[0] = first;
+				}
+				if (!Keyed || second != transparent_color) {
+					destination[1] = second;
+				}
+				destination += 2;
+			}
+			source = (pair * 2) + flip_x;
+		} else if ((tile_width & 1) == 0) {
+			//the pixels of the row are a tile_width apart in the tile,
+			//so they're all the same nibble of every tile_width / 2th byte:
+			uint8_t shift = (source & 1) ? 0 : 4;
+			int32_t byte = source >> 1;
+			for (; col < num_cols; col++) {
+				uint16_t color = colors[(pixels[byte] >> shift) & 0x0F];
+				if (!Keyed || color != transparent_color) {
+					*destination = color;
+				}
+				destination++;
+				byte += col_step / 2;
 			}
 		}
-	}
-}
-
-void FrameBuffer::tileToBufferYesXNoYYesZ(
-	uint8_t * pixels,
-	MageColorPalette * colorPalette,
-	int32_t screen_x,
-	int32_t screen_y,
-	uint16_t tile_width,
-	uint16_t tile_height,
-	uint16_t source_x,
-	uint16_t source_y,
-	uint16_t pitch,
-	uint16_t transparent_color
-) {
-	uint16_t color = transparent_color;
-	int32_t screen_x_start = 0;
-	int32_t screen_y_start = 0;
-	uint32_t screen_index = 0;
-	uint32_t tile_index = 0;
-	Point a = { .x = 0, .y = 0 };
-	Point d = { .x = 0, .y = 0 };
-	if(screen_x < 0){
-		a.x = screen_x + tile_width;
-		d.x = 0;
-		screen_x_start = 0;
-	} else if (screen_x+tile_width >= WIDTH) {
-		a.x = tile_width;
-		d.x = (screen_x + tile_width) - WIDTH;
-		screen_x_start = screen_x;
-	} else {
-		a.x = tile_width;
-		d.x = 0;
-		screen_x_start = screen_x;
-	}
-	if(screen_y < 0){
-		a.y = -screen_y;
-		d.y= tile_height;
-		screen_y_start = 0;
-	} else if (screen_y+tile_height >= HEIGHT) {
-		a.y = 0;
-		d.y = HEIGHT - screen_y;
-		screen_y_start = screen_y;
-	} else {
-		a.y = 0;
-		d.y = tile_height;
-		screen_y_start = screen_y;
-	}
-	uint16_t num_rows = d.y - a.y;
-	uint16_t num_cols = a.x - d.x;
-	for (uint16_t row = 0; row< num_rows; row++){
-		for(uint16_t col = 0; col < num_cols; col++) {
-			screen_index =(
-				(screen_x_start + col) + //x
-				((screen_y_start + row) * WIDTH) //y
-			);
-			tile_index = (
-				(a.y + row) + //transposed x
-				((a.x - (col+1)) * tile_width) //transposed y (+1 to get back to zero-index)
-			);
-			uint8_t color_index = pixels[tile_index];
-			color = colorPalette->colors[color_index];
-			if (color != transparent_color) {
-				frame[screen_index] = color;
+		for (; col < num_cols; col++) {
+			uint16_t color = colors[EngineImage_Pixel(pixels, source, true)];
+			if (!Keyed || color != transparent_color) {
+				*destination = color;
 			}
+			destination++;
+			source += col_step;
 		}
+		source_row += row_step;
+		destination_row += drawTargetWidth;
 	}
 }
 
-void FrameBuffer::tileToBufferNoXYesYYesZ(
-	uint8_t * pixels,
-	MageColorPalette * colorPalette,
+template <bool FlipX, bool FlipY, bool Packed>
+void FrameBuffer::tileSpansToBuffer(
+	uint16_t *target,
+	const uint8_t *pixels,
+	const uint8_t *spans,
+	const uint16_t *colors,
 	int32_t screen_x,
 	int32_t screen_y,
 	uint16_t tile_width,
-	uint16_t tile_height,
-	uint16_t source_x,
-	uint16_t source_y,
-	uint16_t pitch,
-	uint16_t transparent_color
-) {
-	uint16_t color = transparent_color;
-	int32_t screen_x_start = 0;
-	int32_t screen_y_start = 0;
-	uint32_t screen_index = 0;
-	uint32_t tile_index = 0;
-	Point a = { .x = 0, .y = 0 };
-	Point d = { .x = 0, .y = 0 };
-	if(screen_x < 0){
-		a.x = -screen_x;
-		d.x = tile_width;
-		screen_x_start = 0;
-	} else if (screen_x+tile_width >= WIDTH) {
-		a.x = 0;
-		d.x = WIDTH - screen_x;
-		screen_x_start = screen_x;
-	} else {
-		a.x = 0;
-		d.x = tile_width;
-		screen_x_start = screen_x;
-	}
-	if(screen_y < 0){
-		a.y = screen_y + tile_height;
-		d.y = 0;
-		screen_y_start = 0;
-	} else if (screen_y+tile_height >= HEIGHT) {
-		a.y = tile_height;
-		d.y = (screen_y + tile_height) - HEIGHT;
-		screen_y_start = screen_y;
-	} else {
-		a.y = tile_height;
-		d.y = 0;
-		screen_y_start = screen_y;
-	}
-	uint16_t num_rows = a.y - d.y;
-	uint16_t num_cols = d.x - a.x;
-	for (uint16_t row = 0; row< num_rows; row++){
-		for(uint16_t col = 0; col < num_cols; col++) {
-			screen_index =(
-				(screen_x_start + col) + //x
-				((screen_y_start + row) * WIDTH) //y
-			);
-			tile_index = (
-				(a.y - (row+1)) + //transposed x (+1 to get back to zero-index)
-				((a.x + col) * tile_width) //transposed y
-			);
-			uint8_t color_index = pixels[tile_index];
-			color = colorPalette->colors[color_index % colorPalette->colorCount];
-			if (color != transparent_color) {
-				frame[screen_index] = color;
+	uint16_t tile_height
+)
+{
+	//the part of the tile that lands on the draw target, in screen layout:
+	int32_t first_col = MAX(0, -screen_x);
+	int32_t first_row = MAX(0, -screen_y);
+	int32_t last_col = MIN((int32_t)tile_width, drawTargetWidth - screen_x);
+	int32_t last_row = MIN((int32_t)tile_height, drawTargetHeight - screen_y);
+	if (first_col >= last_col || first_row >= last_row) {
+		return;
+	}
+	//the spans have to be walked from the top either way,
+	//FlipY only changes which screen row each of them lands on:
+	for (int32_t tile_y = 0; tile_y < tile_height; tile_y++) {
+		uint8_t run_count = *spans++;
+		int32_t row = FlipY ? tile_height - 1 - tile_y : tile_y;
+		if (row < first_row || row >= last_row) {
+			if (!FlipY && row >= last_row) {
+				return;
 			}
+			spans += run_count * 2;
+			continue;
 		}
-	}
-}
-
-void FrameBuffer::tileToBufferYesXYesYYesZ(
-	uint8_t * pixels,
-	MageColorPalette * colorPalette,
-	int32_t screen_x,
-	int32_t screen_y,
-	uint16_t tile_width,
-	uint16_t tile_height,
-	uint16_t source_x,
-	uint16_t source_y,
-	uint16_t pitch,
-	uint16_t transparent_color
-) {
-	uint16_t color = transparent_color;
-	int32_t screen_x_start = 0;
-	int32_t screen_y_start = 0;
-	uint32_t screen_index = 0;
-	uint32_t tile_index = 0;
-	Point a = { .x = 0, .y = 0 };
-	Point d = { .x = 0, .y = 0 };
-	if(screen_x < 0){
-		a.x = screen_x + tile_width;
-		d.x = 0;
-		screen_x_start = 0;
-	} else if (screen_x+tile_width >= WIDTH) {
-		a.x = tile_width;
-		d.x = (screen_x + tile_width) - WIDTH;
-		screen_x_start = screen_x;
-	} else {
-		a.x = tile_width;
-		d.x = 0;
-		screen_x_start = screen_x;
-	}
-	if(screen_y < 0){
-		a.y = screen_y + tile_height;
-		d.y = 0;
-		screen_y_start = 0;
-	} else if (screen_y+tile_height >= HEIGHT) {
-		a.y = tile_height;
-		d.y = (screen_y + tile_height) - HEIGHT;
-		screen_y_start = screen_y;
-	} else {
-		a.y = tile_height;
-		d.y = 0;
-		screen_y_start = screen_y;
-	}
-	uint16_t num_rows = a.y - d.y;
-	uint16_t num_cols = a.x - d.x;
-	for (uint16_t row = 0; row< num_rows; row++){
-		for(uint16_t col = 0; col < num_cols; col++) {
-			screen_index =(
-				(screen_x_start + col) + //x
-				((screen_y_start + row) * WIDTH) //y
-			);
-			tile_index = (
-				(a.y - (row+1)) + //transposed x (+1 to get back to zero-index)
-				((a.x - (col+1)) * tile_width) //transposed y (+1 to get back to zero-index)
-			);
-			uint8_t color_index = pixels[tile_index];
-			color = colorPalette->colors[color_index];
-			if (color != transparent_color) {
-				frame[screen_index] = color;
+		uint32_t source_row = tile_y * tile_width;
+		uint16_t *destination_row = target
+			+ ((screen_y + row) * drawTargetWidth)
+			+ screen_x;
+		for (uint8_t run = 0; run < run_count; run++) {
+			int32_t start = spans[0];
+			int32_t length = spans[1];
+			spans += 2;
+			int32_t col = FlipX ? tile_width - start - length : start;
+			int32_t end_col = MIN(col + length, last_col);
+			col = MAX(col, first_col);
+			if (FlipX) {
+				uint32_t source = source_row + (tile_width - 1 - col);
+				for (; col < end_col; col++) {
+					destination_row[col] = colors[EngineImage_Pixel(pixels, source--, Packed)];
+				}
+			} else {
+				uint32_t source = source_row + col;
+				for (; col < end_col; col++) {
+					destination_row[col] = colors[EngineImage_Pixel(pixels, source++, Packed)];
+				}
 			}
 		}
 	}
@@ -979,10 +1118,54 @@ void FrameBuffer::drawImageFromFile(int x, int y, int w, int h, const char* file
 	drawImage(x, y, w, h, buf, transparent_color);
 }
 
+//one frame of an animation file being played by drawImageFromFile or
+//drawLoopImageFromFile. it's read from the file a row at a time, and only the
+//rows in the band being drawn, so playing it takes a row of RAM and works the
+//same with or without band rendering:
+typedef struct {
+	FILE *file;
+	//where the frame starts in the file, and how many bytes of it there are:
+	uint32_t offset;
+	size_t size;
+	int x;
+	int y;
+	int w;
+	int h;
+	bool failed;
+} FrameBuffer_FileFrame;
+
+static void drawFileFrame(void *data)
+{
+	FrameBuffer_FileFrame *fileFrame = (FrameBuffer_FileFrame *)data;
+	uint16_t row[WIDTH];
+	int first = max(fileFrame->y, canvas.getBandTop());
+	int last = min(fileFrame->y + fileFrame->h, canvas.getBandBottom());
+	for (int y = first; y < last && !fileFrame->failed; ++y)
+	{
+		//a file shorter than a frame only has its first rows:
+		int32_t rowStart = (y - fileFrame->y) * fileFrame->w;
+		int32_t count = min(
+			min(fileFrame->w, WIDTH),
+			(int32_t)(fileFrame->size / sizeof(uint16_t)) - rowStart
+		);
+		if (count <= 0)
+		{
+			return;
+		}
+		fileFrame->failed = (
+			fseek(fileFrame->file, fileFrame->offset + (rowStart * sizeof(uint16_t)), SEEK_SET) != 0
+			|| fread(row, sizeof(uint16_t), count, fileFrame->file) != (size_t)count
+		);
+		if (!fileFrame->failed)
+		{
+			ROM_ENDIAN_U2_BUFFER(row, count);
+			canvas.drawImage(fileFrame->x, y, count, 1, row);
+		}
+	}
+}
+
 void FrameBuffer::drawImageFromFile(int x, int y, int w, int h, const char *filename)
 {
-	size_t bufferSize = w * h;
-	uint16_t buf[bufferSize];
 	uint32_t offset = 0;
 	m_stop = false;
 
@@ -1025,30 +1208,17 @@ void FrameBuffer::drawImageFromFile(int x, int y, int w, int h, const char *file
 
 	for (uint16_t i = 0; i < frames; i++)
 	{
-		retval = fseek(file, offset, SEEK_SET);
+		FrameBuffer_FileFrame fileFrame = { file, offset, size, x, y, w, h, false };
+		canvas.renderBands(drawFileFrame, &fileFrame);
 
-		if (retval != 0)
-		{
-			debug_print("Failed to seek the file %s\n", filename);
-			fclose(file);
-			return;
-		}
-
-		size_t read = fread(buf, sizeof(uint8_t), size, file);
-
-		if (read != size)
+		if (fileFrame.failed)
 		{
 			debug_print("Failed to read file %s\n", filename);
 			fclose(file);
 			return;
 		}
 
-		ROM_ENDIAN_U2_BUFFER(buf, bufferSize);
-		canvas.drawImage(x, y, w, h, buf);
-		canvas.blt();
-
-		uint8_t retVal = getButton(false);
-		if (retVal != USER_BUTTON_NONE || m_stop)
+		if (m_stop)
 		{
 			break;
 		}
@@ -1058,17 +1228,11 @@ void FrameBuffer::drawImageFromFile(int x, int y, int w, int h, const char *file
 	}
 
 	fclose(file);
-
-	ROM_ENDIAN_U2_BUFFER(buf, bufferSize);
-	canvas.drawImage(x, y, w, h, buf);
-	canvas.blt();
 	return;
 }
 
 void FrameBuffer::drawImageFromFile(int x, int y, int w, int h, const char *filename, void (*p_callback)(uint8_t frame, void *p_data), void *data)
 {
-	size_t bufferSize = w * h;
-	uint16_t buf[bufferSize];
 	uint32_t offset = 0;
 	m_stop = false;
 
@@ -1111,35 +1275,22 @@ void FrameBuffer::drawImageFromFile(int x, int y, int w, int h, const char *file
 
 	for (uint16_t i = 0; i < frames; i++)
 	{
-		retval = fseek(file, offset, SEEK_SET);
+		FrameBuffer_FileFrame fileFrame = { file, offset, size, x, y, w, h, false };
+		canvas.renderBands(drawFileFrame, &fileFrame);
 
-		if (retval != 0)
-		{
-			debug_print("Failed to seek the file %s\n", filename);
-			fclose(file);
-			return;
-		}
-
-		size_t read = fread(buf, sizeof(uint8_t), size, file);
-
-		if (read != size)
+		if (fileFrame.failed)
 		{
 			debug_print("Failed to read file %s\n", filename);
 			fclose(file);
 			return;
 		}
 
-		ROM_ENDIAN_U2_BUFFER(buf, bufferSize);
-		canvas.drawImage(x, y, w, h, buf);
-		canvas.blt();
-
 		if (p_callback != NULL)
 		{
 			p_callback(i, data);
 		}
 
-		uint8_t retVal = getButton(false);
-		if (retVal != USER_BUTTON_NONE || m_stop)
+		if (m_stop)
 		{
 			break;
 		}
@@ -1153,8 +1304,6 @@ void FrameBuffer::drawImageFromFile(int x, int y, int w, int h, const char *file
 
 uint8_t FrameBuffer::drawLoopImageFromFile(int x, int y, int w, int h, const char *filename)
 {
-	size_t bufferSize = w * h;
-	uint16_t buf[bufferSize];
 	uint8_t retVal = USER_BUTTON_NONE;
 	m_stop = false;
 
@@ -1216,30 +1365,17 @@ uint8_t FrameBuffer::drawLoopImageFromFile(int x, int y, int w, int h, const cha
 
 		for (uint16_t i = 0; i < frames; i++)
 		{
-			retval = fseek(file, offset, SEEK_SET);
+			FrameBuffer_FileFrame fileFrame = { file, offset, size, x, y, w, h, false };
+			canvas.renderBands(drawFileFrame, &fileFrame);
 
-			if (retval != 0)
-			{
-				debug_print("Failed to seek the file %s\n", filename);
-				fclose(file);
-				return 0;
-			}
-
-			size_t read = fread(buf, sizeof(uint8_t), size, file);
-
-			if (read != size)
+			if (fileFrame.failed)
 			{
 				debug_print("Failed to read file %s\n", filename);
 				fclose(file);
 				return 0;
 			}
 
-			ROM_ENDIAN_U2_BUFFER(buf, bufferSize);
-			canvas.drawImage(x, y, w, h, buf);
-			canvas.blt();
-
-			uint8_t retVal = getButton(false);
-			if (retVal != USER_BUTTON_NONE || m_stop)
+			if (m_stop)
 			{
 				break;
 			}
@@ -1249,8 +1385,7 @@ uint8_t FrameBuffer::drawLoopImageFromFile(int x, int y, int w, int h, const cha
 		}
 
 		//if we're looping give them a way out
-		retVal = getButton(false);
-		if (retVal != USER_BUTTON_NONE || m_stop)
+		if (m_stop)
 		{
 			break;
 		}
@@ -1271,8 +1406,6 @@ uint8_t FrameBuffer::drawLoopImageFromFile(int x, int y, int w, int h, const cha
 
 uint8_t FrameBuffer::drawLoopImageFromFile(int x, int y, int w, int h, const char *filename, void (*p_callback)(uint8_t frame, void *p_data), void *data)
 {
-	size_t bufferSize = w * h;
-	uint16_t buf[bufferSize];
 	uint8_t retVal = USER_BUTTON_NONE;
 	m_stop = false;
 
@@ -1334,35 +1467,22 @@ uint8_t FrameBuffer::drawLoopImageFromFile(int x, int y, int w, int h, const cha
 
 		for (uint16_t i = 0; i < frames; i++)
 		{
-			retval = fseek(file, offset, SEEK_SET);
-
-			if (retval != 0)
-			{
-				debug_print("Failed to seek the file %s\n", filename);
-				fclose(file);
-				return 0;
-			}
+			FrameBuffer_FileFrame fileFrame = { file, offset, size, x, y, w, h, false };
+			canvas.renderBands(drawFileFrame, &fileFrame);
 
-			size_t read = fread(buf, sizeof(uint8_t), size, file);
-
-			if (read != size)
+			if (fileFrame.failed)
 			{
 				debug_print("Failed to read file %s\n", filename);
 				fclose(file);
 				return 0;
 			}
 
-			ROM_ENDIAN_U2_BUFFER(buf, bufferSize);
-			canvas.drawImage(x, y, w, h, buf);
-			canvas.blt();
-
 			if (p_callback != NULL)
 			{
 				p_callback(i, data);
 			}
 
-			uint8_t retVal = getButton(false);
-			if (retVal != USER_BUTTON_NONE || m_stop)
+			if (m_stop)
 			{
 				break;
 			}
@@ -1372,8 +1492,7 @@ uint8_t FrameBuffer::drawLoopImageFromFile(int x, int y, int w, int h, const cha
 		}
 
 		//if we're looping give them a way out
-		retVal = getButton(false);
-		if (retVal != USER_BUTTON_NONE || m_stop)
+		if (m_stop)
 		{
 			break;
 		}
@@ -1392,6 +1511,9 @@ uint8_t FrameBuffer::drawLoopImageFromFile(int x, int y, int w, int h, const cha
 	return retVal;
 }
 
+
+//there's no getButton for the file players to check, so this is
+//the way to stop one, from its callback or another thread:
 void FrameBuffer::drawStop()
 {
 	m_stop = true;
@@ -1399,32 +1521,21 @@ void FrameBuffer::drawStop()
 
 void FrameBuffer::fillRect(int x, int y, int w, int h, uint16_t color)
 {
-	if ((x >= WIDTH) || (y >= HEIGHT))
-	{
-		debug_print("Rectangle off the screen\n");
-		return;
-	}
-
 	// Clip to screen
-	if ((x + w) > WIDTH)
+	int x1 = max(x, 0);
+	int y1 = max(y, bandTop);
+	int x2 = min(x + w, WIDTH);
+	int y2 = min(y + h, bandBottom);
+	if (x1 >= x2 || y1 >= y2)
 	{
-		w = WIDTH - x;
-	}
-
-	if ((y + h) > HEIGHT)
-	{
-		h = HEIGHT - y;
+		return;
 	}
 
-	// X
-	for (int i = x; i < (x + w); i++)
+	markDirty(x1, y1, x2, y2);
+	color = SCREEN_ENDIAN_U2_VALUE(color);
+	for (int j = y1; j < y2; j++)
 	{
-		// Y
-		for (int j = y; j < (y + h); j++)
-		{
-			int index = i + (WIDTH * j);
-			frame[index] = SCREEN_ENDIAN_U2_VALUE(color);
-		}
+		fillPixels(bandRow(j) + x1, x2 - x1, color);
 	}
 }
 
@@ -1482,6 +1593,12 @@ void FrameBuffer::drawLine(int x1, int y1, int x2, int y2, uint16_t color) {
 	int x;
 	int y;
 	float progress;
+	markDirty(
+		min(x1, x2),
+		max(min(y1, y2), bandTop),
+		max(x1, x2) + 1,
+		min(max(y1, y2) + 1, bandBottom)
+	);
 	for(uint32_t i = 0; i <= length; i++)
 	{
 		progress = ((float) i) / length;
@@ -1490,10 +1607,10 @@ void FrameBuffer::drawLine(int x1, int y1, int x2, int y2, uint16_t color) {
 		if ( // crop to screen bounds
 			x >= 0
 			&& x < WIDTH
-			&& y >= 0
-			&& y < HEIGHT
+			&& y >= bandTop
+			&& y < bandBottom
 		) {
-			frame[x + (y * WIDTH)] = SCREEN_ENDIAN_U2_VALUE(color);
+			bandRow(y)[x] = SCREEN_ENDIAN_U2_VALUE(color);
 		}
 	}
 }
@@ -1519,7 +1636,13 @@ void FrameBuffer::drawPoint(int x, int y, uint8_t size, uint16_t color) {
 void FrameBuffer::fillCircle(int x, int y, int radius, uint16_t color){
 	int rad2 = radius * radius;
 
-	for (int j = (y - radius);j <= (y + radius); ++j)
+	markDirty(
+		x - radius,
+		max(y - radius, bandTop),
+		x + radius + 1,
+		min(y + radius + 1, bandBottom)
+	);
+	for (int j = max(y - radius, bandTop); j <= min(y + radius, bandBottom - 1); ++j)
 	{
 		int yd = fabs(y - j);
 		int radx2 = rad2 - yd * yd;
@@ -1529,9 +1652,9 @@ void FrameBuffer::fillCircle(int x, int y, int radius, uint16_t color){
 			int xd = fabs(x - i);
 			int dist2 = xd * xd;
 
-			if (dist2 <= radx2)
+			if (dist2 <= radx2 && i >= 0 && i < WIDTH)
 			{
-				frame[i + j * WIDTH] = SCREEN_ENDIAN_U2_VALUE(color);
+				bandRow(j)[i] = SCREEN_ENDIAN_U2_VALUE(color);
 			}
 		}
 	}
@@ -1545,13 +1668,15 @@ void FrameBuffer::mask(int px, int py, int rad1, int rad2, int rad3)
 	int miny = py - rad3;
 	int maxy = py + rad3;
 
-	for (int y = 0; y < HEIGHT; ++y)
+	markDirty(0, bandTop, WIDTH, bandBottom);
+	for (int y = bandTop; y < bandBottom; ++y)
 	{
+		uint16_t *row = bandRow(y);
 		for (int x = 0; x < WIDTH; ++x)
 		{
 			if ((x < minx) || (x > maxx) || (y < miny) || (y > maxy))
 			{
-				frame[x + y * WIDTH] = 0;
+				row[x] = 0;
 			}
 			else
 			{
@@ -1562,15 +1687,15 @@ void FrameBuffer::mask(int px, int py, int rad1, int rad2, int rad3)
 
 				if (dist > (rad3 * rad3))
 				{
-					frame[x + y * WIDTH] = 0;
+					row[x] = 0;
 				}
 				else if (dist > (rad2 * rad2))
 				{
-					frame[x + y * WIDTH] = (frame[x + y * WIDTH] >> 2) & SCREEN_ENDIAN_U2_VALUE(0xF9E7); // ???
+					row[x] = (row[x] >> 2) & SCREEN_ENDIAN_U2_VALUE(0xF9E7); // ???
 				}
 				else if (dist > (rad1 * rad1))
 				{
-					frame[x + y * WIDTH] = (frame[x + y * WIDTH] >> 1) & SCREEN_ENDIAN_U2_VALUE(0xFBEF); // ???
+					row[x] = (row[x] >> 1) & SCREEN_ENDIAN_U2_VALUE(0xFBEF); // ???
 				}
 			}
 		}
@@ -1635,37 +1760,84 @@ static void __draw_char(
 	}
 }
 
-void FrameBuffer::write_char(uint8_t c, GFXfont font) {
+void FrameBuffer::drawGlyph(int16_t x, int16_t y, const GFXglyph *glyph, const uint8_t *spans) {
+	int32_t left = x + glyph->xOffset;
+	int32_t top = y + glyph->yOffset;
+	int32_t first_row = MAX(top, MAX((int32_t)m_cursor_area.ys, bandTop));
+	int32_t last_row = MIN(top + glyph->height, MIN((int32_t)m_cursor_area.ye + 1, bandBottom));
+	if (
+		first_row >= last_row
+		|| left >= WIDTH
+		|| left + glyph->width <= 0
+	) {
+		return;
+	}
+	markDirty(MAX(left, 0), first_row, MIN(left + glyph->width, WIDTH), last_row);
+	for (int32_t row = top; row < last_row; row++) {
+		uint8_t run_count = *spans++;
+		if (row < first_row) {
+			spans += run_count * 2;
+			continue;
+		}
+		for (uint8_t run = 0; run < run_count; run++) {
+			int32_t start = MAX(left + spans[0], 0);
+			int32_t end = MIN(left + spans[0] + spans[1], WIDTH);
+			spans += 2;
+			if (start >= end) {
+				continue;
+			}
+			//runs are only a few pixels, too short for fillPixels to pay off:
+			uint16_t *pixel = bandRow(row) + start;
+			for (int32_t col = start; col < end; col++) {
+				*pixel++ = m_color;
+			}
+		}
+	}
+}
+
+//moves the cursor past c the way printing it would, wrapping if it
+//doesn't fit. returns the glyph to draw at *x, *y, or NULL if there isn't one:
+static const GFXglyph *placeChar(uint8_t c, const GFXfont *font, int16_t *x, int16_t *y) {
 	//If newline, move down a row
 	if (c == '\n') {
 		m_cursor_x = m_cursor_area.xs;
-		m_cursor_y += font.yAdvance;
+		m_cursor_y += font->yAdvance;
+		return NULL;
 	}
-	//Otherwise, print the character (ignoring carriage return)
-	else if (c != '\r') {
-		uint8_t first = font.first;
-
-		//Valid char?
-		if ((c >= first) && (c <= font.last)) {
-			uint8_t c2 = c - first;
-			GFXglyph *glyph = &(font.glyph[c2]);
-
-			uint8_t w = glyph->width;
-			uint8_t h = glyph->height;
-
-			if ((w > 0) && (h > 0)) { // Is there an associated bitmap?
-				int16_t xo = glyph->xOffset;
-
-				if ((m_cursor_x + (xo + w)) >= m_cursor_area.xe && m_wrap) {
-					// Drawing character would go off right edge; wrap to new line
-					m_cursor_x = m_cursor_area.xs;
-					m_cursor_y += font.yAdvance;
-				}
-
-				__draw_char(m_cursor_x, m_cursor_y, c, m_color, COLOR_BLACK, font);
-			}
-			m_cursor_x += glyph->xAdvance;
+	//Otherwise, place the character (ignoring carriage return), if it's valid
+	if (c == '\r' || c < font->first || c > font->last) {
+		return NULL;
+	}
+	const GFXglyph *glyph = &(font->glyph[c - font->first]);
+	uint8_t w = glyph->width;
+	uint8_t h = glyph->height;
+	bool drawn = (w > 0) && (h > 0); // Is there an associated bitmap?
+	if (drawn) {
+		int16_t xo = glyph->xOffset;
+		if ((m_cursor_x + (xo + w)) >= m_cursor_area.xe && m_wrap) {
+			// Drawing character would go off right edge; wrap to new line
+			m_cursor_x = m_cursor_area.xs;
+			m_cursor_y += font->yAdvance;
 		}
+		*x = m_cursor_x;
+		*y = m_cursor_y;
+	}
+	m_cursor_x += glyph->xAdvance;
+	return drawn ? glyph : NULL;
+}
+
+void FrameBuffer::write_char(uint8_t c, GFXfont font) {
+	int16_t x;
+	int16_t y;
+	const GFXglyph *glyph = placeChar(c, &font, &x, &y);
+	if (glyph == NULL) {
+		return;
+	}
+	const uint8_t *spans = EngineGlyphSpans_Get(&font, c - font.first);
+	if (spans != NULL) {
+		drawGlyph(x, y, glyph, spans);
+	} else {
+		__draw_char(x, y, c, m_color, COLOR_BLACK, font);
 	}
 }
 
@@ -1676,16 +1848,58 @@ void FrameBuffer::printMessage(const char *text, GFXfont font, uint16_t color, i
 	m_cursor_x = m_cursor_area.xs;
 	m_cursor_y = y + (font.yAdvance / 2);
 
-	// this prevents crashing if the first character of the string is null
-	if(text[0] != '\0') {
-		for (uint16_t i = 0; i < strlen(text); i++)
+	for (const char *c = text; *c != '\0'; c++)
+	{
+		write_char(*c, font);
+	}
+	m_cursor_area.xs = 0;
+}
+
+void FrameBuffer::layoutMessage(const char *text, const GFXfont *font, int x, int y, FrameBuffer_TextLayout *layout)
+{
+	size_t length = strlen(text);
+	if (length > layout->glyphCapacity)
+	{
+		layout->glyphCapacity = MIN(length, UINT16_MAX);
+		layout->glyphs = std::make_unique<FrameBuffer_TextGlyph[]>(layout->glyphCapacity);
+	}
+	layout->font = font;
+	layout->glyphCount = 0;
+	m_cursor_area.xs = x;
+	m_cursor_x = m_cursor_area.xs;
+	m_cursor_y = y + (font->yAdvance / 2);
+
+	for (const char *c = text; *c != '\0' && layout->glyphCount < layout->glyphCapacity; c++)
+	{
+		FrameBuffer_TextGlyph *placed = &layout->glyphs[layout->glyphCount];
+		if (placeChar(*c, font, &placed->x, &placed->y) != NULL)
 		{
-			write_char(text[i], font);
+			placed->glyphIndex = (uint8_t)*c - font->first;
+			layout->glyphCount++;
 		}
 	}
 	m_cursor_area.xs = 0;
 }
 
+void FrameBuffer::drawLayout(const FrameBuffer_TextLayout *layout, uint16_t color)
+{
+	m_color = SCREEN_ENDIAN_U2_VALUE(color);
+	const GFXfont *font = layout->font;
+	for (uint16_t i = 0; i < layout->glyphCount; i++)
+	{
+		const FrameBuffer_TextGlyph *placed = &layout->glyphs[i];
+		const uint8_t *spans = EngineGlyphSpans_Get(font, placed->glyphIndex);
+		if (spans != NULL)
+		{
+			drawGlyph(placed->x, placed->y, &font->glyph[placed->glyphIndex], spans);
+		}
+		else
+		{
+			__draw_char(placed->x, placed->y, placed->glyphIndex + font->first, m_color, COLOR_BLACK, *font);
+		}
+	}
+}
+
 void FrameBuffer::getCursorPosition(cursor_t *cursor)
 {
 	cursor->x = m_cursor_x;
@@ -1834,12 +2048,119 @@ void draw_raw_async(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *p_ra
 	*/
 }
 
+//sends the rows of rect to the display's window of the same size, each
+//pitch pixels after the one before, without waiting for the last to finish.
+//a rect the whole width of the screen goes in one transfer:
+void draw_rect_async(const Rectangle &rect, const uint16_t *p_raw, uint16_t pitch)
+{
+	if (rect.width == pitch) {
+		draw_raw_async(rect.x, rect.y, rect.width, rect.height, (uint16_t *)p_raw);
+		return;
+	}
+	if ((rect.x < 0) || (rect.x > WIDTH - rect.width) || (rect.y < 0) || (rect.y > HEIGHT - rect.height))
+	{
+		return;
+	}
+	while(ili9341_is_busy()){
+		//wait for previous transfer to complete before starting a new one
+	}
+	ili9341_set_addr(rect.x, rect.y, rect.x + rect.width - 1, rect.y + rect.height - 1);
+	for (uint16_t row = 0; row < rect.height; row++) {
+		while(ili9341_is_busy()){
+			//the window carries on from where the row before ended
+		}
+		ili9341_push_colors((uint8_t *)(p_raw + (row * pitch)), rect.width * 2);
+	}
+}
+
+#if FRAMEBUFFER_FULL_FRAME
 void FrameBuffer::blt()
+{
+	Rectangle rects[FRAMEBUFFER_DIRTY_RECT_COUNT];
+	uint8_t rectCount = takeDirtyRects(frame, 0, HEIGHT, rects);
+	#ifdef DC801_DESKTOP
+		EngineWindowFrameGameBlt(frame, rects, rectCount);
+	#endif
+	#ifdef DC801_EMBEDDED
+		//there's only room for the one frame, so nothing can be queued behind it
+		waitForPresent();
+		for (uint8_t index = 0; index < rectCount; index++) {
+			const Rectangle &rect = rects[index];
+			draw_rect_async(rect, frame + (rect.y * WIDTH) + rect.x, WIDTH);
+			presentStats.pixelsTransferred += rect.width * rect.height;
+		}
+		presentStats.rectsTransferred += rectCount;
+		presentStats.framesQueued++;
+		presentStats.framesPresented++;
+	#endif
+}
+#endif //FRAMEBUFFER_FULL_FRAME
+
+void FrameBuffer::waitForPresent()
+{
+	#ifdef DC801_EMBEDDED
+	if (!ili9341_is_busy()) {
+		return;
+	}
+	uint32_t start = micros();
+	while (ili9341_is_busy()) {
+		//wait for the DMA to finish reading the frame or band
+	}
+	uint32_t waited = micros() - start;
+	presentStats.waitMicroseconds += waited;
+	presentStats.maxWaitMicroseconds = MAX(presentStats.maxWaitMicroseconds, waited);
+	#endif
+}
+
+const FrameBuffer_PresentStats *FrameBuffer::getPresentStats()
 {
 	#ifdef DC801_DESKTOP
-		EngineWindowFrameGameBlt(frame);
+	//the window frame's, and what only this knows:
+	static FrameBuffer_PresentStats stats;
+	stats = *EngineWindowFrameGetPresentStats();
+	stats.pixelsRefreshed = pixelsRefreshed;
+	return &stats;
 	#endif
 	#ifdef DC801_EMBEDDED
-		draw_raw_async(0, 0, WIDTH, HEIGHT, frame);
+	presentStats.pixelsRefreshed = pixelsRefreshed;
+	return &presentStats;
 	#endif
 }
+
+void FrameBuffer::resetPresentStats()
+{
+	#ifdef DC801_DESKTOP
+	EngineWindowFrameResetPresentStats();
+	#endif
+	#ifdef DC801_EMBEDDED
+	presentStats = {};
+	#endif
+	pixelsRefreshed = 0;
+}
+
+uint32_t FrameBuffer::size()
+{
+	uint32_t size = sizeof(bandBuffers);
+	#if FRAMEBUFFER_FULL_FRAME
+	size += sizeof(frame);
+	#endif //FRAMEBUFFER_FULL_FRAME
+	return size;
+}
+
+void FrameBuffer::logPresentStats(const char *label)
+{
+	const FrameBuffer_PresentStats *stats = getPresentStats();
+	debug_print(
+		"Present (%s): %u queued, %u presented, %u dropped, wait %uus avg %uus max, present %uus avg, %u pixels %u rects %u refreshed avg",
+		label,
+		stats->framesQueued,
+		stats->framesPresented,
+		stats->framesDropped,
+		stats->framesQueued ? stats->waitMicroseconds / stats->framesQueued : 0,
+		stats->maxWaitMicroseconds,
+		stats->framesPresented ? stats->presentMicroseconds / stats->framesPresented : 0,
+		stats->framesPresented ? stats->pixelsTransferred / stats->framesPresented : 0,
+		stats->framesPresented ? stats->rectsTransferred / stats->framesPresented : 0,
+		stats->framesPresented ? stats->pixelsRefreshed / stats->framesPresented : 0
+	);
+}
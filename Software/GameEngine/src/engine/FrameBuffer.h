@@ -3,7 +3,11 @@
 
 #ifdef __cplusplus
 #include <cstdint>
+#include <memory>
 #include "games/mage/mage_color_palette.h"
+#include "EngineTileCache.h"
+#include "EngineTileSpans.h"
+#include "EngineGlyphSpans.h"
 
 #endif
 
@@ -16,6 +20,47 @@
 #define HALF_HEIGHT	120
 const uint32_t FRAMEBUFFER_SIZE = HEIGHT * WIDTH;
 
+//with band rendering, the frame is drawn and sent to the screen this many
+//rows at a time, so only two bands have to be in RAM instead of all of it:
+#define FRAMEBUFFER_BAND_HEIGHT 40
+#define FRAMEBUFFER_BAND_COUNT (HEIGHT / FRAMEBUFFER_BAND_HEIGHT)
+const uint32_t FRAMEBUFFER_BAND_SIZE = FRAMEBUFFER_BAND_HEIGHT * WIDTH;
+#if HEIGHT % FRAMEBUFFER_BAND_HEIGHT != 0
+#error "FRAMEBUFFER_BAND_HEIGHT has to divide HEIGHT"
+#endif
+
+//the badge doesn't have room for a whole frame next to everything else,
+//so it only ever has the two bands. the tests draw straight into a whole
+//frame and blt it, and so does the desktop window.
+#ifndef FRAMEBUFFER_FULL_FRAME
+#if defined(DC801_EMBEDDED) && !defined(TEST) && !defined(TEST_ALL)
+#define FRAMEBUFFER_FULL_FRAME 0
+#else
+#define FRAMEBUFFER_FULL_FRAME 1
+#endif
+#endif //FRAMEBUFFER_FULL_FRAME
+#if !FRAMEBUFFER_FULL_FRAME && defined(DC801_DESKTOP)
+#error "the desktop window is drawn from the whole frame"
+#endif
+
+//whether renderBands starts out drawing a band at a time. without a whole
+//frame there's no other way, with one it's only worth it to check the bands
+//against the whole frame, see FrameBuffer::setBandRendering:
+#ifndef FRAMEBUFFER_BAND_RENDERING
+#define FRAMEBUFFER_BAND_RENDERING (!FRAMEBUFFER_FULL_FRAME)
+#endif //FRAMEBUFFER_BAND_RENDERING
+
+//only what changed since the last frame gets sent to the screen, as up to
+//this many rectangles. any more than that are merged into the last one:
+#define FRAMEBUFFER_DIRTY_RECT_COUNT 8
+//rows sent again every frame whether they changed or not, a few at a time
+//down the screen, so nothing a row hash missed stays on it for longer than
+//HEIGHT / FRAMEBUFFER_REFRESH_ROWS frames:
+#define FRAMEBUFFER_REFRESH_ROWS 4
+#if HEIGHT % FRAMEBUFFER_REFRESH_ROWS != 0
+#error "FRAMEBUFFER_REFRESH_ROWS has to divide HEIGHT"
+#endif
+
 #define FLIPPED_DIAGONALLY_FLAG   0x01
 #define FLIPPED_VERTICALLY_FLAG   0x02
 #define FLIPPED_HORIZONTALLY_FLAG 0x04
@@ -100,6 +145,25 @@ typedef struct {
 	int16_t y;
 } cursor_t;
 
+//a glyph placed by FrameBuffer::layoutMessage, with the cursor position
+//it's drawn at and its index in the font (the character minus font->first):
+typedef struct {
+	int16_t x;
+	int16_t y;
+	uint8_t glyphIndex;
+} FrameBuffer_TextGlyph;
+
+//a string laid out once, line breaks and all, so it can be drawn every
+//frame without working out where each character goes again:
+typedef struct {
+	const GFXfont *font;
+	uint16_t glyphCount;
+	//laying out a shorter string reuses the glyphs, only a longer one
+	//than has been laid out before allocates:
+	uint16_t glyphCapacity;
+	std::unique_ptr<FrameBuffer_TextGlyph[]> glyphs;
+} FrameBuffer_TextLayout;
+
 //this is a point in 2D space.
 typedef struct {
 	int32_t x;
@@ -132,104 +196,142 @@ public:
 		height{height} {}
 };
 
+//how the frames handed to FrameBuffer::blt made it to the screen:
+typedef struct {
+	uint32_t framesQueued;
+	uint32_t framesPresented;
+	//replaced by a newer frame before they could be presented:
+	uint32_t framesDropped;
+	//how long blt held the game up, all together and at worst:
+	uint32_t waitMicroseconds;
+	uint32_t maxWaitMicroseconds;
+	//how long presenting took, all together. desktop only,
+	//the badge's display DMA doesn't tell anyone when it's done:
+	uint32_t presentMicroseconds;
+	//pixels sent to the screen, all together, and how many rectangles
+	//they went in. a frame that didn't change sends nothing:
+	uint32_t pixelsTransferred;
+	uint32_t rectsTransferred;
+	//of those, the ones sent again only because their rows were due,
+	//see FRAMEBUFFER_REFRESH_ROWS:
+	uint32_t pixelsRefreshed;
+} FrameBuffer_PresentStats;
+
+//where the time went in the frames renderBands drew a band at a time,
+//all frames together. a band's wait is how long it took the display to be
+//ready for it after it was drawn.
+typedef struct {
+	uint32_t frames;
+	uint32_t drawMicroseconds[FRAMEBUFFER_BAND_COUNT];
+	uint32_t waitMicroseconds[FRAMEBUFFER_BAND_COUNT];
+} FrameBuffer_BandStats;
+
 #ifdef __cplusplus
 class FrameBuffer {
 private:
-	void tileToBufferNoXNoYNoZ(
-		uint8_t * pixels,
-		MageColorPalette * colorPalette,
-		int32_t screen_x,
-		int32_t screen_y,
-		uint16_t tile_width,
-		uint16_t tile_height,
-		uint16_t source_x,
-		uint16_t source_y,
-		uint16_t pitch,
-		uint16_t transparent_color
-	);
-	void tileToBufferYesXNoYNoZ(
-		uint8_t * pixels,
-		MageColorPalette * colorPalette,
-		int32_t screen_x,
-		int32_t screen_y,
-		uint16_t tile_width,
-		uint16_t tile_height,
-		uint16_t source_x,
-		uint16_t source_y,
-		uint16_t pitch,
-		uint16_t transparent_color
-	);
-	void tileToBufferNoXYesYNoZ(
-		uint8_t * pixels,
-		MageColorPalette * colorPalette,
-		int32_t screen_x,
-		int32_t screen_y,
-		uint16_t tile_width,
-		uint16_t tile_height,
-		uint16_t source_x,
-		uint16_t source_y,
-		uint16_t pitch,
-		uint16_t transparent_color
+	//the rows of the screen being drawn right now, bandTop up to bandBottom,
+	//and where they go. unless renderBands is drawing a band, that is the
+	//whole screen, straight into the frame.
+	//everything drawn is clipped to these rows.
+	uint16_t *bandPixels;
+	int32_t bandTop;
+	int32_t bandBottom;
+	bool bandRendering;
+	//how many times renderBands has been called:
+	uint32_t frameCount;
+
+	//where drawChunkWithFlags draws to, normally the band itself.
+	//drawTargetTop is the screen row that the first row of it is:
+	uint16_t *drawTarget;
+	int32_t drawTargetWidth;
+	int32_t drawTargetHeight;
+	int32_t drawTargetTop;
+
+	void setBand(uint16_t *pixels, int32_t top, int32_t bottom);
+	//every primitive marks the screen pixels it draws to, x1 up to x2 and
+	//y1 up to y2. anything off the screen is left out:
+	void markDirty(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+	//the rows top up to bottom that were drawn to since they were last
+	//sent, and aren't what was sent last time, as rectangles to send.
+	//pixels is those rows. returns how many rectangles there are:
+	uint8_t takeDirtyRects(
+		const uint16_t *pixels,
+		int32_t top,
+		int32_t bottom,
+		Rectangle *rects
 	);
-	void tileToBufferYesXYesYNoZ(
-		uint8_t * pixels,
-		MageColorPalette * colorPalette,
+	void resetBand();
+	//the pixels of screen row y, which has to be in the band:
+	uint16_t *bandRow(int32_t y) { return bandPixels + ((y - bandTop) * WIDTH); }
+	void presentBand(const uint16_t *pixels, int32_t top);
+
+	//fills the runs of a glyph's spans (see EngineGlyphSpans.h) in the text
+	//color, with x and y being the cursor the glyph is drawn at. only the rows
+	//of the text area are drawn, clipped to the band:
+	void drawGlyph(int16_t x, int16_t y, const GFXglyph *glyph, const uint8_t *spans);
+
+	//draws one tile of palette indexes, with the flips and the transparency
+	//check decided at compile time, so none of them cost anything per pixel.
+	//the tile is clipped to the draw target once, before any pixel is drawn.
+	//colors turns the tile's palette indexes into screen endian 565 colors,
+	//and transparent_color is one too, ignored unless Keyed.
+	template <bool FlipX, bool FlipY, bool FlipDiagonal, bool Keyed>
+	void tileToBuffer(
+		uint16_t *target,
+		const uint8_t *pixels,
+		const uint16_t *colors,
 		int32_t screen_x,
 		int32_t screen_y,
 		uint16_t tile_width,
 		uint16_t tile_height,
-		uint16_t source_x,
-		uint16_t source_y,
-		uint16_t pitch,
 		uint16_t transparent_color
 	);
-	void tileToBufferNoXNoYYesZ(
-		uint8_t * pixels,
-		MageColorPalette * colorPalette,
+	//the same for a tile packed two pixels to a byte (see EngineImage.h).
+	//the flips are only worked out at run time, there are fewer of these:
+	template <bool Keyed>
+	void tileNibblesToBuffer(
+		uint16_t *target,
+		const uint8_t *pixels,
+		const uint16_t *colors,
 		int32_t screen_x,
 		int32_t screen_y,
 		uint16_t tile_width,
 		uint16_t tile_height,
-		uint16_t source_x,
-		uint16_t source_y,
-		uint16_t pitch,
-		uint16_t transparent_color
+		uint16_t transparent_color,
+		uint8_t flags
 	);
-	void tileToBufferYesXNoYYesZ(
-		uint8_t * pixels,
-		MageColorPalette * colorPalette,
+	//draws only the runs listed in a tile's spans (see EngineTileSpans.h),
+	//nothing else has to be looked at. the spans have no diagonal flip.
+	template <bool FlipX, bool FlipY, bool Packed>
+	void tileSpansToBuffer(
+		uint16_t *target,
+		const uint8_t *pixels,
+		const uint8_t *spans,
+		const uint16_t *colors,
 		int32_t screen_x,
 		int32_t screen_y,
 		uint16_t tile_width,
-		uint16_t tile_height,
-		uint16_t source_x,
-		uint16_t source_y,
-		uint16_t pitch,
-		uint16_t transparent_color
+		uint16_t tile_height
 	);
-	void tileToBufferNoXYesYYesZ(
-		uint8_t * pixels,
-		MageColorPalette * colorPalette,
+	//picks the tile blitter for the flags and draws the tile with it:
+	void blitTile(
+		uint16_t *target,
+		const uint8_t *pixels,
+		bool packed,
+		const uint8_t *spans,
+		const uint16_t *colors,
 		int32_t screen_x,
 		int32_t screen_y,
 		uint16_t tile_width,
 		uint16_t tile_height,
-		uint16_t source_x,
-		uint16_t source_y,
-		uint16_t pitch,
-		uint16_t transparent_color
+		bool keyed,
+		uint16_t transparent_color,
+		uint8_t flags
 	);
-	void tileToBufferYesXYesYYesZ(
-		uint8_t * pixels,
-		MageColorPalette * colorPalette,
+	void tileToBufferCached(
+		const EngineTileCache_Tile *tile,
 		int32_t screen_x,
-		int32_t screen_y,
-		uint16_t tile_width,
-		uint16_t tile_height,
-		uint16_t source_x,
-		uint16_t source_y,
-		uint16_t pitch,
-		uint16_t transparent_color
+		int32_t screen_y
 	);
 public:
 	//variables used for screen fading
@@ -243,6 +345,34 @@ public:
 
 	void clearScreen(uint16_t color);
 
+	//draws the screen with draw and shows it.
+	//with band rendering, draw is called once for every band, top to bottom,
+	//with everything it draws clipped to the band, and each band is sent to
+	//the screen as soon as it's done. so draw has to draw the same thing every
+	//time it's called, and draw all of it, the rows above the band are gone.
+	//without band rendering, it's draw then blt.
+	void renderBands(void (*draw)(void *data), void *data);
+	//how many times renderBands has been called, this one included. the
+	//game draws everything through it, so one more than it was in the last
+	//frame drawn means nothing else has been drawn into the frame since:
+	uint32_t getFrameCount();
+	//only does anything with a whole frame to fall back on:
+	void setBandRendering(bool enabled);
+	bool getBandRendering();
+	//the rows being drawn right now, so draw functions can skip what's
+	//not in the band. bottom is the first row past it:
+	int32_t getBandTop();
+	int32_t getBandBottom();
+	const FrameBuffer_BandStats *getBandStats();
+	void resetBandStats();
+	void logBandStats(const char *label);
+
+	//makes drawChunkWithFlags draw into some other buffer of 565 colors,
+	//width * height of them, until resetDrawTarget is called.
+	//nothing else draws anywhere but the band.
+	void setDrawTarget(uint16_t *buffer, int32_t width, int32_t height);
+	void resetDrawTarget();
+
 	void drawPixel(int x, int y, uint16_t color);
 
 	static float lerp(float a, float b, float progress);
@@ -259,6 +389,14 @@ public:
 	void drawImage(int x, int y, int w, int h, const uint8_t *data);
 	void drawImage(int x, int y, int w, int h, const uint8_t *data, uint16_t transparent_color);
 	void drawImage(int x, int y, int w, int h, const uint16_t *data, int fx, int fy, int pitch);
+	//works out the runs of a w * h image of 565 colors that aren't
+	//transparent_color (screen endian), row by row from the top: how many runs
+	//the row has, then the start column and length of each, left to right.
+	//writes them to spans, or only counts them if spans is NULL.
+	//returns how many uint16_t they take:
+	static uint32_t buildImageSpans(const uint16_t *data, int w, int h, uint16_t transparent_color, uint16_t *spans);
+	//draws only the runs of a w * h image that its spans say aren't transparent:
+	void drawImageSpans(int x, int y, int w, int h, const uint16_t *data, const uint16_t *spans);
 	void drawImage(int x, int y, int w, int h, const uint16_t *data, int fx, int fy, int pitch, uint16_t transparent_color);
 
 	void drawImageWithFlags(
@@ -285,12 +423,15 @@ public:
 		uint16_t source_y, //coordinates in source image
 		uint16_t pitch, //width of source image
 		uint16_t transparent_color, //565 encoded color value
-		uint8_t flags //render flags
+		uint8_t flags, //render flags
+		const uint8_t *spans = NULL //EngineTileSpans of the tile, if it has them
 	);
 
 	void drawImageFromFile(int x, int y, int w, int h, const char* filename, int fx, int fy, int pitch);
 	void drawImageFromFile(int x, int y, int w, int h, const char* filename, int fx, int fy, int pitch, uint16_t transparent_color);
 
+	//these play every frame of the file straight to the screen, each one
+	//through renderBands, so they work a band at a time too:
 	void drawImageFromFile(int x, int y, int w, int h, const char *filename);
 	void drawImageFromFile(int x, int y, int w, int h, const char *filename, void (*p_callback)(uint8_t frame, void *p_data), void *data);
 	uint8_t drawLoopImageFromFile(int x, int y, int w, int h, const char *filename);
@@ -310,6 +451,10 @@ public:
 	void mask(int px, int py, int rad1, int rad2, int rad3);
 	void write_char(uint8_t c, GFXfont font);
 	void printMessage(const char *text, GFXfont font, uint16_t color, int x, int y);
+	//works out where printMessage would draw each character of text,
+	//wrapping the same way, so drawLayout can draw it again and again:
+	void layoutMessage(const char *text, const GFXfont *font, int x, int y, FrameBuffer_TextLayout *layout);
+	void drawLayout(const FrameBuffer_TextLayout *layout, uint16_t color);
 
 	void setTextArea(area_t *area);
 	void getTextBounds(GFXfont font, const char *text, int16_t x, int16_t y, bounds_t *bounds);
@@ -318,7 +463,24 @@ public:
 	uint8_t getFontWidth(GFXfont font);
 	void getCursorPosition(cursor_t *cursor);
 
+	#if FRAMEBUFFER_FULL_FRAME
+	//hands the frame over to be shown, without waiting for it to get there.
+	//on desktop it gets copied into the present queue, so the frame can be
+	//drawn into again right away. on the badge the display DMA reads it
+	//straight out of the frame, so call waitForPresent before drawing again.
 	void blt();
+	#endif //FRAMEBUFFER_FULL_FRAME
+	//waits until the display is done reading the last frame or band sent.
+	//nothing to wait for on desktop:
+	void waitForPresent();
+	const FrameBuffer_PresentStats *getPresentStats();
+	void resetPresentStats();
+	void logPresentStats(const char *label);
+	//forgets what was sent to the screen, so the next frame is sent whole:
+	void invalidateScreen();
+
+	//the frame, if there is one, and the bands:
+	uint32_t size();
 
 };
 
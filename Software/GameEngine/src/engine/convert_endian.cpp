@@ -1,6 +1,15 @@
 #include "common.h"
 #include "convert_endian.h"
 
+//u2 buffers are swapped 8 values at a time where the desktop CPU can:
+#ifdef DC801_DESKTOP
+	#if defined(__SSE2__)
+		#include <emmintrin.h>
+	#elif defined(__ARM_NEON)
+		#include <arm_neon.h>
+	#endif
+#endif
+
 #ifdef IS_BIG_ENDIAN
 const char endian_label[] = "Big Endian";
 #else
@@ -14,9 +23,30 @@ uint16_t convert_endian_u2_value (uint16_t value)
 
 void convert_endian_u2_buffer (uint16_t *buf, size_t bufferSize)
 {
-	for (size_t i = 0; i < bufferSize; i++)
+	convert_endian_u2_copy(buf, buf, bufferSize);
+}
+
+void convert_endian_u2_copy (uint16_t *destination, const uint16_t *source, size_t count)
+{
+	size_t i = 0;
+	//each vector is loaded before it's stored, so it works in place too:
+	#if defined(DC801_DESKTOP) && defined(__SSE2__)
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i values = _mm_loadu_si128((const __m128i *)(source + i));
+		values = _mm_or_si128(_mm_slli_epi16(values, 8), _mm_srli_epi16(values, 8));
+		_mm_storeu_si128((__m128i *)(destination + i), values);
+	}
+	#elif defined(DC801_DESKTOP) && defined(__ARM_NEON)
+	for (; i + 8 <= count; i += 8)
+	{
+		uint8x16_t values = vld1q_u8((const uint8_t *)(source + i));
+		vst1q_u8((uint8_t *)(destination + i), vrev16q_u8(values));
+	}
+	#endif
+	for (; i < count; i++)
 	{
-		buf[i] = __builtin_bswap16(buf[i]);
+		destination[i] = __builtin_bswap16(source[i]);
 	}
 }
 
@@ -52,6 +52,8 @@ extern const char endian_label[];
 
 uint16_t convert_endian_u2_value (uint16_t value);
 void convert_endian_u2_buffer (uint16_t *buf, size_t bufferSize);
+//swaps count values from source into destination, which can be the same:
+void convert_endian_u2_copy (uint16_t *destination, const uint16_t *source, size_t count);
 
 uint32_t convert_endian_u4_value (uint32_t value);
 void convert_endian_u4_buffer (uint32_t *buf, size_t bufferSize);
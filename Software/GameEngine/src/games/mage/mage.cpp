@@ -4,6 +4,8 @@
 #include "mage_defines.h"
 
 #include "EngineROM.h"
+#include "EngineSaveLog.h"
+#include "EngineTileCache.h"
 #include "EnginePanic.h"
 
 //uncomment to print main game loop timing debug info to terminal or over serial
@@ -113,7 +115,7 @@ void GameUpdate(uint32_t deltaTime)
 	}
 }
 
-void GameRender()
+void GameDraw(void *data)
 {
 	#ifdef TIMING_DEBUG
 	uint32_t now = millis();
@@ -122,13 +124,8 @@ void GameRender()
 	//make hax do
 	if (MageHex->getHexEditorState())
 	{
-		//run hex editor if appropriate
-		mage_canvas->clearScreen(RGB(0,0,0));
-		#ifdef TIMING_DEBUG
-			diff = millis() - now;
-			debug_print("screen clear time: %d",diff);
-			now = millis();
-		#endif
+		//run hex editor if appropriate, it clears the screen itself
+		//when it can't draw only what changed since the last frame:
 		MageHex->renderHexEditor();
 		#ifdef TIMING_DEBUG
 			diff = millis() - now;
@@ -141,42 +138,54 @@ void GameRender()
 	{
 		//otherwise run mage game:
 		uint16_t backgroundColor = RGB(0,0,0);
-		mage_canvas->clearScreen(mage_canvas->applyFadeColor(backgroundColor));
-		#ifdef TIMING_DEBUG
-			diff = millis() - now;
-			debug_print("screen clear time: %d",diff);
-			now = millis();
-		#endif
-
-		//then draw the map and entities:
 		uint8_t layerCount = MageGame->Map().LayerCount();
 
-		if (layerCount > 1)
+		//the layers under the entities come from the layer cache when it can be used:
+		if (MageGame->DrawLayerCache(mage_canvas->applyFadeColor(backgroundColor)))
 		{
-			for (
-				uint8_t layerIndex = 0;
-				layerIndex < (layerCount - 1);
-				layerIndex++
-			)
-			{
-				//draw all map layers except the last one before drawing entities.
-				MageGame->DrawMap(layerIndex);
-				#ifdef TIMING_DEBUG
-					diff = millis() - now;
-					debug_print("Layer Time: %d",diff);
-					now = millis();
-				#endif
-			}
+			#ifdef TIMING_DEBUG
+				diff = millis() - now;
+				debug_print("Layer Cache Time: %d",diff);
+				now = millis();
+			#endif
 		}
 		else
 		{
-			//if there is only one map layer, it will always be drawn before the entities.
-			MageGame->DrawMap(0);
+			mage_canvas->clearScreen(mage_canvas->applyFadeColor(backgroundColor));
 			#ifdef TIMING_DEBUG
 				diff = millis() - now;
-				debug_print("Layer Time: %d",diff);
+				debug_print("screen clear time: %d",diff);
 				now = millis();
 			#endif
+
+			//then draw the map and entities:
+			if (layerCount > 1)
+			{
+				for (
+					uint8_t layerIndex = 0;
+					layerIndex < (layerCount - 1);
+					layerIndex++
+				)
+				{
+					//draw all map layers except the last one before drawing entities.
+					MageGame->DrawMap(layerIndex);
+					#ifdef TIMING_DEBUG
+						diff = millis() - now;
+						debug_print("Layer Time: %d",diff);
+						now = millis();
+					#endif
+				}
+			}
+			else
+			{
+				//if there is only one map layer, it will always be drawn before the entities.
+				MageGame->DrawMap(0);
+				#ifdef TIMING_DEBUG
+					diff = millis() - now;
+					debug_print("Layer Time: %d",diff);
+					now = millis();
+				#endif
+			}
 		}
 
 		//now that the entities are updated, draw them to the screen.
@@ -218,14 +227,21 @@ void GameRender()
 			#endif
 		}
 	}
+}
+
+void GameRender()
+{
 	//update the state of the LEDs
 	MageHex->updateHexLights();
 
-	//update the screen
-	mage_canvas->blt();
 	#ifdef TIMING_DEBUG
-		diff = millis() - now;
-		debug_print("blt time: %d",diff);
+	uint32_t now = millis();
+	#endif
+	//draw and update the screen, which waits for the last frame if it is
+	//still on its way there:
+	mage_canvas->renderBands(GameDraw, NULL);
+	#ifdef TIMING_DEBUG
+		debug_print("render and blt time: %d", millis() - now);
 	#endif
 }
 
@@ -252,6 +268,9 @@ void EngineMainGameLoop ()
 	//handles hardware inputs and makes their state available
 	EngineHandleInput();
 
+	//moves any save in progress along a bit, without holding up the frame
+	EngineSaveLog_Step();
+
 	LOG_COLOR_PALETTE_CORRUPTION(
 		"EngineHandleInput();"
 	);
@@ -286,6 +305,11 @@ void EngineMainGameLoop ()
 	) {
 		MageColorPalette *colorPalette = MageGame->getValidColorPalette(0);
 		colorPalette->colors[0] = 0xDEAD;
+		colorPalette->updateOpaque();
+		colorPalette->fadedPalette.reset();
+		//or the tiles already drawn with the good palette would hide it
+		EngineTileCache_Invalidate();
+		MageGame->invalidateLayerCache();
 	}
 	#endif //DC801_DESKTOP
 
@@ -322,6 +346,7 @@ void EngineInit () {
 
 	// Initialize ROM and reload game.dat if a different version is on the SD card.
 	EngineROM_Init();
+	EngineSaveLog_Init();
 
 	// Construct MageGameControl object, loading all headers
 	MageGame = std::make_unique<MageGameControl>();
@@ -357,10 +382,10 @@ void EngineInit () {
 		fprintf(stderr, "MageGameControl RAM use:   %8d bytes.\r\n", MageGame->Size());
 		fprintf(stderr, "MageScriptControl RAM use: %8d bytes.\r\n", MageScript->size());
 		fprintf(stderr, "MageHexControl RAM use:    %8d bytes.\r\n", MageHex->size());
-		fprintf(stderr, "FrameBuffer RAM use:       %8d bytes.\r\n", FRAMEBUFFER_SIZE * sizeof(uint16_t));
+		fprintf(stderr, "FrameBuffer RAM use:       %8d bytes.\r\n", mage_canvas->size());
 		fprintf(stderr, "-------------------------------------------\r\n");
 		fprintf(stderr, "Minimum RAM overhead use:  %8d bytes.\r\n",
-			(MageGame->Size() + MageScript->size() + MageHex->size() + (FRAMEBUFFER_SIZE * sizeof(uint16_t))));
+			(MageGame->Size() + MageScript->size() + MageHex->size() + mage_canvas->size()));
 	#endif
 	#ifdef DC801_EMBEDDED
 		check_ram_usage();
@@ -397,6 +422,9 @@ void MAGE()
 	}
 	#endif
 
+	// Finish any save still being written
+	EngineSaveLog_Deinit();
+
 	// Close rom and any open files
 	EngineROM_Deinit();
 
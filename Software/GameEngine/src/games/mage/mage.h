@@ -14,6 +14,10 @@ void handleScripts();
 //updates the state of all the things before rendering:
 void GameUpdate();
 
+//draws everything GameRender shows, without showing it.
+//with band rendering it's called once for every band, see FrameBuffer::renderBands.
+void GameDraw(void *data);
+
 //This renders the game to the screen based on the loop's updated state.
 void GameRender();
 
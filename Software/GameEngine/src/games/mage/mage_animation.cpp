@@ -50,11 +50,10 @@ MageAnimationFrame MageAnimation::AnimationFrame(uint32_t index) const
 	index = index < frameCount
 		? index
 		: frameCount;
-	EngineROM_Read(
-		offset + (index * sizeof(frame)),
-		sizeof(frame),
-		(uint8_t *)&frame,
-		"Failed to read AnimationFrame"
+	memcpy(
+		&frame,
+		EngineROM_View(offset + (index * sizeof(frame)), sizeof(frame)),
+		sizeof(frame)
 	);
 	frame.tileId = ROM_ENDIAN_U2_VALUE(frame.tileId);
 	frame.duration = ROM_ENDIAN_U2_VALUE(frame.duration);
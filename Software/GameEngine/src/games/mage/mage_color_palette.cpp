@@ -30,7 +30,22 @@ MageColorPalette::MageColorPalette(uint32_t address)
 		"Failed to read ColorPalette.colorCount"
 	);
 	address += sizeof(colorCount);
-	address += 1; // padding
+
+	// Read imageFormat, which used to be padding, so older
+	// game.dat files have their images one byte per pixel
+	EngineROM_Read(
+		address,
+		sizeof(imageFormat),
+		(uint8_t *)&imageFormat,
+		"Failed to read ColorPalette.imageFormat"
+	);
+	address += sizeof(imageFormat);
+	if (
+		imageFormat > ENGINE_IMAGE_FORMAT_4BPP
+		|| (imageFormat == ENGINE_IMAGE_FORMAT_4BPP && colorCount > 16)
+	) {
+		ENGINE_PANIC("Invalid ColorPalette.imageFormat");
+	}
 
 	// Construct array
 	colors = std::make_unique<uint16_t[]>(colorCount);
@@ -42,6 +57,7 @@ MageColorPalette::MageColorPalette(uint32_t address)
 		(uint8_t *)colors.get(),
 		"Failed to read ColorPalette.colors"
 	);
+	updateOpaque();
 
 	#ifdef DC801_DESKTOP
 	generatePaletteIntegrityString(colorIntegrityString);
@@ -57,20 +73,83 @@ uint32_t MageColorPalette::size() const
 {
 	uint32_t size = (
 		sizeof(colorCount) +
-		(colorCount * sizeof(uint16_t))
+		(colorCount * sizeof(uint16_t)) +
+		(fadedPalette ? fadedPalette->size() : 0)
 	);
 	return size;
 }
 
+bool MageColorPalette::packed() const
+{
+	return imageFormat == ENGINE_IMAGE_FORMAT_4BPP;
+}
+
+void MageColorPalette::updateOpaque()
+{
+	opaque = true;
+	for (int i = 0; i < colorCount; ++i) {
+		if (colors[i] == SCREEN_ENDIAN_U2_VALUE(TRANSPARENCY_COLOR)) {
+			opaque = false;
+		}
+	}
+}
+
+MageColorPalette *MageColorPalette::getFadedPalette(
+	uint16_t transparentColor,
+	uint16_t fadeColor,
+	float fadeFraction
+) {
+	if (!fadedPalette) {
+		fadedPalette = std::make_unique<MageColorPalette>(
+			this,
+			transparentColor,
+			fadeColor,
+			fadeFraction
+		);
+	} else if (
+		fadedTransparentColor != transparentColor
+		|| fadedColor != fadeColor
+		|| fadedFraction != fadeFraction
+	) {
+		fadedPalette->fadeColors(
+			this,
+			transparentColor,
+			fadeColor,
+			fadeFraction
+		);
+	} else {
+		return fadedPalette.get();
+	}
+	fadedTransparentColor = transparentColor;
+	fadedColor = fadeColor;
+	fadedFraction = fadeFraction;
+	return fadedPalette.get();
+}
+
 MageColorPalette::MageColorPalette(
 	MageColorPalette *sourcePalette,
 	uint16_t transparentColor,
 	uint16_t fadeColor,
 	float fadeFraction
 ) {
-	uint16_t sourceColor;
 	colorCount = sourcePalette->colorCount;
+	imageFormat = sourcePalette->imageFormat;
 	colors = std::make_unique<uint16_t[]>(colorCount);
+	fadeColors(
+		sourcePalette,
+		transparentColor,
+		fadeColor,
+		fadeFraction
+	);
+}
+
+void MageColorPalette::fadeColors(
+	MageColorPalette *sourcePalette,
+	uint16_t transparentColor,
+	uint16_t fadeColor,
+	float fadeFraction
+) {
+	uint16_t sourceColor;
 	if(
 		fadeFraction >= 1.0f
 	) {
@@ -98,6 +177,7 @@ MageColorPalette::MageColorPalette(
 			}
 		}
 	}
+	updateOpaque();
 }
 
 #ifdef DC801_DESKTOP
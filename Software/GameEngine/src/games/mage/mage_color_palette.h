@@ -2,6 +2,7 @@
 #define SOFTWARE_MAGE_COLOR_PALETTE_H
 
 #include <memory>
+#include "EngineImage.h"
 #define COLOR_PALETTE_INTEGRITY_STRING_LENGTH 2048
 #define COLOR_PALETTE_NAME_LENGTH 32
 #define COLOR_PALETTE_NAME_SIZE COLOR_PALETTE_NAME_LENGTH + 1
@@ -15,6 +16,19 @@ public:
 	#endif //DC801_DESKTOP
 	uint8_t colorCount;
 	std::unique_ptr<uint16_t[]> colors;
+	//true if none of the colors are TRANSPARENCY_COLOR, so tiles drawn
+	//with this palette can skip checking every pixel for it:
+	bool opaque = false;
+	//how the pixels of the image this is the palette of are stored,
+	//one of the ENGINE_IMAGE_FORMAT_*s:
+	uint8_t imageFormat = ENGINE_IMAGE_FORMAT_8BPP;
+
+	//this palette faded toward a color, kept so that a fade only has to fade
+	//each palette once per step instead of once for every tile it draws:
+	std::unique_ptr<MageColorPalette> fadedPalette;
+	uint16_t fadedTransparentColor = 0;
+	uint16_t fadedColor = 0;
+	float fadedFraction = 0.0f;
 
 	MageColorPalette() :
 		#ifdef DC801_DESKTOP
@@ -34,13 +48,35 @@ public:
 		float fadeFraction
 	);
 
+	//returns this palette faded by fadeFraction toward fadeColor,
+	//only fading it again if any of the arguments changed since last time:
+	MageColorPalette *getFadedPalette(
+		uint16_t transparentColor,
+		uint16_t fadeColor,
+		float fadeFraction
+	);
+
 	uint32_t size() const;
 
+	//true if the image's pixels are two to a byte:
+	bool packed() const;
+
+	//sets opaque again, for when colors were changed from outside:
+	void updateOpaque();
+
 	#ifdef DC801_DESKTOP
 	void generatePaletteIntegrityString(char *targetString);
 
 	void verifyColors(const char* errorTriggerDescription);
 	#endif //DC801_DESKTOP
+
+private:
+	void fadeColors(
+		MageColorPalette *sourcePalette,
+		uint16_t transparentColor,
+		uint16_t fadeColor,
+		float fadeFraction
+	);
 };
 
 #endif //SOFTWARE_MAGE_COLOR_PALETTE_H
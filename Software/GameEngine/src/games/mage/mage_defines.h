@@ -103,6 +103,64 @@ all of the old code used as the foundation of this badge.
 #define MAGE_MIN_MILLIS_BETWEEN_FRAMES 90
 #endif
 
+//the map layers under the entities are kept drawn in a buffer a little bigger
+//than the screen, and only the tiles scrolling into view get drawn each frame.
+//that buffer is (WIDTH + 2 tiles) * (HEIGHT + 2 tiles) * 2 bytes, about 220KB
+//with 32px tiles, which is more RAM than the badge has left.
+#ifndef MAGE_LAYER_CACHE
+#ifdef DC801_DESKTOP
+#define MAGE_LAYER_CACHE 1
+#else
+#define MAGE_LAYER_CACHE 0
+#endif //DC801_DESKTOP
+#endif //MAGE_LAYER_CACHE
+
+//RAM budget for the spans of tiles (see EngineTileSpans.h), worked out for
+//every tileset when the game loads, entity tilesets first. a tileset whose
+//spans don't fit in what's left is drawn checking every pixel instead.
+#ifndef MAGE_TILE_SPANS_BYTES
+#ifdef DC801_DESKTOP
+#define MAGE_TILE_SPANS_BYTES (4 * 1024 * 1024)
+#else
+//whatever the frame buffer and the game leave over, which isn't much
+#define MAGE_TILE_SPANS_BYTES (8 * 1024)
+#endif //DC801_DESKTOP
+#endif //MAGE_TILE_SPANS_BYTES
+
+//RAM budget for the occlusion mask of the current map, one byte for every
+//tile of it, see MageGameControl::buildOcclusion. a bigger map has every
+//layer drawn whole.
+#ifndef MAGE_OCCLUSION_BYTES
+#ifdef DC801_DESKTOP
+#define MAGE_OCCLUSION_BYTES (1024 * 1024)
+#else
+#define MAGE_OCCLUSION_BYTES (8 * 1024)
+#endif //DC801_DESKTOP
+#endif //MAGE_OCCLUSION_BYTES
+
+//RAM budget for the render list of the current map, four bytes for every
+//tile of every layer and a few more for every different tile on it, see
+//MageGameControl::compileRenderList. a bigger map is drawn straight from ROM.
+#ifndef MAGE_RENDER_LIST_BYTES
+#ifdef DC801_DESKTOP
+#define MAGE_RENDER_LIST_BYTES (4 * 1024 * 1024)
+#else
+#define MAGE_RENDER_LIST_BYTES (16 * 1024)
+#endif //DC801_DESKTOP
+#endif //MAGE_RENDER_LIST_BYTES
+
+//RAM budget for the dialog boxes, drawn ahead of time once per dialog screen,
+//see MageDialogControl::cacheBoxes. a box that doesn't fit in what's left is
+//drawn tile by tile every frame instead.
+#ifndef MAGE_DIALOG_CACHE_BYTES
+#ifdef DC801_DESKTOP
+#define MAGE_DIALOG_CACHE_BYTES (128 * 1024)
+#else
+//enough for the label and portrait boxes with 16px tiles, not the text box:
+#define MAGE_DIALOG_CACHE_BYTES (32 * 1024)
+#endif //DC801_DESKTOP
+#endif //MAGE_DIALOG_CACHE_BYTES
+
 // color palette corruption detection - requires much ram, can only be run on desktop
 #ifdef DC801_DESKTOP
 #define LOG_COLOR_PALETTE_CORRUPTION(value) MageGame->verifyAllColorPalettes((value));
@@ -282,6 +340,7 @@ typedef enum : uint8_t {
 	SLOT_SAVE,
 	SLOT_LOAD,
 	SLOT_ERASE,
+	CHECK_SAVE_IN_PROGRESS,
 	//this tracks the number of actions we're at:
 	NUM_ACTIONS
 } MageScriptActionTypeId;
@@ -1133,4 +1192,13 @@ typedef struct {
 	uint8_t paddingG;
 } ActionSlotErase;
 
+typedef struct {
+	uint16_t successScriptId;
+	uint8_t expectedBoolValue;
+	uint8_t paddingD;
+	uint8_t paddingE;
+	uint8_t paddingF;
+	uint8_t paddingG;
+} ActionCheckSaveInProgress;
+
 #endif //_MAGE_DEFINES_H
@@ -106,10 +106,21 @@ MageDialogControl::MageDialogControl() {
 	currentPortraitRenderableData = {};
 	messageIds = std::make_unique<uint16_t[]>(0);
 	responses = std::make_unique<MageDialogResponse[]>(0);
+	messageLayout = {};
+	nameLayout = {};
+	responseLayouts = std::make_unique<FrameBuffer_TextLayout[]>(0);
+	for (uint8_t boxIndex = 0; boxIndex < DIALOG_BOX_COUNT; boxIndex++) {
+		boxCaches[boxIndex] = {};
+	}
+	boxCacheEnabled = true;
 	currentScreen = {0};
 }
 
 uint32_t MageDialogControl::size() {
+	uint32_t layoutGlyphs = messageLayout.glyphCapacity + nameLayout.glyphCapacity;
+	for (int responseIndex = 0; responseIndex < currentScreen.responseCount; ++responseIndex) {
+		layoutGlyphs += responseLayouts[responseIndex].glyphCapacity;
+	}
 	return (
 		0
 		+ sizeof(currentFrameTileset)
@@ -129,6 +140,11 @@ uint32_t MageDialogControl::size() {
 		+ sizeof(std::string) // currentMessage
 		+ sizeof(uint16_t) * currentScreen.messageCount // messageIds
 		+ sizeof(MageDialogResponse) * currentScreen.responseCount // responses
+		+ sizeof(FrameBuffer_TextLayout) * (2 + currentScreen.responseCount) // messageLayout, nameLayout, responseLayouts
+		+ sizeof(FrameBuffer_TextGlyph) * layoutGlyphs
+		+ sizeof(boxCaches)
+		+ getBoxCacheBytes()
+		+ sizeof(boxCacheEnabled)
 		+ sizeof(isOpen)
 	);
 }
@@ -176,6 +192,7 @@ void MageDialogControl::showSaveMessageDialog(std::string messageString) {
 	currentScreen.responseType = NO_RESPONSE;
 	responses.reset();
 	responses = std::make_unique<MageDialogResponse[]>(0);
+	layoutMessage();
 	cursorPhase += 250;
 	isOpen = true;
 	mapLocalJumpScriptId = MAGE_NO_SCRIPT;
@@ -250,6 +267,9 @@ void MageDialogControl::loadNextScreen() {
 	currentImageAddress = MageGame->getImageAddress(
 		currentImageIndex
 	);
+	layoutNameAndResponses();
+	layoutMessage();
+	cacheBoxes();
 	currentScreenIndex++;
 	cursorPhase += 250;
 }
@@ -264,6 +284,7 @@ void MageDialogControl::advanceMessage() {
 			messageIds[currentMessageIndex],
 			triggeringEntityId
 		);
+		layoutMessage();
 	}
 }
 
@@ -307,40 +328,177 @@ bool MageDialogControl::shouldShowResponses() const {
 	);
 }
 
-void MageDialogControl::draw() {
+Point MageDialogControl::getBoxOrigin(Rect box) const {
+	uint16_t tileWidth = currentFrameTileset->TileWidth();
+	uint16_t tileHeight = currentFrameTileset->TileHeight();
+	return {
+		.x = (box.x * tileWidth) + (tileWidth / 2),
+		.y = (box.y * tileHeight) + (tileHeight / 2),
+	};
+}
+
+void MageDialogControl::layoutMessage() {
+	Rect box = alignments[currentScreen.alignment].text;
+	Point origin = getBoxOrigin(box);
+	mage_canvas->layoutMessage(
+		currentMessage.c_str(),
+		&Monaco9,
+		origin.x + currentFrameTileset->TileWidth() + 8,
+		origin.y + currentFrameTileset->TileHeight() - 2,
+		&messageLayout
+	);
+}
+
+void MageDialogControl::layoutNameAndResponses() {
+	MageDialogAlignmentCoords coords = alignments[currentScreen.alignment];
+	uint16_t tileWidth = currentFrameTileset->TileWidth();
+	uint16_t tileHeight = currentFrameTileset->TileHeight();
+	Point origin = getBoxOrigin(coords.label);
+	mage_canvas->layoutMessage(
+		currentEntityName.c_str(),
+		&Monaco9,
+		origin.x + tileWidth + 8,
+		origin.y + tileHeight - 2,
+		&nameLayout
+	);
+	// the responses are listed in the text box, under the message
+	origin = getBoxOrigin(coords.text);
+	responseLayouts.reset();
+	responseLayouts = std::make_unique<FrameBuffer_TextLayout[]>(currentScreen.responseCount);
+	for (int responseIndex = 0; responseIndex < currentScreen.responseCount; ++responseIndex) {
+		mage_canvas->layoutMessage(
+			MageGame->getString(
+				responses[responseIndex].stringIndex,
+				triggeringEntityId
+			).c_str(),
+			&Monaco9,
+			origin.x + (2 * tileWidth) + 8,
+			origin.y + ((responseIndex + 2) * tileHeight * 0.75) + 2,
+			&responseLayouts[responseIndex]
+		);
+	}
+}
+
+Rect MageDialogControl::getBox(uint8_t boxIndex) const {
 	MageDialogAlignmentCoords coords = alignments[currentScreen.alignment];
-	drawDialogBox(currentMessage, coords.text, true);
-	drawDialogBox(currentEntityName, coords.label);
+	if (boxIndex == DIALOG_BOX_LABEL) {
+		return coords.label;
+	}
+	if (boxIndex == DIALOG_BOX_PORTRAIT) {
+		return coords.portrait;
+	}
+	return coords.text;
+}
+
+void MageDialogControl::cacheBoxes() {
+	uint16_t tileWidth = currentFrameTileset->TileWidth();
+	uint16_t tileHeight = currentFrameTileset->TileHeight();
+	uint16_t transparentColor = SCREEN_ENDIAN_U2_VALUE(TRANSPARENCY_COLOR);
+	//what the buffers take counts against the budget, not what this screen uses of them:
+	uint32_t budget = MAGE_DIALOG_CACHE_BYTES;
+	for (uint8_t boxIndex = 0; boxIndex < DIALOG_BOX_COUNT; boxIndex++) {
+		MageDialogBoxCache *cache = &boxCaches[boxIndex];
+		cache->valid = false;
+		bool drawPortrait = boxIndex == DIALOG_BOX_PORTRAIT;
+		Rect box = getBox(boxIndex);
+		uint32_t width = box.w * tileWidth;
+		uint32_t height = box.h * tileHeight;
+		if (drawPortrait && currentPortraitId != DIALOG_SCREEN_NO_PORTRAIT) {
+			// a portrait bigger than its box would be cut off by the cache
+			MageTileset* tileset = MageGame->getValidTileset(currentPortraitRenderableData.tilesetId);
+			width = MAX(width, tileWidth + tileset->TileWidth());
+			height = MAX(height, tileHeight + tileset->TileHeight());
+		}
+		uint32_t pixelCount = width * height;
+		uint32_t pixelBytes = MAX(cache->pixelCapacity, pixelCount) * sizeof(uint16_t);
+		if (
+			(drawPortrait && currentPortraitId == DIALOG_SCREEN_NO_PORTRAIT)
+			|| width > UINT16_MAX
+			|| height > UINT16_MAX
+			|| pixelBytes > budget
+		) {
+			*cache = {};
+			continue;
+		}
+		if (cache->pixelCapacity < pixelCount) {
+			cache->pixelCapacity = pixelCount;
+			cache->pixels = std::make_unique<uint16_t[]>(pixelCount);
+		}
+		cache->width = width;
+		cache->height = height;
+		for (uint32_t i = 0; i < pixelCount; i++) {
+			cache->pixels[i] = transparentColor;
+		}
+		canvas.setDrawTarget(cache->pixels.get(), width, height);
+		drawBoxTiles(box, drawPortrait, 0, 0);
+		canvas.resetDrawTarget();
+		uint32_t spanCount = FrameBuffer::buildImageSpans(
+			cache->pixels.get(),
+			width,
+			height,
+			transparentColor,
+			NULL
+		);
+		uint32_t bytes = pixelBytes + (MAX(cache->spanCapacity, spanCount) * sizeof(uint16_t));
+		if (bytes > budget) {
+			*cache = {};
+			continue;
+		}
+		if (cache->spanCapacity < spanCount) {
+			cache->spanCapacity = spanCount;
+			cache->spans = std::make_unique<uint16_t[]>(spanCount);
+		}
+		FrameBuffer::buildImageSpans(
+			cache->pixels.get(),
+			width,
+			height,
+			transparentColor,
+			cache->spans.get()
+		);
+		budget -= bytes;
+		cache->valid = true;
+	}
+}
+
+void MageDialogControl::setBoxCacheEnabled(bool enabled) {
+	boxCacheEnabled = enabled;
+}
+
+uint32_t MageDialogControl::getBoxCacheBytes() const {
+	uint32_t bytes = 0;
+	for (uint8_t boxIndex = 0; boxIndex < DIALOG_BOX_COUNT; boxIndex++) {
+		bytes += (boxCaches[boxIndex].pixelCapacity + boxCaches[boxIndex].spanCapacity) * sizeof(uint16_t);
+	}
+	return bytes;
+}
+
+void MageDialogControl::draw() {
+	drawDialogBox(&messageLayout, DIALOG_BOX_TEXT, true);
+	drawDialogBox(&nameLayout, DIALOG_BOX_LABEL);
 	if(currentPortraitId != DIALOG_SCREEN_NO_PORTRAIT) {
-		drawDialogBox("", coords.portrait, false, true);
+		drawDialogBox(NULL, DIALOG_BOX_PORTRAIT);
 	}
 }
 
-void MageDialogControl::drawDialogBox(
-	const std::string &string,
+void MageDialogControl::drawBoxTiles(
 	Rect box,
-	bool drawArrow,
-	bool drawPortrait
+	bool drawPortrait,
+	int32_t offsetX,
+	int32_t offsetY
 ) {
 	uint16_t tileWidth = currentFrameTileset->TileWidth();
 	uint16_t tileHeight = currentFrameTileset->TileHeight();
-	uint16_t offsetX = (box.x * tileWidth) + (tileWidth / 2);
-	uint16_t offsetY = (box.y * tileHeight) + (tileHeight / 2);
 	uint16_t tilesetColumns = currentFrameTileset->Cols();
 	uint16_t imageWidth = currentFrameTileset->ImageWidth();
-	uint16_t x;
-	uint16_t y;
 	uint8_t tileId;
 	for (uint8_t i = 0; i < box.w; ++i) {
 		for (uint8_t j = 0; j < box.h; ++j) {
-			x = offsetX + (i * tileWidth);
-			y = offsetY + (j * tileHeight);
 			tileId = getTileIdFromXY(i, j, box);
 			canvas.drawChunkWithFlags(
 				currentImageAddress,
 				MageGame->getValidColorPalette(currentImageIndex),
-				x,
-				y,
+				offsetX + (i * tileWidth),
+				offsetY + (j * tileHeight),
 				tileWidth,
 				tileHeight,
 				(tileId % tilesetColumns) * tileWidth,
@@ -351,13 +509,62 @@ void MageDialogControl::drawDialogBox(
 			);
 		}
 	}
-	mage_canvas->printMessage(
-		string.c_str(),
-		Monaco9,
-		0xffff,
-		offsetX + tileWidth + 8,
-		offsetY + tileHeight - 2
-	);
+	if(drawPortrait) {
+		tileId = currentPortraitRenderableData.tileId;
+		MageTileset* tileset = MageGame->getValidTileset(currentPortraitRenderableData.tilesetId);
+		uint8_t portraitFlags = currentPortraitRenderableData.renderFlags;
+		canvas.drawChunkWithFlags(
+			MageGame->getImageAddress(tileset->ImageId()),
+			MageGame->getValidColorPalette(tileset->ImageId()),
+			offsetX + tileWidth,
+			offsetY + tileHeight,
+			tileset->TileWidth(),
+			tileset->TileHeight(),
+			(tileId % tileset->Cols()) * tileset->TileWidth(),
+			(tileId / tileset->Cols()) * tileset->TileHeight(),
+			tileset->ImageWidth(),
+			TRANSPARENCY_COLOR,
+			portraitFlags,
+			tileset->TileSpans(tileId)
+		);
+	}
+}
+
+void MageDialogControl::drawDialogBox(
+	const FrameBuffer_TextLayout *layout,
+	uint8_t boxIndex,
+	bool drawArrow
+) {
+	Rect box = getBox(boxIndex);
+	const MageDialogBoxCache *cache = &boxCaches[boxIndex];
+	uint16_t tileWidth = currentFrameTileset->TileWidth();
+	uint16_t tileHeight = currentFrameTileset->TileHeight();
+	Point origin = getBoxOrigin(box);
+	uint16_t offsetX = origin.x;
+	uint16_t offsetY = origin.y;
+	uint16_t tilesetColumns = currentFrameTileset->Cols();
+	uint16_t imageWidth = currentFrameTileset->ImageWidth();
+	uint16_t x;
+	uint16_t y;
+	if (
+		boxCacheEnabled
+		&& cache->valid
+		&& canvas.fadeFraction == 0 //the cache isn't faded
+	) {
+		canvas.drawImageSpans(
+			offsetX,
+			offsetY,
+			cache->width,
+			cache->height,
+			cache->pixels.get(),
+			cache->spans.get()
+		);
+	} else {
+		drawBoxTiles(box, boxIndex == DIALOG_BOX_PORTRAIT, offsetX, offsetY);
+	}
+	if (layout != NULL) {
+		mage_canvas->drawLayout(layout, 0xffff);
+	}
 	if (drawArrow) {
 		int8_t bounce = cos(((float)cursorPhase / 1000.0) * TAU) * 3;
 		uint8_t flags = 0;
@@ -367,16 +574,7 @@ void MageDialogControl::drawDialogBox(
 			y = offsetY + ((currentResponseIndex + 2) * tileHeight * 0.75) + 6;
 			// render all of the response labels
 			for (int responseIndex = 0; responseIndex < currentScreen.responseCount; ++responseIndex) {
-				mage_canvas->printMessage(
-					MageGame->getString(
-						responses[responseIndex].stringIndex,
-						triggeringEntityId
-					).c_str(),
-					Monaco9,
-					0xffff,
-					offsetX + (2 * tileWidth) + 8,
-					offsetY + ((responseIndex + 2) * tileHeight * 0.75) + 2
-				);
+				mage_canvas->drawLayout(&responseLayouts[responseIndex], 0xffff);
 			}
 		} else {
 			// bounce the arrow at the bottom
@@ -397,26 +595,6 @@ void MageDialogControl::drawDialogBox(
 			flags
 		);
 	}
-	if(drawPortrait) {
-		x = offsetX + tileWidth;
-		y = offsetY + tileHeight;
-		tileId = currentPortraitRenderableData.tileId;
-		MageTileset* tileset = MageGame->getValidTileset(currentPortraitRenderableData.tilesetId);
-		uint8_t portraitFlags = currentPortraitRenderableData.renderFlags;
-		canvas.drawChunkWithFlags(
-			MageGame->getImageAddress(tileset->ImageId()),
-			MageGame->getValidColorPalette(tileset->ImageId()),
-			x,
-			y,
-			tileset->TileWidth(),
-			tileset->TileHeight(),
-			(tileId % tileset->Cols()) * tileset->TileWidth(),
-			(tileId / tileset->Cols()) * tileset->TileHeight(),
-			tileset->ImageWidth(),
-			TRANSPARENCY_COLOR,
-			portraitFlags
-		);
-	}
 }
 
 uint8_t MageDialogControl::getTileIdFromXY(
@@ -29,6 +29,11 @@
 #define DIALOG_TILES_HIGHLIGHT 14
 #define DIALOG_TILES_ARROW 15
 
+#define DIALOG_BOX_TEXT 0
+#define DIALOG_BOX_LABEL 1
+#define DIALOG_BOX_PORTRAIT 2
+#define DIALOG_BOX_COUNT 3
+
 enum MageDialogScreenAlignment : uint8_t {
 	BOTTOM_LEFT = 0,
 	BOTTOM_RIGHT = 1,
@@ -71,6 +76,19 @@ typedef struct {
 	Rect portrait;
 } MageDialogAlignmentCoords;
 
+//a dialog box's tiles, and its portrait if it has one, already drawn, so a
+//frame only has to copy the runs of it that aren't transparent:
+typedef struct {
+	std::unique_ptr<uint16_t[]> pixels;
+	//see FrameBuffer::buildImageSpans:
+	std::unique_ptr<uint16_t[]> spans;
+	uint32_t pixelCapacity;
+	uint32_t spanCapacity;
+	uint16_t width;
+	uint16_t height;
+	bool valid;
+} MageDialogBoxCache;
+
 class MageDialogControl {
 	private:
 		// char dialogName[32];
@@ -92,18 +110,35 @@ class MageDialogControl {
 		std::string currentMessage;
 		std::unique_ptr<uint16_t[]>messageIds;
 		std::unique_ptr<MageDialogResponse[]>responses;
+		//the text of each box, laid out when the screen or message changes,
+		//so draw doesn't read strings out of ROM or wrap them every frame:
+		FrameBuffer_TextLayout messageLayout;
+		FrameBuffer_TextLayout nameLayout;
+		std::unique_ptr<FrameBuffer_TextLayout[]>responseLayouts;
+		//the boxes only change when a screen loads, so they're drawn then:
+		MageDialogBoxCache boxCaches[DIALOG_BOX_COUNT];
+		bool boxCacheEnabled;
 		uint8_t getTileIdFromXY(
 			uint8_t x,
 			uint8_t y,
 			Rect box
 		);
-		void drawDialogBox(
-			const std::string &string,
+		Point getBoxOrigin(Rect box) const;
+		void layoutMessage();
+		void layoutNameAndResponses();
+		Rect getBox(uint8_t boxIndex) const;
+		void cacheBoxes();
+		void drawBoxTiles(
 			Rect box,
-			bool drawArrow = false,
-			bool drawPortrait = false
+			bool drawPortrait,
+			int32_t offsetX,
+			int32_t offsetY
+		);
+		void drawDialogBox(
+			const FrameBuffer_TextLayout *layout,
+			uint8_t boxIndex,
+			bool drawArrow = false
 		);
-		bool shouldShowResponses() const;
 
 	public:
 		bool isOpen;
@@ -120,6 +155,13 @@ class MageDialogControl {
 		void closeDialog();
 		void update();
 		void draw();
+		//true on the last message of a screen that has a list of responses:
+		bool shouldShowResponses() const;
+		//false draws every box tile by tile, the way it was before the
+		//boxes were cached, so tests can compare and time both. on by default.
+		void setBoxCacheEnabled(bool enabled);
+		//how many bytes of the budget the boxes' buffers take:
+		uint32_t getBoxCacheBytes() const;
 
 	void loadCurrentScreenPortrait();
 };
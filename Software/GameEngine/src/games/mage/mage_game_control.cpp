@@ -2,6 +2,7 @@
 
 #include "EngineROM.h"
 #include "FrameBuffer.h"
+#include "EngineTileCache.h"
 #include "mage_hex.h"
 #include "mage_script_control.h"
 #include "mage_dialog_control.h"
@@ -88,6 +89,7 @@ MageGameControl::MageGameControl()
 	for (uint32_t i = 0; i < tilesetHeader.count(); i++)
 	{
 		tilesets[i] = MageTileset(i, tilesetHeader.offset(i));
+		tallestTileHeight = MAX(tallestTileHeight, (int32_t)tilesets[i].TileHeight());
 	}
 
 	animations = std::make_unique<MageAnimation[]>(animationHeader.count());
@@ -116,9 +118,18 @@ MageGameControl::MageGameControl()
 	{
 		colorPalettes[i] = MageColorPalette(colorPaletteHeader.offset(i));
 	}
+	//the new palettes could end up where old ones were, so drop their tiles:
+	EngineTileCache_Invalidate();
 	#ifdef DC801_DESKTOP
 	verifyAllColorPalettes("Right after it was read from ROM");
 	#endif //DC801_DESKTOP
+	//needs the color palettes to know which pixels are transparent:
+	buildTileSpans();
+	for (uint32_t i = 0; i < tilesetHeader.count(); i++)
+	{
+		uint16_t imageId = tilesets[i].ImageId();
+		tilesets[i].BuildOpacity(getImageAddress(imageId), getValidColorPalette(imageId));
+	}
 
 	mageSpeed = 0;
 	isMoving = false;
@@ -134,6 +145,47 @@ MageGameControl::MageGameControl()
 	readSaveFromRomIntoRam(true);
 }
 
+void MageGameControl::buildTileSpans()
+{
+	uint32_t bytesLeft = MAGE_TILE_SPANS_BYTES;
+	uint16_t tilesetsWithSpans = 0;
+	//sprites are what have the most transparent pixels around them:
+	std::unique_ptr<bool[]> usedByAnimations = std::make_unique<bool[]>(tilesetHeader.count());
+	for (uint32_t i = 0; i < animationHeader.count(); i++)
+	{
+		usedByAnimations[getValidTilesetId(animations[i].TilesetId())] = true;
+	}
+	for (uint8_t pass = 0; pass < 2; pass++)
+	{
+		for (uint32_t i = 0; i < tilesetHeader.count(); i++)
+		{
+			if (usedByAnimations[i] != (pass == 0))
+			{
+				continue;
+			}
+			uint16_t imageId = tilesets[i].ImageId();
+			uint32_t bytes = tilesets[i].BuildSpans(
+				getImageAddress(imageId),
+				getValidColorPalette(imageId),
+				bytesLeft
+			);
+			if (bytes > 0)
+			{
+				bytesLeft -= bytes;
+				tilesetsWithSpans++;
+			}
+		}
+	}
+	#ifdef DC801_DESKTOP
+	debug_print(
+		"Tile spans: %u bytes for %u of %u tilesets",
+		MAGE_TILE_SPANS_BYTES - bytesLeft,
+		tilesetsWithSpans,
+		tilesetHeader.count()
+	);
+	#endif //DC801_DESKTOP
+}
+
 uint32_t MageGameControl::Size() const
 {
 	uint32_t size = (
@@ -171,7 +223,8 @@ uint32_t MageGameControl::Size() const
 		sizeof(uint8_t)*MAX_ENTITIES_PER_MAP + //filteredMapLocalEntityIds
 		sizeof(uint8_t)*MAX_ENTITIES_PER_MAP + //mapLocalEntityIds
 		sizeof(MageEntity)*MAX_ENTITIES_PER_MAP+ //entities array
-		sizeof(MageEntityRenderableData)*MAX_ENTITIES_PER_MAP //entityRenderableData array
+		sizeof(MageEntityRenderableData)*MAX_ENTITIES_PER_MAP+ //entityRenderableData array
+		sizeof(uint16_t)*layerCacheSize //layerCache
 	);
 
 	for (uint32_t i = 0; i < tilesetHeader.count(); i++)
@@ -244,13 +297,14 @@ void MageGameControl::readSaveFromRomIntoRam(
 
 void MageGameControl::saveGameSlotSave() {
 	// do rom writes
+	// this only starts the save, the game carries on while it's written,
+	// so currentSave already is what ends up in ROM, no need to read it back
 	copyNameToAndFromPlayerAndSave(true);
 	EngineROM_WriteSaveSlot(
 		currentSaveIndex,
 		sizeof(MageSaveGame),
 		(uint8_t *)&currentSave
 	);
-	readSaveFromRomIntoRam();
 }
 
 void MageGameControl::saveGameSlotErase(uint8_t slotIndex) {
@@ -283,6 +337,21 @@ MageMap& MageGameControl::Map()
 	return map;
 }
 
+uint16_t MageGameControl::MapCount() const
+{
+	return mapHeader.count();
+}
+
+uint16_t MageGameControl::TilesetCount() const
+{
+	return tilesetHeader.count();
+}
+
+uint16_t MageGameControl::DialogCount() const
+{
+	return dialogHeader.count();
+}
+
 MageEntity MageGameControl::LoadEntity(uint32_t address)
 {
 	uint32_t size = 0;
@@ -533,6 +602,254 @@ void MageGameControl::PopulateMapData(uint16_t index)
 		//other values are filled in when getEntityRenderableData is called:
 		updateEntityRenderableData(getMapLocalEntityId(i), true);
 	}
+
+	buildOcclusion();
+	compileRenderList();
+}
+
+//one tile of a map layer, the way it is in ROM:
+struct MageMapTile {
+	uint16_t tileId = 0;
+	uint8_t tilesetId = 0;
+	uint8_t flags = 0;
+};
+
+void MageGameControl::buildOcclusion()
+{
+	occlusionBuilt = false;
+	int32_t mapTileWidth = map.TileWidth();
+	int32_t mapTileHeight = map.TileHeight();
+	uint32_t cells = map.Cols() * map.Rows();
+	if (!occlusionCulling || cells == 0 || cells > MAGE_OCCLUSION_BYTES)
+	{
+		return;
+	}
+	if (occludingLayersSize < cells)
+	{
+		occludingLayersSize = cells;
+		occludingLayers = std::make_unique<uint8_t[]>(occludingLayersSize);
+	}
+	memset(occludingLayers.get(), 0, cells);
+	MageMapTile tile;
+	for (uint8_t layer = 0; layer < map.LayerCount(); layer++)
+	{
+		uint32_t layerAddress = map.LayerOffset(layer);
+		if (layerAddress == 0)
+		{
+			continue;
+		}
+		const uint8_t *tiles = EngineROM_View(layerAddress, cells * sizeof(tile));
+		for (uint32_t cell = 0; cell < cells; cell++)
+		{
+			memcpy(&tile, tiles + (cell * sizeof(tile)), sizeof(tile));
+			tile.tileId = ROM_ENDIAN_U2_VALUE(tile.tileId);
+			if (tile.tileId == 0)
+			{
+				continue;
+			}
+			const MageTileset &tileset = Tileset(tile.tilesetId);
+			RenderFlagsUnion flags;
+			flags.i = tile.flags;
+			//flipping it across doesn't change what it covers, but a glitched
+			//tile is drawn narrower, and turning one that isn't square
+			//makes it cover something else:
+			if (
+				tileset.TileOpaque(tile.tileId - 1)
+				&& tileset.TileWidth() == mapTileWidth
+				&& tileset.TileHeight() == mapTileHeight
+				&& !flags.f.glitched
+				&& (!flags.f.diagonal || mapTileWidth == mapTileHeight)
+			)
+			{
+				occludingLayers[cell] = layer + 1;
+			}
+		}
+	}
+	occlusionBuilt = true;
+}
+
+bool MageGameControl::tileHidden(uint8_t layer, uint32_t cell, bool mapSized, uint8_t flags) const
+{
+	//as long as it's the size of the one over it, the way it's turned:
+	return occlusionBuilt
+		&& occludingLayers[cell] > layer + 1
+		&& mapSized
+		&& (
+			!(flags & FLIPPED_DIAGONALLY_FLAG)
+			|| map.TileWidth() == map.TileHeight()
+		);
+}
+
+void MageGameControl::setOcclusionCulling(bool enabled)
+{
+	occlusionCulling = enabled;
+	buildOcclusion();
+	//which tiles are hidden is in there too:
+	compileRenderList();
+	invalidateLayerCache();
+}
+
+void MageGameControl::resolveRenderTile(uint8_t tilesetId, uint16_t tileId, MageRenderTile *tile)
+{
+	const MageTileset &tileset = Tileset(tilesetId);
+	tile->colorPalette = getValidColorPalette(tileset.ImageId());
+	tile->address = tileset.TileAddress(
+		imageHeader.offset(tileset.ImageId()),
+		tile->colorPalette,
+		tileId
+	);
+	tile->spans = tileset.TileSpans(tileId);
+	tile->width = tileset.TileWidth();
+	tile->height = tileset.TileHeight();
+	tile->pitch = tileset.ImageWidth();
+	tile->tileId = tileId;
+	tile->tilesetId = tilesetId;
+	tile->mapSized = tile->width == map.TileWidth() && tile->height == map.TileHeight();
+}
+
+void MageGameControl::compileRenderList()
+{
+	uint32_t start = micros();
+	renderListBuilt = false;
+	renderListStats = {};
+	uint32_t cellsPerLayer = map.Cols() * map.Rows();
+	uint32_t cells = cellsPerLayer * map.LayerCount();
+	if (
+		!renderListEnabled
+		|| cells == 0
+		|| cells * sizeof(MageRenderCell) > MAGE_RENDER_LIST_BYTES
+	)
+	{
+		return;
+	}
+	if (renderCellsSize < cells)
+	{
+		renderCellsSize = cells;
+		renderCells = std::make_unique<MageRenderCell[]>(renderCellsSize);
+	}
+	//1 + which render tile each tile of the tilesets on the map became,
+	//only for as long as this takes:
+	std::unique_ptr<std::unique_ptr<uint16_t[]>[]> tileIndexes =
+		std::make_unique<std::unique_ptr<uint16_t[]>[]>(tilesetHeader.count());
+	uint32_t tiles = 0;
+	MageMapTile tile;
+	for (uint8_t layer = 0; layer < map.LayerCount(); layer++)
+	{
+		uint32_t layerAddress = map.LayerOffset(layer);
+		const uint8_t *layerTiles = layerAddress != 0
+			? EngineROM_View(layerAddress, cellsPerLayer * sizeof(tile))
+			: NULL;
+		for (uint32_t cell = 0; cell < cellsPerLayer; cell++)
+		{
+			MageRenderCell &renderCell = renderCells[(layer * cellsPerLayer) + cell];
+			renderCell = {};
+			if (layerTiles == NULL)
+			{
+				continue;
+			}
+			memcpy(&tile, layerTiles + (cell * sizeof(tile)), sizeof(tile));
+			tile.tileId = ROM_ENDIAN_U2_VALUE(tile.tileId);
+			if (tile.tileId == 0)
+			{
+				continue;
+			}
+			tile.tileId -= 1;
+			//DrawMap reads those from ROM the way it always did:
+			if (
+				tile.tilesetId >= tilesetHeader.count()
+				|| tile.tileId >= tilesets[tile.tilesetId].Tiles()
+				|| tiles == UINT16_MAX
+			)
+			{
+				return;
+			}
+			std::unique_ptr<uint16_t[]> &indexes = tileIndexes[tile.tilesetId];
+			if (!indexes)
+			{
+				indexes = std::make_unique<uint16_t[]>(tilesets[tile.tilesetId].Tiles());
+			}
+			if (indexes[tile.tileId] == 0)
+			{
+				indexes[tile.tileId] = ++tiles;
+			}
+			const MageTileset &tileset = tilesets[tile.tilesetId];
+			renderCell.tile = indexes[tile.tileId];
+			renderCell.flags = tile.flags;
+			renderCell.hidden = tileHidden(
+				layer,
+				cell,
+				tileset.TileWidth() == map.TileWidth() && tileset.TileHeight() == map.TileHeight(),
+				tile.flags
+			);
+		}
+	}
+	uint32_t bytes = (cells * sizeof(MageRenderCell)) + (tiles * sizeof(MageRenderTile));
+	if (bytes > MAGE_RENDER_LIST_BYTES)
+	{
+		return;
+	}
+	if (renderTilesSize < tiles)
+	{
+		renderTilesSize = tiles;
+		renderTiles = std::make_unique<MageRenderTile[]>(renderTilesSize);
+	}
+	for (uint32_t tilesetId = 0; tilesetId < tilesetHeader.count(); tilesetId++)
+	{
+		if (!tileIndexes[tilesetId])
+		{
+			continue;
+		}
+		for (uint16_t tileId = 0; tileId < tilesets[tilesetId].Tiles(); tileId++)
+		{
+			uint16_t index = tileIndexes[tilesetId][tileId];
+			if (index != 0)
+			{
+				resolveRenderTile(tilesetId, tileId, &renderTiles[index - 1]);
+			}
+		}
+	}
+	renderListBuilt = true;
+	renderListStats.bytes = bytes;
+	renderListStats.cells = cells;
+	renderListStats.tiles = tiles;
+	renderListStats.microseconds = micros() - start;
+}
+
+void MageGameControl::setRenderList(bool enabled)
+{
+	renderListEnabled = enabled;
+	compileRenderList();
+	invalidateLayerCache();
+}
+
+const MageRenderListStats *MageGameControl::getRenderListStats() const
+{
+	return &renderListStats;
+}
+
+const MageOcclusionStats *MageGameControl::getOcclusionStats() const
+{
+	return &occlusionStats;
+}
+
+void MageGameControl::resetOcclusionStats()
+{
+	occlusionStats = {};
+}
+
+void MageGameControl::logOcclusionStats(const char *label) const
+{
+	if (occlusionStats.frames == 0)
+	{
+		return;
+	}
+	debug_print(
+		"Occlusion (%s): %u frames, %u tiles drawn and %u culled per frame",
+		label,
+		occlusionStats.frames,
+		occlusionStats.tilesDrawn / occlusionStats.frames,
+		occlusionStats.tilesCulled / occlusionStats.frames
+	);
 }
 
 void MageGameControl::initializeScriptsOnMapLoad()
@@ -571,6 +888,20 @@ void MageGameControl::LoadMap(uint16_t index)
 	//while the fraction was anything other than 0
 	canvas.fadeFraction = 0;
 
+	//a new map brings a new tileset, so start the tile cache over.
+	//the stats for the map being left are how the cache budget gets sized:
+	#ifdef DC801_DESKTOP
+	EngineTileCache_LogStats("leaving map");
+	canvas.logPresentStats("leaving map");
+	canvas.resetPresentStats();
+	canvas.logBandStats("leaving map");
+	canvas.resetBandStats();
+	logOcclusionStats("leaving map");
+	#endif //DC801_DESKTOP
+	resetOcclusionStats();
+	EngineTileCache_Invalidate();
+	invalidateLayerCache();
+
 	//close any open dialogs and return player control as well:
 	MageDialog->closeDialog();
 	playerHasControl = true;
@@ -914,120 +1245,379 @@ void MageGameControl::handleEntityInteract(
 	}
 }
 
+//rounds toward negative infinity, unlike `/`, so it works for tiles left of or
+//above the camera when the camera is off the top left of the map:
+static int32_t floorDivide(int32_t numerator, int32_t denominator)
+{
+	int32_t quotient = numerator / denominator;
+	if ((numerator % denominator != 0) && ((numerator < 0) != (denominator < 0)))
+	{
+		quotient -= 1;
+	}
+	return quotient;
+}
+
 void MageGameControl::DrawMap(uint8_t layer)
 {
 	int32_t camera_x = adjustedCameraPosition.x;
 	int32_t camera_y = adjustedCameraPosition.y;
-	uint32_t tilesPerLayer = map.Cols() * map.Rows();
+	int32_t mapTileWidth = map.TileWidth();
+	int32_t mapTileHeight = map.TileHeight();
+	if(mapTileWidth == 0 || mapTileHeight == 0)
+	{
+		return;
+	}
+
+	//only walk the window of tiles that can be on screen, instead of the whole layer.
+	//a tile is in it if its top left corner is within one tile of the screen:
+	//x >= -mapTileWidth && x <= WIDTH, and the same for y.
+	//when only a band of the screen is being drawn, the rows of tiles that
+	//can't reach into the band are left out of it too:
+	//the top layer is drawn every frame, and with every band:
+	if (layer == map.LayerCount() - 1 && canvas.getBandTop() == 0)
+	{
+		occlusionStats.frames++;
+	}
+	int32_t top = MAX(-mapTileHeight, canvas.getBandTop() - tallestTileHeight);
+	int32_t bottom = MIN(HEIGHT, canvas.getBandBottom());
+	drawMapTiles(
+		layer,
+		-floorDivide(mapTileWidth - camera_x, mapTileWidth),
+		floorDivide(camera_x + WIDTH, mapTileWidth),
+		-floorDivide(-top - camera_y, mapTileHeight),
+		floorDivide(camera_y + bottom, mapTileHeight),
+		camera_x,
+		camera_y
+	);
+}
+
+void MageGameControl::drawMapTiles(
+	uint8_t layer,
+	int32_t firstCol,
+	int32_t lastCol,
+	int32_t firstRow,
+	int32_t lastRow,
+	int32_t camera_x,
+	int32_t camera_y
+)
+{
+	int32_t mapTileWidth = map.TileWidth();
+	int32_t mapTileHeight = map.TileHeight();
 	uint32_t layerAddress = map.LayerOffset(layer);
 	if(layerAddress == 0)
 	{
 		return;
 	}
-	uint32_t address = layerAddress;
 	int32_t tile_x = 0;
 	int32_t tile_y = 0;
 	int32_t x = 0;
 	int32_t y = 0;
 	uint16_t geometryId = 0;
 	MageGeometry geometry;
-
-	struct MageMapTile {
-		uint16_t tileId = 0;
-		uint8_t tilesetId = 0;
-		uint8_t flags = 0;
-	} currentTile;
+	MageMapTile currentTile;
+	MageRenderCell cell;
+	MageRenderTile resolvedTile;
+
+	firstCol = MAX(0, firstCol);
+	lastCol = MIN((int32_t)map.Cols() - 1, lastCol);
+	firstRow = MAX(0, firstRow);
+	lastRow = MIN((int32_t)map.Rows() - 1, lastRow);
+	if (firstCol > lastCol || firstRow > lastRow)
+	{
+		return;
+	}
+	uint32_t visibleCols = lastCol - firstCol + 1;
 
 	Point playerPoint = getEntityRenderableDataByMapLocalId(playerEntityIndex)->center;
-	for (uint32_t i = 0; i < tilesPerLayer; i++)
+	for (int32_t row = firstRow; row <= lastRow; row++)
 	{
-		tile_x = (int32_t)(map.TileWidth() * (i % map.Cols()));
-		tile_y = (int32_t)(map.TileHeight() * (i / map.Cols()));
-		x = tile_x - camera_x;
-		y = tile_y - camera_y;
-
-		if ((x < (-map.TileWidth()) ||
-			(x > WIDTH) ||
-			(y < (-map.TileHeight())) ||
-			(y > HEIGHT)))
+		//the tiles of each row are next to each other, in the render list
+		//or in ROM, so get them all at once:
+		uint32_t firstCell = (row * map.Cols()) + firstCol;
+		const MageRenderCell *rowCells = NULL;
+		const uint8_t *rowTiles = NULL;
+		if (renderListBuilt)
 		{
-			continue;
+			rowCells = &renderCells[(layer * map.Cols() * map.Rows()) + firstCell];
+		}
+		else
+		{
+			rowTiles = EngineROM_View(
+				layerAddress + (firstCell * sizeof(currentTile)),
+				visibleCols * sizeof(currentTile)
+			);
 		}
-		address = layerAddress + (i * sizeof(currentTile));
+		tile_y = (int32_t)(mapTileHeight * row);
+		y = tile_y - camera_y;
+		for (uint32_t i = 0; i < visibleCols; i++)
+		{
+			const MageRenderTile *tile = &resolvedTile;
+			if (rowCells != NULL)
+			{
+				cell = rowCells[i];
+				if (cell.tile == 0)
+				{
+					continue;
+				}
+				tile = &renderTiles[cell.tile - 1];
+			}
+			else
+			{
+				memcpy(
+					&currentTile,
+					rowTiles + (i * sizeof(currentTile)),
+					sizeof(currentTile)
+				);
 
-		EngineROM_Read(
-			address,
-			sizeof(currentTile),
-			(uint8_t *)&currentTile,
-			"DrawMap Failed to read property 'currentTile'"
-		);
+				currentTile.tileId = ROM_ENDIAN_U2_VALUE(currentTile.tileId);
 
+				if (currentTile.tileId == 0)
+				{
+					continue;
+				}
 
-		currentTile.tileId = ROM_ENDIAN_U2_VALUE(currentTile.tileId);
+				resolveRenderTile(currentTile.tilesetId, currentTile.tileId - 1, &resolvedTile);
+				cell.flags = currentTile.flags;
+				cell.hidden = tileHidden(layer, firstCell + i, resolvedTile.mapSized, cell.flags);
+			}
 
-		if (currentTile.tileId == 0)
-		{
-			continue;
-		}
+			tile_x = (int32_t)(mapTileWidth * (firstCol + i));
+			x = tile_x - camera_x;
 
-		currentTile.tileId -= 1;
+			if (!tile->mapSized) {
+				layerCacheUsable = false;
+			}
 
-		const MageTileset &tileset = Tileset(currentTile.tilesetId);
+			if (cell.hidden) {
+				occlusionStats.tilesCulled++;
+			} else {
+				canvas.drawChunkWithFlags(
+					tile->address,
+					tile->colorPalette,
+					x,
+					y,
+					tile->width,
+					tile->height,
+					0,
+					0,
+					tile->pitch,
+					TRANSPARENCY_COLOR,
+					cell.flags,
+					tile->spans
+				);
+				occlusionStats.tilesDrawn++;
+			}
 
-		MageColorPalette *colorPalette = getValidColorPalette(tileset.ImageId());
-		address = imageHeader.offset(tileset.ImageId());
-		canvas.drawChunkWithFlags(
-			address,
-			colorPalette,
-			x,
-			y,
-			tileset.TileWidth(),
-			tileset.TileHeight(),
-			(currentTile.tileId % tileset.Cols()) * tileset.TileWidth(),
-			(currentTile.tileId / tileset.Cols()) * tileset.TileHeight(),
-			tileset.ImageWidth(),
-			TRANSPARENCY_COLOR,
-			currentTile.flags
+			if (isCollisionDebugOn) {
+				geometryId = Tileset(tile->tilesetId).getLocalGeometryIdByTileIndex(tile->tileId);
+				if (geometryId) {
+					geometryId -= 1;
+					geometry = getGeometryFromGlobalId(geometryId);
+					geometry.flipSelfByFlags(
+						cell.flags,
+						tile->width,
+						tile->height
+					);
+					bool isMageInGeometry = false;
+					if (
+						playerEntityIndex != NO_PLAYER
+						&& playerPoint.x >= tile_x
+						&& playerPoint.x <= tile_x + tile->width
+						&& playerPoint.y >= tile_y
+						&& playerPoint.y <= tile_y + tile->height
+					) {
+						Point offsetPoint = {
+							.x= playerPoint.x - tile_x,
+							.y= playerPoint.y - tile_y,
+						};
+						isMageInGeometry = geometry.isPointInGeometry(
+							offsetPoint
+						);
+					}
+					geometry.draw(
+						camera_x,
+						camera_y,
+						isMageInGeometry
+							? COLOR_RED
+							: COLOR_GREEN,
+						tile_x,
+						tile_y
+					);
+				}
+			}
+		}
+	}
+}
+
+void MageGameControl::invalidateLayerCache()
+{
+	layerCacheValid = false;
+	layerCacheUsable = true;
+}
+
+void MageGameControl::drawLayerCacheTiles(
+	int32_t firstCol,
+	int32_t lastCol,
+	int32_t firstRow,
+	int32_t lastRow
+)
+{
+	int32_t mapTileWidth = map.TileWidth();
+	int32_t mapTileHeight = map.TileHeight();
+	uint8_t layerCount = map.LayerCount();
+	uint8_t layersUnderEntities = layerCount > 1
+		? layerCount - 1
+		: 1;
+	uint16_t backgroundColor = SCREEN_ENDIAN_U2_VALUE(layerCacheBackgroundColor);
+	for (int32_t y = firstRow * mapTileHeight; y < (lastRow + 1) * mapTileHeight; y++)
+	{
+		uint16_t *pixel = &layerCache[(y * layerCacheWidth) + (firstCol * mapTileWidth)];
+		for (int32_t x = firstCol * mapTileWidth; x < (lastCol + 1) * mapTileWidth; x++)
+		{
+			*pixel++ = backgroundColor;
+		}
+	}
+	canvas.setDrawTarget(layerCache.get(), layerCacheWidth, layerCacheHeight);
+	for (uint8_t layer = 0; layer < layersUnderEntities; layer++)
+	{
+		drawMapTiles(
+			layer,
+			layerCacheCol + firstCol,
+			layerCacheCol + lastCol,
+			layerCacheRow + firstRow,
+			layerCacheRow + lastRow,
+			layerCacheCol * mapTileWidth,
+			layerCacheRow * mapTileHeight
 		);
+	}
+	canvas.resetDrawTarget();
+}
 
-		if (isCollisionDebugOn) {
-			geometryId = tileset.getLocalGeometryIdByTileIndex(currentTile.tileId);
-			if (geometryId) {
-				geometryId -= 1;
-				geometry = getGeometryFromGlobalId(geometryId);
-				geometry.flipSelfByFlags(
-					currentTile.flags,
-					tileset.TileWidth(),
-					tileset.TileHeight()
-				);
-				bool isMageInGeometry = false;
-				if (
-					playerEntityIndex != NO_PLAYER
-					&& playerPoint.x >= tile_x
-					&& playerPoint.x <= tile_x + tileset.TileWidth()
-					&& playerPoint.y >= tile_y
-					&& playerPoint.y <= tile_y + tileset.TileHeight()
-				) {
-					Point offsetPoint = {
-						.x= playerPoint.x - tile_x,
-						.y= playerPoint.y - tile_y,
-					};
-					isMageInGeometry = geometry.isPointInGeometry(
-						offsetPoint
-					);
+bool MageGameControl::DrawLayerCache(uint16_t backgroundColor)
+{
+	int32_t mapTileWidth = map.TileWidth();
+	int32_t mapTileHeight = map.TileHeight();
+	if (
+		!MAGE_LAYER_CACHE
+		|| !layerCacheUsable
+		|| canvas.fadeFraction != 0 //fading changes every color every frame
+		|| isCollisionDebugOn //the geometry is drawn along with the tiles
+		|| mapTileWidth == 0
+		|| mapTileHeight == 0
+	)
+	{
+		return false;
+	}
+	int32_t cacheCols = (WIDTH / mapTileWidth) + 2;
+	int32_t cacheRows = (HEIGHT / mapTileHeight) + 2;
+	if (
+		layerCacheWidth != cacheCols * mapTileWidth
+		|| layerCacheHeight != cacheRows * mapTileHeight
+	)
+	{
+		layerCacheWidth = cacheCols * mapTileWidth;
+		layerCacheHeight = cacheRows * mapTileHeight;
+		if (layerCacheSize < (uint32_t)(layerCacheWidth * layerCacheHeight))
+		{
+			layerCacheSize = layerCacheWidth * layerCacheHeight;
+			layerCache = std::make_unique<uint16_t[]>(layerCacheSize);
+		}
+		layerCacheValid = false;
+	}
+	if (layerCacheBackgroundColor != backgroundColor)
+	{
+		layerCacheBackgroundColor = backgroundColor;
+		layerCacheValid = false;
+	}
+
+	int32_t camera_x = adjustedCameraPosition.x;
+	int32_t camera_y = adjustedCameraPosition.y;
+	int32_t firstCol = floorDivide(camera_x, mapTileWidth);
+	int32_t firstRow = floorDivide(camera_y, mapTileHeight);
+	int32_t colShift = firstCol - layerCacheCol;
+	int32_t rowShift = firstRow - layerCacheRow;
+	layerCacheCol = firstCol;
+	layerCacheRow = firstRow;
+	if (
+		!layerCacheValid
+		|| abs(colShift) >= cacheCols
+		|| abs(rowShift) >= cacheRows
+	)
+	{
+		drawLayerCacheTiles(0, cacheCols - 1, 0, cacheRows - 1);
+		layerCacheValid = true;
+	}
+	else
+	{
+		//move what is still in view over, then draw the tiles that came into view:
+		int32_t shiftX = colShift * mapTileWidth;
+		int32_t shiftY = rowShift * mapTileHeight;
+		if (shiftY > 0)
+		{
+			memmove(
+				&layerCache[0],
+				&layerCache[shiftY * layerCacheWidth],
+				(layerCacheHeight - shiftY) * layerCacheWidth * sizeof(uint16_t)
+			);
+		}
+		else if (shiftY < 0)
+		{
+			memmove(
+				&layerCache[-shiftY * layerCacheWidth],
+				&layerCache[0],
+				(layerCacheHeight + shiftY) * layerCacheWidth * sizeof(uint16_t)
+			);
+		}
+		if (shiftX != 0)
+		{
+			for (int32_t y = 0; y < layerCacheHeight; y++)
+			{
+				uint16_t *row = &layerCache[y * layerCacheWidth];
+				if (shiftX > 0)
+				{
+					memmove(row, row + shiftX, (layerCacheWidth - shiftX) * sizeof(uint16_t));
+				}
+				else
+				{
+					memmove(row - shiftX, row, (layerCacheWidth + shiftX) * sizeof(uint16_t));
 				}
-				geometry.draw(
-					camera_x,
-					camera_y,
-					isMageInGeometry
-						? COLOR_RED
-						: COLOR_GREEN,
-					tile_x,
-					tile_y
-				);
 			}
 		}
+		if (rowShift > 0)
+		{
+			drawLayerCacheTiles(0, cacheCols - 1, cacheRows - rowShift, cacheRows - 1);
+		}
+		else if (rowShift < 0)
+		{
+			drawLayerCacheTiles(0, cacheCols - 1, 0, -rowShift - 1);
+		}
+		if (colShift > 0)
+		{
+			drawLayerCacheTiles(cacheCols - colShift, cacheCols - 1, 0, cacheRows - 1);
+		}
+		else if (colShift < 0)
+		{
+			drawLayerCacheTiles(0, -colShift - 1, 0, cacheRows - 1);
+		}
 	}
+	if (!layerCacheUsable)
+	{
+		//found out while drawing it, so what's in the cache can't be trusted:
+		layerCacheValid = false;
+		return false;
+	}
+
+	canvas.drawImage(
+		0,
+		0,
+		WIDTH,
+		HEIGHT,
+		layerCache.get(),
+		camera_x - (firstCol * mapTileWidth),
+		camera_y - (firstRow * mapTileHeight),
+		layerCacheWidth
+	);
+	return true;
 }
 
 Point MageGameControl::getPushBackFromTilesThatCollideWithPlayer()
@@ -1073,11 +1663,7 @@ Point MageGameControl::getPushBackFromTilesThatCollideWithPlayer()
 		.x= 0,
 		.y= 0,
 	};
-	struct MageMapTile {
-		uint16_t tileId = 0;
-		uint8_t tilesetId = 0;
-		uint8_t flags = 0;
-	} currentTile;
+	MageMapTile currentTile;
 	Point playerPoint = playerRenderableData->center;
 	// get the geometry for where the player is
 	int32_t x0 = playerRect.x;
@@ -1644,7 +2230,8 @@ void MageGameControl::DrawEntities()
 			source_y,
 			tileset->ImageWidth(),
 			TRANSPARENCY_COLOR,
-			renderableData->renderFlags
+			renderableData->renderFlags,
+			tileset->TileSpans(tileId)
 		);
 		if (isCollisionDebugOn) {
 			canvas.drawRect(
@@ -20,6 +20,49 @@
 #define LOG_COLOR_PALETTE_CORRUPTION_INSIDE_MAGE_GAME(value) //(value)
 #endif //DC801_EMBEDDED
 
+//how many tiles DrawMap drew and left out because something covered them,
+//since the map was loaded. a band drawn counts its tiles again:
+typedef struct {
+	uint32_t frames;
+	uint32_t tilesDrawn;
+	uint32_t tilesCulled;
+} MageOcclusionStats;
+
+//a tile of a tileset, with everything drawChunkWithFlags needs to draw it
+//already looked up, see MageGameControl::compileRenderList:
+typedef struct {
+	//the image's address with the tile's offset in it already:
+	uint32_t address;
+	MageColorPalette *colorPalette;
+	const uint8_t *spans;
+	uint16_t width;
+	uint16_t height;
+	uint16_t pitch;
+	//for the collision geometry:
+	uint16_t tileId;
+	uint8_t tilesetId;
+	//its tiles are the size of the map's:
+	bool mapSized;
+} MageRenderTile;
+
+//one tile of a map layer in the render list:
+typedef struct {
+	//1 + which of the render tiles it is, 0 for none:
+	uint16_t tile;
+	uint8_t flags;
+	//there's a tile over it that covers it whole:
+	bool hidden;
+} MageRenderCell;
+
+//what the current map's render list cost:
+typedef struct {
+	//0 when the map didn't fit in MAGE_RENDER_LIST_BYTES:
+	uint32_t bytes;
+	uint32_t cells;
+	uint16_t tiles;
+	uint32_t microseconds;
+} MageRenderListStats;
+
 /*
 The MageGameControl object handles several important tasks. It's basically the
 core of the entire MAGE() game, and contains all the important variables that
@@ -99,6 +142,79 @@ private:
 	uint8_t filteredMapLocalEntityIds[MAX_ENTITIES_PER_MAP] = {0};
 	uint8_t mapLocalEntityIds[MAX_ENTITIES_PER_MAP] = {0};
 
+	//the map layers under the entities, already drawn, see DrawLayerCache.
+	//it covers whole tiles, a couple more than fit on the screen each way:
+	std::unique_ptr<uint16_t[]> layerCache;
+	uint32_t layerCacheSize = 0;
+	int32_t layerCacheWidth = 0;
+	int32_t layerCacheHeight = 0;
+	//which map tile is in the top left corner of the cache:
+	int32_t layerCacheCol = 0;
+	int32_t layerCacheRow = 0;
+	uint16_t layerCacheBackgroundColor = 0;
+	bool layerCacheValid = false;
+	//tiles from a tileset with a different tile size than the map can reach into
+	//the tiles next to them, so a map with those can't be drawn a few tiles at a time:
+	bool layerCacheUsable = true;
+
+	//how far down any tile can reach from the top of where it's drawn, so
+	//DrawMap knows which rows of tiles can reach into a band:
+	int32_t tallestTileHeight = 0;
+
+	//for every tile of the map, one more than the highest layer with a tile
+	//there that covers it whole, 0 for none. anything under that is hidden:
+	std::unique_ptr<uint8_t[]> occludingLayers;
+	uint32_t occludingLayersSize = 0;
+	//the map was too big for MAGE_OCCLUSION_BYTES, or culling is off:
+	bool occlusionBuilt = false;
+	bool occlusionCulling = true;
+	MageOcclusionStats occlusionStats = {};
+
+	//every different tile on the current map, and every tile of every layer
+	//of it, one layer after the other, so DrawMap doesn't have to look them
+	//up in ROM every frame:
+	std::unique_ptr<MageRenderTile[]> renderTiles;
+	uint32_t renderTilesSize = 0;
+	std::unique_ptr<MageRenderCell[]> renderCells;
+	uint32_t renderCellsSize = 0;
+	bool renderListBuilt = false;
+	bool renderListEnabled = true;
+	MageRenderListStats renderListStats = {};
+
+	//draws the tiles of one layer between firstCol, firstRow and lastCol, lastRow
+	//(inclusive, clamped to the map) with the camera at camera_x, camera_y:
+	void drawMapTiles(
+		uint8_t layer,
+		int32_t firstCol,
+		int32_t lastCol,
+		int32_t firstRow,
+		int32_t lastRow,
+		int32_t camera_x,
+		int32_t camera_y
+	);
+	//fills part of the layer cache, given in tiles relative to its top left corner:
+	void drawLayerCacheTiles(
+		int32_t firstCol,
+		int32_t lastCol,
+		int32_t firstRow,
+		int32_t lastRow
+	);
+
+	//builds the tile spans of as many tilesets as fit in MAGE_TILE_SPANS_BYTES,
+	//the ones entity animations use first:
+	void buildTileSpans();
+
+	//fills in occludingLayers for the current map, if it fits:
+	void buildOcclusion();
+
+	//looks up everything needed to draw one tile of a tileset:
+	void resolveRenderTile(uint8_t tilesetId, uint16_t tileId, MageRenderTile *tile);
+	//fills in the render list of the current map, if it fits:
+	void compileRenderList();
+	//whether the tile on layer at cell of the map has one over it that
+	//covers it whole:
+	bool tileHidden(uint8_t layer, uint32_t cell, bool mapSized, uint8_t flags) const;
+
 	//this handles script initialization when loading a new map
 	void initializeScriptsOnMapLoad();
 public:
@@ -149,6 +265,15 @@ public:
 	//this will return the current map object.
 	MageMap& Map();
 
+	//this will return the number of maps in the game.
+	uint16_t MapCount() const;
+
+	//this will return the number of tilesets in the game.
+	uint16_t TilesetCount() const;
+
+	//this will return the number of dialogs in the game.
+	uint16_t DialogCount() const;
+
 	//this will fill in an entity structure's data from ROM
 	MageEntity LoadEntity(uint32_t address);
 
@@ -177,6 +302,25 @@ public:
 	//this will render the map onto the screen.
 	void DrawMap(uint8_t layer);
 
+	//this draws the map layers that go under the entities onto the screen from
+	//the layer cache, only drawing the tiles that scrolled into view since the last frame.
+	//returns false without drawing anything if the cache can't be used for this frame,
+	//in which case those layers need to be drawn with DrawMap instead.
+	bool DrawLayerCache(uint16_t backgroundColor);
+
+	//this needs to be called whenever what the map looks like could have changed.
+	void invalidateLayerCache();
+
+	//whether DrawMap leaves out the tiles that are under one that covers them:
+	void setOcclusionCulling(bool enabled);
+	const MageOcclusionStats *getOcclusionStats() const;
+	void resetOcclusionStats();
+	void logOcclusionStats(const char *label) const;
+
+	//whether DrawMap draws from the render list, when the map fits in it:
+	void setRenderList(bool enabled);
+	const MageRenderListStats *getRenderListStats() const;
+
 	//the functions below will validate specific properties to see if they are valid.
 	//these are used to ensure that we don't get segfaults from using the hacked entity data.
 	uint16_t getValidMapId(uint16_t mapId);
@@ -6,46 +6,43 @@ extern FrameBuffer *mage_canvas;
 
 MageGeometry::MageGeometry(uint32_t address)
 {
+	//view the fixed size part of the geometry header straight out of ROM:
+	uint32_t headerLength = (
+		32 // name
+		+ sizeof(typeId)
+		+ sizeof(pointCount)
+		+ sizeof(segmentCount)
+		+ 1 // padding
+		+ sizeof(pathLength)
+	);
+	const uint8_t *header = EngineROM_View(address, headerLength);
 	//skip over name:
-	address += 32;
+	header += 32;
 	//read typeId:
-	EngineROM_Read(
-		address,
-		sizeof(typeId),
-		(uint8_t *)&typeId,
-		"Failed to load Geometry property 'typeId'"
-	);
-	address += sizeof(typeId);
+	memcpy(&typeId, header, sizeof(typeId));
+	header += sizeof(typeId);
 
 	//read pointCount:
-	EngineROM_Read(
-		address,
-		sizeof(pointCount),
-		(uint8_t *)&pointCount,
-		"Failed to load Geometry property 'pointCount'"
-	);
-	address += sizeof(pointCount);
+	memcpy(&pointCount, header, sizeof(pointCount));
+	header += sizeof(pointCount);
 
 	//read segmentCount:
-	EngineROM_Read(
-		address,
-		sizeof(segmentCount),
-		(uint8_t *)&segmentCount,
-		"Failed to load Geometry property 'segmentCount'"
-	);
-	address += sizeof(segmentCount);
+	memcpy(&segmentCount, header, sizeof(segmentCount));
+	header += sizeof(segmentCount);
 
-	address += 1; //padding
+	header += 1; //padding
 
 	//read pathLength:
-	EngineROM_Read(
+	memcpy(&pathLength, header, sizeof(pathLength));
+	pathLength = ROM_ENDIAN_F4_VALUE(pathLength);
+	address += headerLength;
+
+	//the points and segment lengths follow right after the header:
+	const uint8_t *data = EngineROM_View(
 		address,
-		sizeof(pathLength),
-		(uint8_t *)&pathLength,
-		"Failed to load Geometry property 'pathLength'"
+		(pointCount * sizeof(uint16_t) * 2)
+		+ (segmentCount * sizeof(float))
 	);
-	pathLength = ROM_ENDIAN_F4_VALUE(pathLength);
-	address += sizeof(pathLength);
 
 	//generate appropriately sized point array:
 	points = std::make_unique<Point[]>(pointCount);
@@ -55,23 +52,13 @@ MageGeometry::MageGeometry(uint32_t address)
 		uint16_t x;
 		uint16_t y;
 		//get x value:
-		EngineROM_Read(
-			address,
-			sizeof(x),
-			(uint8_t *)&x,
-			"Failed to load Geometry property 'x'"
-		);
+		memcpy(&x, data, sizeof(x));
 		x = ROM_ENDIAN_U2_VALUE(x);
-		address += sizeof(x);
+		data += sizeof(x);
 		//get y value:
-		EngineROM_Read(
-			address,
-			sizeof(y),
-			(uint8_t *)&y,
-			"Failed to load Geometry property 'x'"
-		);
+		memcpy(&y, data, sizeof(y));
 		y = ROM_ENDIAN_U2_VALUE(y);
-		address += sizeof(y);
+		data += sizeof(y);
 		//assign values:
 		points[i].x = x;
 		points[i].y = y;
@@ -80,11 +67,10 @@ MageGeometry::MageGeometry(uint32_t address)
 	//generate appropriately sized array:
 	segmentLengths = std::make_unique<float[]>(segmentCount);
 
-	EngineROM_Read(
-		address,
-		sizeof(float) * segmentCount,
-		(uint8_t *)segmentLengths.get(),
-		"Failed to load Geometry property 'x'"
+	memcpy(
+		segmentLengths.get(),
+		data,
+		sizeof(float) * segmentCount
 	);
 	ROM_ENDIAN_F4_BUFFER(segmentLengths.get(), segmentCount);
 
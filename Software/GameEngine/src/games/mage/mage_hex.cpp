@@ -5,6 +5,26 @@ extern MageGameControl *MageGame;
 extern MageDialogControl *MageDialog;
 extern MageEntity *hackableDataAddress;
 
+//every byte as the two hex digits the editor shows for it, put together
+//at compile time so nothing has to be formatted while drawing:
+typedef struct {
+	char strings[256][3];
+} MageHexByteStrings;
+
+static constexpr MageHexByteStrings buildHexByteStrings()
+{
+	const char digits[] = "0123456789ABCDEF";
+	MageHexByteStrings table = {};
+	for (uint16_t byte = 0; byte < 256; byte++) {
+		table.strings[byte][0] = digits[byte >> 4];
+		table.strings[byte][1] = digits[byte & 0x0f];
+		table.strings[byte][2] = 0;
+	}
+	return table;
+}
+
+static constexpr MageHexByteStrings hexByteStrings = buildHexByteStrings();
+
 uint32_t MageHexEditor::size() const
 {
 	uint32_t size = (
@@ -22,6 +42,13 @@ uint32_t MageHexEditor::size() const
 		sizeof(previousPageButtonState) +
 		sizeof(lastPageButtonPressTime) +
 		sizeof(isCopying) +
+		sizeof(shadowCells) +
+		sizeof(shadowHeader) +
+		sizeof(shadowFooter) +
+		sizeof(shadowFrameCount) +
+		sizeof(shadowValid) +
+		sizeof(redrawingAll) +
+		sizeof(incrementalRendering) +
 		sizeof(disableMovementUntilRJoyUpRelease)
 	);
 	return size;
@@ -44,6 +71,8 @@ uint16_t MageHexEditor::getMemoryAddress(uint8_t index)
 void MageHexEditor::toggleHexEditor()
 {
 	hexEditorState = !hexEditorState;
+	//whatever was drawn while it was closed is in the frame now:
+	shadowValid = false;
 	//set LED to the state 
 	ledSet(LED_HAX, hexEditorState ? 0xff : 0x00);
 }
@@ -123,7 +152,12 @@ uint16_t MageHexEditor::getCurrentMemPage()
 
 void MageHexEditor::updateHexStateVariables()
 {
-	bytesPerPage = dialogState ? 64 : 192;
+	uint8_t newBytesPerPage = dialogState ? HEXED_DEFAULT_BYTES_PER_PAGE : HEXED_MAX_BYTES_PER_PAGE;
+	if (newBytesPerPage != bytesPerPage) {
+		//the footer moves, so it all has to be drawn again:
+		shadowValid = false;
+	}
+	bytesPerPage = newBytesPerPage;
 	hexRows = ceil((0.0 + bytesPerPage) / (0.0 + HEXED_BYTES_PER_ROW));
 	memTotal = MageGame->filteredEntityCountOnThisMap * sizeof(MageEntity);
 	totalMemPages = ceil((0.0 + memTotal) / (0.0 + bytesPerPage));
@@ -315,7 +349,7 @@ void MageHexEditor::applyMemRecallInputs() {
 
 void MageHexEditor::getHexStringForByte (uint8_t byte, char* outputString)
 {
-	sprintf(outputString,"%02X", byte);
+	memcpy(outputString, hexByteStrings.strings[byte], 3);
 }
 
 uint16_t MageHexEditor::getRenderableStringLength(uint8_t *bytes, uint16_t maxLength) {
@@ -338,7 +372,7 @@ uint16_t MageHexEditor::getRenderableStringLength(uint8_t *bytes, uint16_t maxLe
 	return renderableLength;
 }
 
-void MageHexEditor::renderHexHeader()
+void MageHexEditor::renderHexHeader(bool redrawAll)
 {
 	char headerString[128];
 	char clipboardPreview[24];
@@ -346,23 +380,50 @@ void MageHexEditor::renderHexHeader()
 	uint8_t *currentByteAddress = (uint8_t *) hackableDataAddress + hexCursorLocation;
 	uint8_t u1Value = *currentByteAddress;
 	uint16_t u2Value = *(uint16_t *) ((currentByteAddress - (hexCursorLocation % 2)));
-	sprintf(
-		headerString,
-		"CurrentPage: %03u              CurrentByte: 0x%04X\n"
-			"TotalPages:  %03u   Entities: %05u    Mem: 0x%04X",
-		currentMemPage,
-		hexCursorLocation,
-		totalMemPages,
-		MageGame->filteredEntityCountOnThisMap,
-		memTotal
-	);
-	mage_canvas->printMessage(
-		headerString,
-		Monaco9,
-		0xffff,
-		HEXED_BYTE_OFFSET_X,
-		0
-	);
+	int32_t bandTop = mage_canvas->getBandTop();
+	int32_t bandBottom = mage_canvas->getBandBottom();
+	int32_t headerBottom = HEXED_BYTE_OFFSET_Y + HEXED_BYTE_CURSOR_OFFSET_Y;
+	int32_t footerTop = headerBottom + (HEXED_BYTE_HEIGHT * hexRows);
+	//each band only looks at the lines it has rows of, and they're on the
+	//screen once the band with their last row is, so the next frame compares
+	//against them from then on:
+	if (bandTop < headerBottom) {
+		sprintf(
+			headerString,
+			"CurrentPage: %03u              CurrentByte: 0x%04X\n"
+				"TotalPages:  %03u   Entities: %05u    Mem: 0x%04X",
+			currentMemPage,
+			hexCursorLocation,
+			totalMemPages,
+			MageGame->filteredEntityCountOnThisMap,
+			memTotal
+		);
+		if (redrawAll || strcmp(headerString, shadowHeader) != 0) {
+			if (!redrawAll) {
+				//everything above the bytes:
+				mage_canvas->fillRect(
+					0,
+					0,
+					WIDTH,
+					headerBottom,
+					RGB(0,0,0)
+				);
+			}
+			mage_canvas->printMessage(
+				headerString,
+				Monaco9,
+				0xffff,
+				HEXED_BYTE_OFFSET_X,
+				0
+			);
+			if (bandBottom >= headerBottom) {
+				strcpy(shadowHeader, headerString);
+			}
+		}
+	}
+	if (bandBottom <= footerTop) {
+		return;
+	}
 	memcpy(
 		stringPreview,
 		(uint8_t *) hackableDataAddress + hexCursorLocation,
@@ -394,10 +455,9 @@ void MageHexEditor::renderHexHeader()
 			MageGame->currentSave.clipboardLength
 		);
 		for (uint8_t i = 0; i < clipboardPreviewClamp; i++) {
-			sprintf(
-				clipboardPreview + (i * 2),
-				"%02X",
-				*(MageGame->currentSave.clipboard + i)
+			getHexStringForByte(
+				*(MageGame->currentSave.clipboard + i),
+				clipboardPreview + (i * 2)
 			);
 		}
 		if(MageGame->currentSave.clipboardLength > HEXED_CLIPBOARD_PREVIEW_LENGTH) {
@@ -412,77 +472,168 @@ void MageHexEditor::renderHexHeader()
 			clipboardPreview
 		);
 	}
-	mage_canvas->printMessage(
-		headerString,
-		Monaco9,
-		0xffff,
-		HEXED_BYTE_OFFSET_X,
-		HEXED_BYTE_FOOTER_OFFSET_Y + (HEXED_BYTE_HEIGHT * (hexRows + 2))
-	);
-}
-
-void MageHexEditor::renderHexEditor()
-{
-	char currentByteString[2];
-	if ((hexCursorLocation / bytesPerPage) == currentMemPage)
-	{
-		mage_canvas->fillRect(
-			(hexCursorLocation % bytesPerPage % HEXED_BYTES_PER_ROW) * HEXED_BYTE_WIDTH + HEXED_BYTE_OFFSET_X + HEXED_BYTE_CURSOR_OFFSET_X,
-			(hexCursorLocation % bytesPerPage / HEXED_BYTES_PER_ROW) * HEXED_BYTE_HEIGHT + HEXED_BYTE_OFFSET_Y + HEXED_BYTE_CURSOR_OFFSET_Y,
-			HEXED_BYTE_WIDTH,
-			HEXED_BYTE_HEIGHT,
-			0x38FF
+	if (redrawAll || strcmp(headerString, shadowFooter) != 0) {
+		if (!redrawAll) {
+			//everything below the bytes:
+			mage_canvas->fillRect(
+				0,
+				footerTop,
+				WIDTH,
+				HEIGHT - footerTop,
+				RGB(0,0,0)
+			);
+		}
+		mage_canvas->printMessage(
+			headerString,
+			Monaco9,
+			0xffff,
+			HEXED_BYTE_OFFSET_X,
+			HEXED_BYTE_FOOTER_OFFSET_Y + (HEXED_BYTE_HEIGHT * (hexRows + 2))
 		);
-		if (isCopying) {
-			for (uint8_t i = 1; i < MageGame->currentSave.clipboardLength; i++) {
-				uint16_t copyCursorOffset = (hexCursorLocation + i) % bytesPerPage;
-				mage_canvas->fillRect(
-					(copyCursorOffset % HEXED_BYTES_PER_ROW) * HEXED_BYTE_WIDTH + HEXED_BYTE_OFFSET_X + HEXED_BYTE_CURSOR_OFFSET_X,
-					(copyCursorOffset / HEXED_BYTES_PER_ROW) * HEXED_BYTE_HEIGHT + HEXED_BYTE_OFFSET_Y + HEXED_BYTE_CURSOR_OFFSET_Y,
-					HEXED_BYTE_WIDTH,
-					HEXED_BYTE_HEIGHT,
-					0x00EE
-				);
-			}
+		if (bandBottom == HEIGHT) {
+			strcpy(shadowFooter, headerString);
 		}
 	}
-	renderHexHeader();
-	for(
-		uint16_t i = 0;
-		(
-			i < bytesPerPage
-			&& (i + (currentMemPage * bytesPerPage)) < memTotal
-		);
-		i++
-	)
-	{
-		getHexStringForByte(
-			*(((uint8_t *) hackableDataAddress) + (i + (currentMemPage * bytesPerPage))),
-			currentByteString
-		);
+}
 
+MageHexCell MageHexEditor::getCell(uint16_t i)
+{
+	uint32_t address = i + (currentMemPage * bytesPerPage);
+	MageHexCell cell = {HEXED_CELL_EMPTY, 0xffff, RGB(0,0,0)};
+	if (address < memTotal) {
+		cell.value = *(((uint8_t *) hackableDataAddress) + address);
 		//this bit will color the playerEntity differently than the other entities in the hex editor:
-		uint32_t font_color = 0xffff;
 		if(MageGame->playerEntityIndex != NO_PLAYER)
 		{
 			if(
-				( (uint32_t)(i + (currentMemPage * bytesPerPage)) >= (MageGame->playerEntityIndex * sizeof(MageEntity)) ) &&
-				( (uint32_t)(i + (currentMemPage * bytesPerPage)) <  ((MageGame->playerEntityIndex+1) * sizeof(MageEntity)) )
+				( address >= (MageGame->playerEntityIndex * sizeof(MageEntity)) ) &&
+				( address <  ((MageGame->playerEntityIndex+1) * sizeof(MageEntity)) )
 			)
 			{
-				font_color = 0xfc10;
+				cell.textColor = 0xfc10;
 			}
 		}
+	}
+	if ((hexCursorLocation / bytesPerPage) == currentMemPage)
+	{
+		uint16_t cursorOffset = hexCursorLocation % bytesPerPage;
+		if (i == cursorOffset) {
+			cell.backgroundColor = 0x38FF;
+		}
+		//the bytes after the cursor that will be copied, wrapping around to the
+		//top of the page. a clipboard longer than the page covers the cursor too:
+		uint16_t copyOffset = (i + bytesPerPage - cursorOffset) % bytesPerPage;
+		if (
+			isCopying
+			&& (copyOffset ? copyOffset : bytesPerPage) < MageGame->currentSave.clipboardLength
+		) {
+			cell.backgroundColor = 0x00EE;
+		}
+	}
+	return cell;
+}
 
-		//print the byte:
-		mage_canvas->printMessage(
-			currentByteString,
-			Monaco9,
-			font_color,
-			(i % HEXED_BYTES_PER_ROW) * HEXED_BYTE_WIDTH + HEXED_BYTE_OFFSET_X,
-			(i / HEXED_BYTES_PER_ROW) * HEXED_BYTE_HEIGHT + HEXED_BYTE_OFFSET_Y
+void MageHexEditor::renderHexEditor()
+{
+	//renderBands calls this once for every band, top to bottom, and only
+	//the first one decides if the last frame can be drawn over. it can when
+	//it's still on the screen, all of it:
+	uint32_t frameCount = mage_canvas->getFrameCount();
+	int32_t bandTop = mage_canvas->getBandTop();
+	int32_t bandBottom = mage_canvas->getBandBottom();
+	if (bandTop == 0)
+	{
+		redrawingAll = (
+			!incrementalRendering
+			|| !shadowValid
+			|| frameCount != shadowFrameCount + 1
 		);
+		//the shadow is half this frame and half the last until it's done:
+		shadowValid = false;
+	}
+	bool redrawAll = redrawingAll;
+	if (redrawAll)
+	{
+		mage_canvas->clearScreen(RGB(0,0,0));
+	}
+	renderHexHeader(redrawAll);
+	for (uint16_t rowStart = 0; rowStart < bytesPerPage; rowStart += HEXED_BYTES_PER_ROW)
+	{
+		int32_t y = (rowStart / HEXED_BYTES_PER_ROW) * HEXED_BYTE_HEIGHT + HEXED_BYTE_OFFSET_Y;
+		int32_t rowTop = y + HEXED_BYTE_CURSOR_OFFSET_Y;
+		if (rowTop + HEXED_BYTE_HEIGHT <= bandTop || rowTop >= bandBottom)
+		{
+			continue;
+		}
+		//a band is sent from the leftmost pixel drawn in each row to the
+		//rightmost one, and its buffer doesn't have the last frame in it, so
+		//every cell between the first and last one that changed is drawn:
+		MageHexCell cells[HEXED_BYTES_PER_ROW];
+		uint16_t rowLength = MIN(HEXED_BYTES_PER_ROW, bytesPerPage - rowStart);
+		int16_t first = redrawAll ? 0 : -1;
+		int16_t last = redrawAll ? rowLength - 1 : -1;
+		for (uint16_t column = 0; column < rowLength; column++)
+		{
+			cells[column] = getCell(rowStart + column);
+			const MageHexCell &shadow = shadowCells[rowStart + column];
+			if (
+				!redrawAll
+				&& (
+					cells[column].value != shadow.value
+					|| cells[column].textColor != shadow.textColor
+					|| cells[column].backgroundColor != shadow.backgroundColor
+				)
+			) {
+				if (first == -1)
+				{
+					first = column;
+				}
+				last = column;
+			}
+		}
+		for (int16_t column = MAX(first, 0); column <= last; column++)
+		{
+			const MageHexCell &cell = cells[column];
+			int32_t x = column * HEXED_BYTE_WIDTH + HEXED_BYTE_OFFSET_X;
+			//the byte's text is inside of its cell, so the cell covers the old one:
+			if (!redrawAll || cell.backgroundColor != RGB(0,0,0))
+			{
+				mage_canvas->fillRect(
+					x + HEXED_BYTE_CURSOR_OFFSET_X,
+					rowTop,
+					HEXED_BYTE_WIDTH,
+					HEXED_BYTE_HEIGHT,
+					cell.backgroundColor
+				);
+			}
+			//print the byte:
+			if (cell.value != HEXED_CELL_EMPTY)
+			{
+				mage_canvas->printMessage(
+					hexByteStrings.strings[cell.value],
+					Monaco9,
+					cell.textColor,
+					x,
+					y
+				);
+			}
+		}
+		//the cells are on the screen once the band with their last row is:
+		if (rowTop + HEXED_BYTE_HEIGHT <= bandBottom)
+		{
+			memcpy(&shadowCells[rowStart], cells, rowLength * sizeof(MageHexCell));
+		}
 	}
+	if (bandBottom == HEIGHT)
+	{
+		shadowFrameCount = frameCount;
+		shadowValid = true;
+	}
+}
+
+void MageHexEditor::setIncrementalRendering(bool enabled)
+{
+	incrementalRendering = enabled;
 }
 
 void MageHexEditor::runHex(uint8_t value)
@@ -23,6 +23,7 @@ This class contains all the code related to the hex editor hacking interface.
 #define HEXED_BYTE_CURSOR_OFFSET_X -4
 #define HEXED_BYTE_CURSOR_OFFSET_Y 5
 #define HEXED_DEFAULT_BYTES_PER_PAGE 64
+#define HEXED_MAX_BYTES_PER_PAGE 192
 #define HEXED_CLIPBOARD_PREVIEW_LENGTH 6
 
 //have to have two values since millis() doesn't work right for 801_DESKTOP:
@@ -34,6 +35,17 @@ This class contains all the code related to the hex editor hacking interface.
 #define HEXED_QUICK_PRESS_TIMEOUT 500
 #define HEXED_TICK_DELAY 1
 #endif
+//a cell past the end of memory, with no byte in it:
+#define HEXED_CELL_EMPTY 0x100
+
+//what one byte's cell on the page looks like, see MageHexEditor::renderHexEditor:
+typedef struct {
+	//the byte, or HEXED_CELL_EMPTY:
+	uint16_t value;
+	uint16_t textColor;
+	uint16_t backgroundColor;
+} MageHexCell;
+
 enum HEX_OPS {
 	HEX_OPS_XOR,
 	HEX_OPS_ADD,
@@ -86,6 +98,22 @@ private:
 	//clipboard GUI state
 	bool isCopying;
 
+	//what the frame showed after the last renderHexEditor, so the next one
+	//only has to draw the cells, header and footer that changed since:
+	MageHexCell shadowCells[HEXED_MAX_BYTES_PER_PAGE];
+	char shadowHeader[128];
+	char shadowFooter[128];
+	//the frame they were drawn in, see FrameBuffer::getFrameCount, and
+	//whether all of its bands were, so the next can draw over it:
+	uint32_t shadowFrameCount;
+	bool shadowValid;
+	//whether the frame whose bands are being drawn is drawn whole:
+	bool redrawingAll;
+	bool incrementalRendering;
+
+	//how the cell of byte i of the page should look right now:
+	MageHexCell getCell(uint16_t i);
+
 public:
 	bool disableMovementUntilRJoyUpRelease;
 
@@ -105,6 +133,13 @@ public:
 		previousPageButtonState{false},
 		lastPageButtonPressTime{0},
 		isCopying{false},
+		shadowCells{},
+		shadowHeader{},
+		shadowFooter{},
+		shadowFrameCount{0},
+		shadowValid{false},
+		redrawingAll{true},
+		incrementalRendering{true},
 		disableMovementUntilRJoyUpRelease{false}
 	{};
 
@@ -157,12 +192,19 @@ public:
 	//Some byte values are renderable. Some are not. Get length of what our font renderer can display.
 	uint16_t getRenderableStringLength(uint8_t *string, uint16_t maxLength);
 
-	//this writes the header bit of the hex editor screen.
-	void renderHexHeader();
+	//this writes the header bit of the hex editor screen that's in the band.
+	//unless redrawAll, only the lines that changed since the last frame.
+	void renderHexHeader(bool redrawAll);
 
-	//this writes all the hex editor data to the screen.
+	//this writes all the hex editor data in the band to the screen.
+	//when the screen still has the last frame on it, only what changed since
+	//gets drawn, so an idle hex editor hardly draws or sends anything.
 	void renderHexEditor();
 
+	//false makes every frame get drawn whole, the way it was before only
+	//what changed was drawn, so tests can compare and time both. on by default.
+	void setIncrementalRendering(bool enabled);
+
 	//this applies input to the current byte value based on the state of currentOp.
 	void runHex(uint8_t value);
 
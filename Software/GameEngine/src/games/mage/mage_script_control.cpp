@@ -1,6 +1,7 @@
 #include "mage_script_control.h"
 #include "mage_dialog_control.h"
 #include "EngineROM.h"
+#include "EngineSaveLog.h"
 #include "EnginePanic.h"
 #include "EngineInput.h"
 
@@ -1903,13 +1904,20 @@ void MageScriptControl::slotSave(uint8_t * args, MageScriptState * resumeStateSt
 	// their board to get out of that dialog lock. Better to protect the player
 	// with an annoying confirm dialog than allowing them to quietly burn through
 	// the ROM chip's 10000 write cycles.
+	// The save itself happens in the background while the game keeps running,
+	// this script just waits for it (SLOT_SAVE_WAITING_FOR_ROM) before
+	// showing that dialog (SLOT_SAVE_WAITING_FOR_DIALOG).
 	if(resumeStateStruct->totalLoopsToNextAction == 0) {
 		MageGame->saveGameSlotSave();
-		//debug_print("Opening dialog %d\n", argStruct->dialogId);
-		MageDialog->showSaveMessageDialog(
-			std::string("Save complete.")
-		);
-		resumeStateStruct->totalLoopsToNextAction = 1;
+		resumeStateStruct->totalLoopsToNextAction = SLOT_SAVE_WAITING_FOR_ROM;
+	} else if (resumeStateStruct->totalLoopsToNextAction == SLOT_SAVE_WAITING_FOR_ROM) {
+		if(!EngineSaveLog_IsBusy()) {
+			//debug_print("Opening dialog %d\n", argStruct->dialogId);
+			MageDialog->showSaveMessageDialog(
+				std::string("Save complete.")
+			);
+			resumeStateStruct->totalLoopsToNextAction = SLOT_SAVE_WAITING_FOR_DIALOG;
+		}
 	} else if (!MageDialog->isOpen) {
 		resumeStateStruct->totalLoopsToNextAction = 0;
 	}
@@ -1940,16 +1948,33 @@ void MageScriptControl::slotErase(uint8_t * args, MageScriptState * resumeStateS
 	// the ROM chip's 10000 write cycles.
 	if(resumeStateStruct->totalLoopsToNextAction == 0) {
 		MageGame->saveGameSlotErase(argStruct->slotIndex);
-		//debug_print("Opening dialog %d\n", argStruct->dialogId);
-		MageDialog->showSaveMessageDialog(
-			std::string("Save erased.")
-		);
-		resumeStateStruct->totalLoopsToNextAction = 1;
+		resumeStateStruct->totalLoopsToNextAction = SLOT_SAVE_WAITING_FOR_ROM;
+	} else if (resumeStateStruct->totalLoopsToNextAction == SLOT_SAVE_WAITING_FOR_ROM) {
+		if(!EngineSaveLog_IsBusy()) {
+			//debug_print("Opening dialog %d\n", argStruct->dialogId);
+			MageDialog->showSaveMessageDialog(
+				std::string("Save erased.")
+			);
+			resumeStateStruct->totalLoopsToNextAction = SLOT_SAVE_WAITING_FOR_DIALOG;
+		}
 	} else if (!MageDialog->isOpen) {
 		resumeStateStruct->totalLoopsToNextAction = 0;
 	}
 }
 
+void MageScriptControl::checkSaveInProgress(uint8_t * args, MageScriptState * resumeStateStruct)
+{
+	ActionCheckSaveInProgress *argStruct = (ActionCheckSaveInProgress*)args;
+	//endianness conversion for arguments larger than 1 byte:
+	argStruct->successScriptId = ROM_ENDIAN_U2_VALUE(argStruct->successScriptId);
+
+	if(EngineSaveLog_IsBusy() == (bool)(argStruct->expectedBoolValue))
+	{
+		//convert mapLocalScriptId from local to global scope and assign to mapLocalJumpScript:
+		mapLocalJumpScript = argStruct->successScriptId;
+	}
+}
+
 MageScriptControl::MageScriptControl()
 {
 	mapLocalJumpScript = MAGE_NO_SCRIPT;
@@ -2061,6 +2086,7 @@ MageScriptControl::MageScriptControl()
 	actionFunctions[MageScriptActionTypeId::SLOT_SAVE] = &MageScriptControl::slotSave;
 	actionFunctions[MageScriptActionTypeId::SLOT_LOAD] = &MageScriptControl::slotLoad;
 	actionFunctions[MageScriptActionTypeId::SLOT_ERASE] = &MageScriptControl::slotErase;
+	actionFunctions[MageScriptActionTypeId::CHECK_SAVE_IN_PROGRESS] = &MageScriptControl::checkSaveInProgress;
 }
 
 uint32_t MageScriptControl::size() const
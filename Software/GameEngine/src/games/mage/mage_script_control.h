@@ -11,6 +11,10 @@ This class contains all the code related to the hex editor hacking interface.
 
 #define SCRIPT_NAME_LENGTH 32
 
+//values of totalLoopsToNextAction while SLOT_SAVE or SLOT_ERASE are waiting:
+#define SLOT_SAVE_WAITING_FOR_DIALOG 1
+#define SLOT_SAVE_WAITING_FOR_ROM 2
+
 //this is a class designed to handle all the scripting for the MAGE() game
 //it is designed to work in tandem with a MageGameControl object and a
 //MageHex object to effect that state of the game.
@@ -246,6 +250,8 @@ class MageScriptControl
 		void slotLoad(uint8_t * args, MageScriptState * resumeStateStruct);
 		//Action Logic Type: I
 		void slotErase(uint8_t * args, MageScriptState * resumeStateStruct);
+		//Action Logic Type: I+C
+		void checkSaveInProgress(uint8_t * args, MageScriptState * resumeStateStruct);
 	public:
 		//this is a global that holds the amount of millis that a blocking delay will
 		//prevent the main loop from continuing for. It is set by the blockingDelay() action.
@@ -5,6 +5,7 @@
 MageTileset::MageTileset(uint8_t index, uint32_t address)
 {
 	offset = address;
+	spansLength = 0;
 	#ifdef DC801_DESKTOP
 	EngineROM_Read(
 		offset,
@@ -145,7 +146,9 @@ uint32_t MageTileset::Size() const {
 		sizeof(tileWidth) +
 		sizeof(tileHeight) +
 		sizeof(cols) +
-		sizeof(rows)
+		sizeof(rows) +
+		(spans ? spansLength + (Tiles() * sizeof(uint32_t)) : 0) +
+		(opaqueTiles ? (Tiles() + 7) / 8 : 0)
 	);
 }
 
@@ -161,15 +164,153 @@ bool MageTileset::Valid() const
 	return true;
 }
 
+void MageTileset::BuildOpacity(
+	uint32_t imageAddress,
+	const MageColorPalette *colorPalette
+) {
+	uint16_t tiles = Tiles();
+	uint16_t transparentColor = SCREEN_ENDIAN_U2_VALUE(TRANSPARENCY_COLOR);
+	opaqueTiles = std::make_unique<uint8_t[]>((tiles + 7) / 8);
+	for (uint16_t tileId = 0; tileId < tiles; tileId++) {
+		//every pixel of it is in a span, if there's anything to be transparent:
+		uint32_t opaquePixels = 0;
+		if (!colorPalette->opaque) {
+			EngineTileSpans_Build(
+				TilePixels(imageAddress, colorPalette, tileId),
+				colorPalette->packed(),
+				colorPalette->colors.get(),
+				tileWidth,
+				tileHeight,
+				transparentColor,
+				NULL,
+				&opaquePixels
+			);
+		}
+		if (colorPalette->opaque || opaquePixels == (uint32_t)(tileWidth * tileHeight)) {
+			opaqueTiles[tileId / 8] |= 1 << (tileId % 8);
+		}
+	}
+}
+
+uint32_t MageTileset::TileAddress(
+	uint32_t imageAddress,
+	const MageColorPalette *colorPalette,
+	uint16_t tileId
+) const
+{
+	return imageAddress + EngineImage_Offset(
+		((tileId / cols) * tileHeight * imageWidth)
+			+ ((tileId % cols) * tileWidth),
+		colorPalette->packed()
+	);
+}
+
+const uint8_t *MageTileset::TilePixels(
+	uint32_t imageAddress,
+	const MageColorPalette *colorPalette,
+	uint16_t tileId
+) const
+{
+	return EngineROM_View(
+		TileAddress(imageAddress, colorPalette, tileId),
+		EngineImage_Bytes(tileWidth * tileHeight, colorPalette->packed())
+	);
+}
+
+bool MageTileset::TileOpaque(uint16_t tileId) const
+{
+	if (!opaqueTiles || tileId >= Tiles()) {
+		return false;
+	}
+	return (opaqueTiles[tileId / 8] >> (tileId % 8)) & 1;
+}
+
 uint16_t MageTileset::getLocalGeometryIdByTileIndex(uint16_t tileIndex) const
 {
 	uint16_t globalGeometryId = 0;
-	EngineROM_Read(
-		offset + tileIndex * sizeof(globalGeometryId),
-		sizeof(globalGeometryId),
-		(uint8_t *)&globalGeometryId,
-		"Failed to load MageTileset property 'globalGeometryIds'"
+	memcpy(
+		&globalGeometryId,
+		EngineROM_View(
+			offset + tileIndex * sizeof(globalGeometryId),
+			sizeof(globalGeometryId)
+		),
+		sizeof(globalGeometryId)
 	);
 	globalGeometryId = ROM_ENDIAN_U2_VALUE(globalGeometryId);
 	return globalGeometryId;
 }
+
+uint32_t MageTileset::BuildSpans(
+	uint32_t imageAddress,
+	const MageColorPalette *colorPalette,
+	uint32_t maxBytes
+) {
+	//nothing to skip if nothing can be transparent:
+	if (colorPalette->opaque || tileWidth > ENGINE_TILE_SPANS_MAX_WIDTH) {
+		return 0;
+	}
+	uint16_t tiles = Tiles();
+	uint16_t transparentColor = SCREEN_ENDIAN_U2_VALUE(TRANSPARENCY_COLOR);
+	uint32_t tilePixels = tileWidth * tileHeight;
+	uint32_t length = 0;
+	uint16_t tilesWithSpans = 0;
+	std::unique_ptr<uint32_t[]> offsets = std::make_unique<uint32_t[]>(tiles);
+	for (uint16_t tileId = 0; tileId < tiles; tileId++) {
+		uint32_t opaquePixels = 0;
+		uint32_t tileLength = EngineTileSpans_Build(
+			TilePixels(imageAddress, colorPalette, tileId),
+			colorPalette->packed(),
+			colorPalette->colors.get(),
+			tileWidth,
+			tileHeight,
+			transparentColor,
+			NULL,
+			&opaquePixels
+		);
+		//walking the spans of a tile costs more than it saves
+		//unless at least half of the tile gets skipped:
+		if (opaquePixels * 2 > tilePixels) {
+			offsets[tileId] = MAGE_TILE_NO_SPANS;
+			continue;
+		}
+		offsets[tileId] = length;
+		length += tileLength;
+		tilesWithSpans++;
+	}
+	uint32_t bytes = length + (tiles * sizeof(uint32_t));
+	if (tilesWithSpans == 0 || bytes > maxBytes) {
+		return 0;
+	}
+	spans = std::make_unique<uint8_t[]>(length);
+	tileSpanOffsets = std::move(offsets);
+	spansLength = length;
+	for (uint16_t tileId = 0; tileId < tiles; tileId++) {
+		if (tileSpanOffsets[tileId] == MAGE_TILE_NO_SPANS) {
+			continue;
+		}
+		EngineTileSpans_Build(
+			TilePixels(imageAddress, colorPalette, tileId),
+			colorPalette->packed(),
+			colorPalette->colors.get(),
+			tileWidth,
+			tileHeight,
+			transparentColor,
+			spans.get() + tileSpanOffsets[tileId],
+			NULL
+		);
+	}
+	return bytes;
+}
+
+bool MageTileset::HasSpans() const
+{
+	return spans != nullptr;
+}
+
+const uint8_t *MageTileset::TileSpans(uint16_t tileId) const
+{
+	if (!spans || tileId >= Tiles() || tileSpanOffsets[tileId] == MAGE_TILE_NO_SPANS) {
+		return NULL;
+	}
+	return spans.get() + tileSpanOffsets[tileId];
+}
@@ -9,6 +9,8 @@ in a more accessible way.
 #include "mage_defines.h"
 
 #define TILESET_NAME_SIZE 16
+//the tileSpanOffsets entry of a tile without spans:
+#define MAGE_TILE_NO_SPANS UINT32_MAX
 
 class MageTileset
 {
@@ -24,6 +26,14 @@ private:
 	uint16_t tileHeight;
 	uint16_t cols;
 	uint16_t rows;
+	//the EngineTileSpans of every tile one after the other, if they were built:
+	std::unique_ptr<uint8_t[]> spans;
+	//where the spans of each tile start in spans, or MAGE_TILE_NO_SPANS
+	//for the tiles that are drawn faster without them:
+	std::unique_ptr<uint32_t[]> tileSpanOffsets;
+	uint32_t spansLength;
+	//one bit for every tile, set when none of its pixels are transparent:
+	std::unique_ptr<uint8_t[]> opaqueTiles;
 
 public:
 
@@ -38,7 +48,8 @@ public:
 		tileWidth{0},
 		tileHeight{0},
 		cols{0},
-		rows{0}
+		rows{0},
+		spansLength{0}
 { };
 
 	MageTileset(uint8_t index, uint32_t address);
@@ -53,6 +64,41 @@ public:
 	uint32_t Size() const;
 	bool Valid() const;
 
+	//works out the spans of every tile that's at least half transparent,
+	//as long as they fit in maxBytes along with their offsets.
+	//returns how many bytes that took, or 0 if it didn't build any.
+	uint32_t BuildSpans(
+		uint32_t imageAddress,
+		const MageColorPalette *colorPalette,
+		uint32_t maxBytes
+	);
+	//the spans of one tile, or NULL if it doesn't have any:
+	const uint8_t *TileSpans(uint16_t tileId) const;
+	bool HasSpans() const;
+
+	//works out which tiles don't have a single transparent pixel,
+	//so what's under them on the map doesn't need drawing:
+	void BuildOpacity(
+		uint32_t imageAddress,
+		const MageColorPalette *colorPalette
+	);
+	//whether a tile covers all of its TileWidth * TileHeight,
+	//false if BuildOpacity hasn't been called:
+	bool TileOpaque(uint16_t tileId) const;
+
+	//where a tile's pixels start in ROM, the same way
+	//drawChunkWithFlags works it out:
+	uint32_t TileAddress(
+		uint32_t imageAddress,
+		const MageColorPalette *colorPalette,
+		uint16_t tileId
+	) const;
+	const uint8_t *TilePixels(
+		uint32_t imageAddress,
+		const MageColorPalette *colorPalette,
+		uint16_t tileId
+	) const;
+
 	uint16_t getLocalGeometryIdByTileIndex(uint16_t tileIndex) const;
 }; //class MageTileset
 
@@ -26,6 +26,7 @@ QSPI qspiControl;
 
 #ifdef DC801_DESKTOP
 #include <time.h>
+#include "EngineWindowFrame.h"
 volatile sig_atomic_t application_quit = 0;
 
 void sig_handler(int signo)
@@ -165,8 +166,10 @@ int main(void){
 	// printf goes to the RTT_Terminal.log after you've fired up debug.sh
 
 #if defined(TEST) || defined(TEST_ALL)
+	#ifdef DC801_DESKTOP
+		EngineWindowFrameInit();
+	#endif
 	DC801_Test::Test();
-	break;
 #else
 	MAGE();
 #endif
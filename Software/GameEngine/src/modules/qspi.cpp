@@ -24,7 +24,7 @@ void QSPI::qspi_handler(nrf_drv_qspi_evt_t event, void * p_context){
  * Constructor for the QSPI driver class
  */
 QSPI::QSPI(){
-	ready = false;
+	ready = true;
 	this->initialized = false;
 }
 
@@ -42,7 +42,9 @@ bool QSPI::init(){
 	nrfx_err_t errCode;
 	nrfx_qspi_config_t config = NRFX_QSPI_DEFAULT_CONFIG;
 
-	errCode = nrfx_qspi_init(&config, NULL, NULL);
+	// with a handler every read, write and erase returns as soon as it has
+	// started, and qspi_handler says when it's done
+	errCode = nrfx_qspi_init(&config, qspi_handler, NULL);
 	if(errCode != NRFX_SUCCESS){
 		debug_print("Failure at nrfx_qspi_init() call.");
 		return false;
@@ -148,10 +150,20 @@ void QSPI::uninit(){
 }
 
 /**
- * @return true if the qspi device is idle
+ * Wait for the read, write or erase started last to finish
+ */
+void QSPI::waitReady(){
+	while(!ready){
+		// is very busy
+	}
+}
+
+/**
+ * Reads the Write In Progress bit from the chip's status register
+ * @return true while the chip is still programming or erasing
  */
 bool QSPI::isBusy(){
-	return ready;
+	return nrfx_qspi_mem_busy_check() == NRFX_ERROR_BUSY;
 }
 
 /**
@@ -168,6 +180,7 @@ bool QSPI::erase(tBlockSize blockSize, uint32_t startAddress){
 		return false;
 	}
 
+	ready = false;
 	switch(blockSize){
 		// disabled because it does nothing on our hardware
 		// case BLOCK_SIZE_4K:
@@ -185,17 +198,111 @@ bool QSPI::erase(tBlockSize blockSize, uint32_t startAddress){
 			errCode = nrfx_qspi_chip_erase();
 			break;
 		default:
+			ready = true;
 			return false;
 	}
 
 	if(errCode == NRFX_SUCCESS){
+		waitReady();
 		return true;
 	}
 
+	ready = true;
 	return false;
 
 }
 
+/**
+ * Start erasing a 256KB block without waiting for it to finish.
+ * Nothing can be read from the chip while it is erasing (and the XIP
+ * window reads from the chip), so you almost certainly want to
+ * eraseSuspend() right after this, and eraseResume() it when you can
+ * spare the time. Check isBusy() to see if it's done.
+ * @param startAddress Address of the block to erase
+ * @return True if the erase command was sent
+ */
+bool QSPI::eraseStart(uint32_t startAddress){
+
+	if(!this->initialized){
+		return false;
+	}
+
+	// 4 byte address, because init() turned on extended addressing
+	uint8_t address[4] = {
+		(uint8_t)(startAddress >> 24),
+		(uint8_t)(startAddress >> 16),
+		(uint8_t)(startAddress >> 8),
+		(uint8_t)(startAddress)
+	};
+	nrf_qspi_cinstr_conf_t cinstr_cfg = {
+		.opcode    = 0xD8, // Sector Erase, which is 256KB on our chip
+		.length    = NRF_QSPI_CINSTR_LEN_5B,
+		.io2_level = true,
+		.io3_level = true,
+		.wipwait   = false,
+		.wren      = true
+	};
+
+	if(nrfx_qspi_cinstr_xfer(&cinstr_cfg, &address, NULL) == NRFX_SUCCESS){
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Pause an erase started with eraseStart(), so the chip can be read again.
+ * Returns once the chip has actually stopped (Write In Progress is clear).
+ * @return True on success
+ */
+bool QSPI::eraseSuspend(){
+
+	if(!this->initialized){
+		return false;
+	}
+
+	nrf_qspi_cinstr_conf_t cinstr_cfg = {
+		.opcode    = 0x75, // Erase Suspend
+		.length    = NRF_QSPI_CINSTR_LEN_1B,
+		.io2_level = true,
+		.io3_level = true,
+		.wipwait   = true,
+		.wren      = false
+	};
+
+	if(nrfx_qspi_cinstr_xfer(&cinstr_cfg, NULL, NULL) == NRFX_SUCCESS){
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Carry on with an erase paused by eraseSuspend(), without waiting for it.
+ * @return True on success
+ */
+bool QSPI::eraseResume(){
+
+	if(!this->initialized){
+		return false;
+	}
+
+	nrf_qspi_cinstr_conf_t cinstr_cfg = {
+		.opcode    = 0x7A, // Erase Resume
+		.length    = NRF_QSPI_CINSTR_LEN_1B,
+		.io2_level = true,
+		.io3_level = true,
+		.wipwait   = false,
+		.wren      = false
+	};
+
+	if(nrfx_qspi_cinstr_xfer(&cinstr_cfg, NULL, NULL) == NRFX_SUCCESS){
+		return true;
+	}
+
+	return false;
+}
+
 /**
  * Erase the whole chip
  * @return True on success
@@ -206,10 +313,13 @@ bool QSPI::chipErase(){
 		return false;
 	}
 
+	ready = false;
 	if(nrfx_qspi_chip_erase() == NRFX_SUCCESS){
+		waitReady();
 		return true;
 	}
 
+	ready = true;
 	return false;
 
 }
@@ -221,14 +331,35 @@ bool QSPI::chipErase(){
  */
 bool QSPI::write(void const *data, size_t len, uint32_t startAddress){
 
+	if(!writeStart(data, len, startAddress)){
+		return false;
+	}
+
+	waitReady();
+	return true;
+}
+
+/**
+ * Start writing some data out to the qspi device without waiting for the
+ * chip to program it, so the CPU can get on with something else that
+ * doesn't touch the chip. waitReady() before the next read, write or erase,
+ * and leave data alone until then, it's still being sent from.
+ * @param data A pointer to an array of data to write out
+ * @param len Number of bytes to send, must be uint32_t aligned
+ * @return True if the write was started
+ */
+bool QSPI::writeStart(void const *data, size_t len, uint32_t startAddress){
+
 	if(!this->initialized){
 		return false;
 	}
 
+	ready = false;
 	if(nrfx_qspi_write(data, len, startAddress) == NRFX_SUCCESS){
 		return true;
 	}
 
+	ready = true;
 	return false;
 }
 
@@ -243,10 +374,13 @@ bool QSPI::read(void *data, size_t len, uint32_t startAddress){
 		return false;
 	}
 
+	ready = false;
 	if(nrfx_qspi_read(data, len, startAddress) == NRFX_SUCCESS){
+		waitReady();
 		return true;
 	}
 
+	ready = true;
 	return false;
 }
 
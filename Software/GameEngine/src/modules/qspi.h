@@ -55,10 +55,15 @@ class QSPI
 		bool init();
 		void uninit();
 
+		void waitReady();
 		bool isBusy();
 		bool erase(tBlockSize blockSize, uint32_t startAddress = 0);
+		bool eraseStart(uint32_t startAddress);
+		bool eraseSuspend();
+		bool eraseResume();
 		bool chipErase();
 		bool write(void const *data, size_t len, uint32_t startAddress);
+		bool writeStart(void const *data, size_t len, uint32_t startAddress);
 		bool read(void *data, size_t len, uint32_t startAddress);
 
 
@@ -66,7 +71,8 @@ class QSPI
 
 		bool initialized;
 
-		inline static volatile bool ready = false;
+		// false while a read, write or erase is still going
+		inline static volatile bool ready = true;
 		static void qspi_handler(nrfx_qspi_evt_t event, void * p_context);
 };
 
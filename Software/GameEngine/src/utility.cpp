@@ -226,6 +226,32 @@ uint16_t crc16(uint16_t crcValue, uint8_t newByte, const uint16_t POLYNOM){
 	return crcValue;
 }
 
+/**
+ * Continue a crc32 over more data. This is the same crc32 the editor writes
+ * into the game.dat header (reflected, polynomial 0xEDB88320).
+ * Start with a crcValue of 0 and feed it the data in order, in any size pieces.
+ * Uses a 16 entry table so it doesn't cost 1KB of flash.
+ * @param crcValue the crc32 of all the data before this piece
+ * @param data
+ * @param len
+ * @return the crc32 including this piece
+ */
+uint32_t crc32_update(uint32_t crcValue, const uint8_t *data, uint32_t len){
+	static const uint32_t nibbleTable[16] = {
+		0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+		0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+		0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+		0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+	};
+	crcValue = ~crcValue;
+	for (uint32_t i = 0; i < len; i++) {
+		crcValue ^= data[i];
+		crcValue = (crcValue >> 4) ^ nibbleTable[crcValue & 0x0F];
+		crcValue = (crcValue >> 4) ^ nibbleTable[crcValue & 0x0F];
+	}
+	return ~crcValue;
+}
+
 #define OVERFLOW ((uint32_t)(0xFFFFFFFF/32.768))
 
 uint32_t millis_elapsed(uint32_t currentMillis, uint32_t previousMillis)
@@ -248,6 +274,23 @@ uint32_t millis(void)
 	#endif
 }
 
+uint32_t micros(void)
+{
+	#ifdef DC801_DESKTOP
+	uint64_t counter = SDL_GetPerformanceCounter();
+	uint64_t frequency = SDL_GetPerformanceFrequency();
+	//split up so the multiply can't overflow when the counter is in ns:
+	return (uint32_t)(
+		((counter / frequency) * 1000000)
+		+ (((counter % frequency) * 1000000) / frequency)
+	);
+	#endif
+	#ifdef DC801_EMBEDDED
+	//the app timer runs at 32768Hz, so this is 15625/512 of a tick
+	return (uint32_t)(((uint64_t)app_timer_cnt_get() * 15625) / 512);
+	#endif
+}
+
 void EEpwm_init() {
 	app_pwm_config_t pwm1_cfg = APP_PWM_DEFAULT_CONFIG_1CH(5000L, 11);
 	APP_ERROR_CHECK(app_pwm_init(&PWM1,&pwm1_cfg,NULL));
@@ -276,9 +319,8 @@ uint32_t hex2dec(uint32_t v) {
 	return val;
 }
 
-void util_sd_error()
+static void util_sd_error_draw(void *data)
 {
-	//ENGINE_PANIC("SD Card Error\nCheck card and reboot");
 	p_canvas()->clearScreen(COLOR_BLUE);
 	p_canvas()->printMessage(
 		"SD Card did not initialize properly.\n\
@@ -290,18 +332,26 @@ void util_sd_error()
 		32,
 		32
 	);
-	p_canvas()->blt();
+}
+
+void util_sd_error()
+{
+	//ENGINE_PANIC("SD Card Error\nCheck card and reboot");
+	p_canvas()->renderBands(util_sd_error_draw, NULL);
 	nrf_delay_ms(5000);
 }
 
+static void util_gfx_clear_draw(void *data)
+{
+	p_canvas()->clearScreen(COLOR_BLACK);
+}
+
 void util_gfx_init()
 {
 	area_t area = { 0, 0, WIDTH, HEIGHT };
 	p_canvas()->setTextArea(&area);
 
-	p_canvas()->clearScreen(COLOR_BLACK);
-
-	p_canvas()->blt();
+	p_canvas()->renderBands(util_gfx_clear_draw, NULL);
 }
 
 //this creates one heap variable and one stack variable, and subtracts them
@@ -49,6 +49,7 @@ typedef enum{
 
 uint16_t calcCRC(uint8_t *data, uint8_t len, const uint16_t POLYNOM);
 uint16_t crc16(uint16_t crcValue, uint8_t newByte, const uint16_t POLYNOM);
+uint32_t crc32_update(uint32_t crcValue, const uint8_t *data, uint32_t len);
 
 
 uint8_t getButton(bool waitForLongPress);
@@ -66,6 +67,8 @@ uint32_t getSystick(void);
 
 uint32_t millis_elapsed(uint32_t currentMillis, uint32_t previousMillis);
 uint32_t millis();
+//only as fine as the timer under it: 1us on desktop, ~30us on the badge
+uint32_t micros();
 
 uint8_t getFiles(char files[][9], const char *path, uint8_t fileMax);
 
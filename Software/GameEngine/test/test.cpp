@@ -24,6 +24,12 @@ namespace DC801_Test
 		if (TestAudio() != true) return false;
 		testPause();
 		if (TestMemory() != true) return false;
+		testPause();
+		if (TestFlash() != true) return false;
+		testPause();
+		if (TestSave() != true) return false;
+		testPause();
+		if (TestRender() != true) return false;
 
 		return true;
 	}
@@ -0,0 +1,164 @@
+#include "common.h"
+#include "EngineInput.h"
+#include "EngineROM.h"
+#include "FrameBuffer.h"
+
+#include "../../../fonts/Monaco9.h"
+
+//On desktop, the ROM chip is game.dat mapped by EngineROM_Init, and this file
+//stands in for the SD card. Put an edited copy of game.dat here to see how many
+//blocks a reflash would actually need to touch.
+#define TEST_FLASH_SD_FILE_PATH "MAGE/game_update.dat"
+
+namespace DC801_Test
+{
+	static void printFlashMessage(const char *message, int y)
+	{
+		canvas.printMessage(
+			message,
+			Monaco9,
+			COLOR_WHITE,
+			20,
+			y
+		);
+
+		canvas.blt();
+
+	#ifdef DC801_DESKTOP
+		debug_print("%s\n", message);
+	#endif
+	}
+
+	bool TestFlash()
+	{
+		bool failed = false;
+		char message[128];
+		char diffMessage[128];
+
+		// y advance value from text
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		int y = 10;
+
+	#ifdef DC801_DESKTOP
+		FILINFO sdFileInfo;
+		FIL *sdFile = NULL;
+		EngineROM_CopyStats stats;
+		uint8_t sdChunk[ENGINE_ROM_SD_CHUNK_READ_SIZE];
+
+		// map the 'ROM' side of the diff
+		EngineROM_Init();
+
+		if (
+			f_stat(TEST_FLASH_SD_FILE_PATH, &sdFileInfo) != FR_OK
+			|| f_open(&sdFile, TEST_FLASH_SD_FILE_PATH, FA_READ | FA_OPEN_EXISTING) != FR_OK
+		)
+		{
+			canvas.clearScreen(COLOR_BLACK);
+			printFlashMessage("Opening " TEST_FLASH_SD_FILE_PATH "... Failed", y);
+			failed = true;
+			goto test_end;
+		}
+
+		EngineROM_SD_Copy(sdFileInfo.fsize, sdFile, &stats);
+		canvas.clearScreen(COLOR_BLACK);
+		sprintf(
+			diffMessage,
+			"Diff: written %u skipped %u of %u in %ums",
+			stats.blocksWritten,
+			stats.blocksSkipped,
+			stats.blocksTotal,
+			stats.milliseconds
+		);
+		printFlashMessage(diffMessage, y);
+		y += yAdvance;
+
+		// then wipe the ROM side and copy everything, to time the whole pipeline:
+		for (uint32_t address = 0; address < (uint32_t)sdFileInfo.fsize; address += ENGINE_ROM_ERASE_PAGE_SIZE)
+		{
+			EngineROM_EraseBlock(address);
+		}
+		EngineROM_SD_Copy(sdFileInfo.fsize, sdFile, &stats);
+		canvas.clearScreen(COLOR_BLACK);
+		canvas.printMessage(diffMessage, Monaco9, COLOR_WHITE, 20, y - yAdvance);
+		sprintf(
+			message,
+			"Full: %u blocks in %ums, %u.%02u MB/s",
+			stats.blocksWritten,
+			stats.milliseconds,
+			(unsigned int)(stats.bytesWritten / 1000 / MAX(stats.milliseconds, 1)),
+			(unsigned int)((stats.bytesWritten / 10 / MAX(stats.milliseconds, 1)) % 100)
+		);
+		printFlashMessage(message, y);
+		y += yAdvance;
+
+		// after the copy, the ROM must match the SD file byte for byte:
+		for (uint32_t address = 0; address < (uint32_t)sdFileInfo.fsize; address += ENGINE_ROM_SD_CHUNK_READ_SIZE)
+		{
+			UINT count;
+			uint32_t chunkSize = MIN(ENGINE_ROM_SD_CHUNK_READ_SIZE, sdFileInfo.fsize - address);
+			f_lseek(sdFile, address);
+			f_read(sdFile, sdChunk, chunkSize, &count);
+			if (
+				count != chunkSize
+				|| memcmp(sdChunk, EngineROM_View(address, chunkSize), chunkSize) != 0
+			)
+			{
+				sprintf(message, "ROM differs from SD at block %u", address / ENGINE_ROM_ERASE_PAGE_SIZE);
+				printFlashMessage(message, y);
+				failed = true;
+				break;
+			}
+		}
+		f_close(sdFile);
+
+		y += yAdvance;
+		printFlashMessage("Uninitializing memory", y);
+		EngineROM_Deinit();
+	#else
+		canvas.clearScreen(COLOR_BLACK);
+		printFlashMessage("Flash diff test is desktop only", y);
+	#endif
+
+	test_end:
+		y += yAdvance * 2;
+
+		if (failed)
+		{
+			printFlashMessage("Test failed", y);
+		}
+		else
+		{
+			printFlashMessage("Test passed", y);
+		}
+
+		y = HEIGHT - (yAdvance * 2);
+
+		printFlashMessage("Press Right Joystick to exit", y);
+
+		while (EngineInput_Buttons.rjoy_center == false)
+		{
+			canvas.blt(); // Keep the window frame updated
+
+			// Update EngineInput_Buttons
+			EngineHandleInput();
+
+			// If we manually exit
+			if (EngineIsRunning() == false)
+			{
+				break;
+			}
+
+			// Sleep
+			nrf_delay_ms(100);
+		}
+
+		return !failed;
+	}
+
+#ifndef TEST_ALL
+	bool Test()
+	{
+		return TestFlash();
+	}
+#endif
+}
@@ -5,4 +5,13 @@ namespace DC801_Test
 
 	// Memory
 	bool TestMemory();
+
+	// SD -> ROM flashing
+	bool TestFlash();
+
+	// Save log
+	bool TestSave();
+
+	// Rendering benchmarks
+	bool TestRender();
 };
@@ -0,0 +1,1957 @@
+#include "common.h"
+#include "EngineInput.h"
+#include "EngineROM.h"
+#include "FrameBuffer.h"
+#include "games/mage/mage.h"
+#include "games/mage/mage_hex.h"
+
+#include "../../../fonts/Monaco9.h"
+#include "../../../fonts/Scientifica.h"
+#include "../../../fonts/DeterminationMono.h"
+#include "../../../fonts/Dialog9pt7b.h"
+
+//each thing measured is repeated for at least this long, so the
+//millisecond timer still gives a usable per-draw time on desktop:
+#define TEST_RENDER_MILLISECONDS_PER_MEASUREMENT 250
+
+//the camera is moved across the whole map, so big maps can't hide
+//behind a camera that stays in their top left corner:
+#define TEST_RENDER_CAMERA_POSITIONS 8
+
+//how many camera steps the layer cache is checked with on every map
+#define TEST_RENDER_LAYER_CACHE_STEPS 500
+
+//how many random tiles the tile blitter is checked with
+#define TEST_RENDER_BLITTER_CASES 5000
+
+//the blitter is checked drawing into a buffer that isn't the size of the
+//screen, so anything still assuming WIDTH or HEIGHT shows up:
+#define TEST_RENDER_BLITTER_TARGET_WIDTH 203
+#define TEST_RENDER_BLITTER_TARGET_HEIGHT 149
+
+//the tile cache's budget on the badge, for the tile blitter test to use:
+#define TEST_RENDER_TILE_CACHE_BYTES (32 * 1024)
+
+//every dialog response menu in the game is drawn this many times,
+//a second's worth of frames:
+#define TEST_RENDER_DIALOG_FRAMES 24
+
+//how many frames of buttons the hex editor is checked with, and how many
+//frames it's timed for while nothing changes:
+#define TEST_RENDER_HEX_FRAMES 192
+#define TEST_RENDER_HEX_IDLE_FRAMES 64
+
+//the blitter speed for every flag is only measured for this many tilesets,
+//a whole game's worth takes minutes:
+#define TEST_RENDER_BLITTER_TILESETS 5
+
+extern std::unique_ptr<MageGameControl> MageGame;
+extern std::unique_ptr<MageHexEditor> MageHex;
+extern std::unique_ptr<MageDialogControl> MageDialog;
+extern FrameBuffer *mage_canvas;
+extern uint16_t frame[];
+extern MageEntity *hackableDataAddress;
+
+//every allocation is counted, so what drawing a dialog allocates shows up:
+static uint32_t testRenderAllocations = 0;
+
+void *operator new(size_t size)
+{
+	testRenderAllocations++;
+	void *allocation = malloc(size == 0 ? 1 : size);
+	if (allocation == NULL)
+	{
+		ENGINE_PANIC("Out of memory allocating %u bytes", (uint32_t)size);
+	}
+	return allocation;
+}
+
+void operator delete(void *allocation) noexcept
+{
+	free(allocation);
+}
+
+void operator delete(void *allocation, size_t size) noexcept
+{
+	free(allocation);
+}
+
+//Mostly benchmarks, only the tile blitter, fill, band, dirty rect, occlusion, render list, layer cache, glyph span, text layout, dialog box and hex editor checks can fail. They need a game.dat.
+namespace DC801_Test
+{
+	static void printRenderMessage(const char *message, int y)
+	{
+		canvas.printMessage(
+			message,
+			Monaco9,
+			COLOR_WHITE,
+			20,
+			y
+		);
+
+		canvas.blt();
+
+	#ifdef DC801_DESKTOP
+		debug_print("%s\n", message);
+	#endif
+	}
+
+	//how long one DrawMap(layer) takes on the current map, in microseconds:
+	static uint32_t timeMapLayer(uint8_t layer)
+	{
+		MageMap &map = MageGame->Map();
+		int32_t mapWidth = map.Cols() * map.TileWidth();
+		int32_t mapHeight = map.Rows() * map.TileHeight();
+		uint32_t draws = 0;
+		uint32_t startTime = millis();
+		uint32_t elapsed = 0;
+		do
+		{
+			uint32_t position = draws % TEST_RENDER_CAMERA_POSITIONS;
+			MageGame->cameraPosition.x = ((mapWidth - WIDTH) * position) / (TEST_RENDER_CAMERA_POSITIONS - 1);
+			MageGame->cameraPosition.y = ((mapHeight - HEIGHT) * position) / (TEST_RENDER_CAMERA_POSITIONS - 1);
+			MageGame->applyCameraEffects(0);
+			MageGame->DrawMap(layer);
+			draws++;
+			elapsed = millis() - startTime;
+		}
+		while (elapsed < TEST_RENDER_MILLISECONDS_PER_MEASUREMENT);
+		return (elapsed * 1000) / draws;
+	}
+
+	//DrawMap should only cost what is on screen, so the time per layer
+	//should stay about the same no matter how big the map is
+	static int benchmarkMapLayers(int y)
+	{
+		char message[128];
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		MageGame->cameraFollowEntityId = NO_PLAYER;
+		MageGame->cameraShaking = false;
+		for (uint16_t mapIndex = 0; mapIndex < MageGame->MapCount(); mapIndex++)
+		{
+			MageGame->LoadMap(mapIndex);
+			MageGame->cameraFollowEntityId = NO_PLAYER;
+			MageMap &map = MageGame->Map();
+			int length = sprintf(
+				message,
+				"Map %2u %4ux%-4u",
+				mapIndex,
+				map.Cols(),
+				map.Rows()
+			);
+			for (uint8_t layer = 0; layer < map.LayerCount(); layer++)
+			{
+				length += sprintf(
+					message + length,
+					" L%u:%5uus",
+					layer,
+					timeMapLayer(layer)
+				);
+			}
+			canvas.clearScreen(COLOR_BLACK);
+			printRenderMessage("DrawMap time per layer:", 10);
+			printRenderMessage(message, y);
+		}
+		return y + yAdvance;
+	}
+
+	//what compiling each map's render list costs, and every layer of it
+	//drawn from the list against drawn from ROM:
+	static int benchmarkRenderList(int y)
+	{
+		char message[128];
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		MageGame->cameraFollowEntityId = NO_PLAYER;
+		MageGame->cameraShaking = false;
+		for (uint16_t mapIndex = 0; mapIndex < MageGame->MapCount(); mapIndex++)
+		{
+			MageGame->LoadMap(mapIndex);
+			MageGame->cameraFollowEntityId = NO_PLAYER;
+			MageMap &map = MageGame->Map();
+			//turning it off and on again compiles it again:
+			MageRenderListStats stats = *MageGame->getRenderListStats();
+			//the first run after loading a map comes out faster than the
+			//rest, so it only warms up. then it's from ROM, from the list
+			//twice and from ROM again:
+			uint32_t drawTime[2] = { 0, 0 };
+			for (uint8_t run = 0; run < 5; run++)
+			{
+				uint8_t fromList = (run == 2 || run == 3) ? 1 : 0;
+				MageGame->setRenderList(fromList != 0);
+				for (uint8_t layer = 0; layer < map.LayerCount(); layer++)
+				{
+					uint32_t time = timeMapLayer(layer);
+					if (run != 0)
+					{
+						drawTime[fromList] += time / 2;
+					}
+				}
+			}
+			MageGame->setRenderList(true);
+			sprintf(
+				message,
+				"Map %2u list:%7u bytes %5u tiles %5uus DrawMap:%5uus from ROM:%5uus",
+				mapIndex,
+				stats.bytes,
+				stats.tiles,
+				stats.microseconds,
+				drawTime[1],
+				drawTime[0]
+			);
+			canvas.clearScreen(COLOR_BLACK);
+			printRenderMessage("Render list, all layers:", 10);
+			printRenderMessage(message, y);
+		}
+		return y + yAdvance;
+	}
+
+	//how long it takes to get the layers under the entities onto the screen,
+	//in microseconds per frame, with the camera scrolling diagonally:
+	static uint32_t timeLayersUnderEntities(bool useLayerCache)
+	{
+		MageMap &map = MageGame->Map();
+		uint8_t layersUnderEntities = map.LayerCount() > 1
+			? map.LayerCount() - 1
+			: 1;
+		uint32_t frames = 0;
+		uint32_t startTime = millis();
+		uint32_t elapsed = 0;
+		do
+		{
+			MageGame->cameraPosition.x = frames * 3;
+			MageGame->cameraPosition.y = frames * 2;
+			MageGame->applyCameraEffects(0);
+			if (!useLayerCache || !MageGame->DrawLayerCache(COLOR_BLACK))
+			{
+				canvas.clearScreen(COLOR_BLACK);
+				for (uint8_t layer = 0; layer < layersUnderEntities; layer++)
+				{
+					MageGame->DrawMap(layer);
+				}
+			}
+			frames++;
+			elapsed = millis() - startTime;
+		}
+		while (elapsed < TEST_RENDER_MILLISECONDS_PER_MEASUREMENT);
+		return (elapsed * 1000) / frames;
+	}
+
+	static int benchmarkLayerCache(int y)
+	{
+		char message[128];
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		for (uint16_t mapIndex = 0; mapIndex < MageGame->MapCount(); mapIndex++)
+		{
+			MageGame->LoadMap(mapIndex);
+			MageGame->cameraFollowEntityId = NO_PLAYER;
+			uint32_t drawMapTime = timeLayersUnderEntities(false);
+			uint32_t layerCacheTime = timeLayersUnderEntities(true);
+			sprintf(
+				message,
+				"Map %2u DrawMap:%5uus cache:%5uus",
+				mapIndex,
+				drawMapTime,
+				layerCacheTime
+			);
+			canvas.clearScreen(COLOR_BLACK);
+			printRenderMessage("Layers under entities, scrolling:", 10);
+			printRenderMessage(message, y);
+		}
+		return y + yAdvance;
+	}
+
+	//one frame of the map and entities drawn the way GameRender draws them
+	//during a fade, in microseconds. the fade moves on every frame, like in
+	//SCREEN_FADE_OUT and SCREEN_FADE_IN, so nothing can be reused between frames:
+	static uint32_t timeFadeFrame(bool fading)
+	{
+		MageMap &map = MageGame->Map();
+		uint32_t frames = 0;
+		uint32_t startTime = millis();
+		uint32_t elapsed = 0;
+		canvas.fadeColor = COLOR_WHITE;
+		do
+		{
+			canvas.fadeFraction = fading
+				? (float)((frames % 99) + 1) / 100.0f
+				: 0.0f;
+			canvas.clearScreen(canvas.applyFadeColor(COLOR_BLACK));
+			for (uint8_t layer = 0; layer < map.LayerCount(); layer++)
+			{
+				MageGame->DrawMap(layer);
+			}
+			MageGame->DrawEntities();
+			frames++;
+			elapsed = millis() - startTime;
+		}
+		while (elapsed < TEST_RENDER_MILLISECONDS_PER_MEASUREMENT);
+		canvas.fadeFraction = 0.0f;
+		return (elapsed * 1000) / frames;
+	}
+
+	static int benchmarkFade(int y)
+	{
+		char message[128];
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		MageGame->LoadMap(0);
+		MageGame->cameraFollowEntityId = NO_PLAYER;
+		MageGame->cameraPosition.x = 0;
+		MageGame->cameraPosition.y = 0;
+		MageGame->applyCameraEffects(0);
+		MageGame->UpdateEntities(0);
+		uint32_t normalTime = timeFadeFrame(false);
+		uint32_t fadingTime = timeFadeFrame(true);
+		sprintf(
+			message,
+			"Frame normal:%5uus fading:%5uus",
+			normalTime,
+			fadingTime
+		);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return y + yAdvance;
+	}
+
+	//puts the camera at one of TEST_RENDER_CAMERA_POSITIONS across the map
+	static void placeCamera(uint32_t position)
+	{
+		MageMap &map = MageGame->Map();
+		int32_t mapWidth = map.Cols() * map.TileWidth();
+		int32_t mapHeight = map.Rows() * map.TileHeight();
+		MageGame->cameraPosition.x = ((mapWidth - WIDTH) * (int32_t)position) / (TEST_RENDER_CAMERA_POSITIONS - 1);
+		MageGame->cameraPosition.y = ((mapHeight - HEIGHT) * (int32_t)position) / (TEST_RENDER_CAMERA_POSITIONS - 1);
+		MageGame->applyCameraEffects(0);
+		MageGame->UpdateEntities(0);
+	}
+
+	//every map, drawn whole by GameDraw and then a band at a time by
+	//renderBands, with the camera all over it, faded and with the collision
+	//geometry on, has to come out the same both ways:
+	static bool testBandRendering(int y)
+	{
+		static uint16_t expected[FRAMEBUFFER_SIZE];
+		char message[128];
+		uint32_t frames = 0;
+		MageGame->cameraShaking = false;
+		for (uint16_t mapIndex = 0; mapIndex < MageGame->MapCount(); mapIndex++)
+		{
+			MageGame->LoadMap(mapIndex);
+			MageGame->cameraFollowEntityId = NO_PLAYER;
+			for (uint32_t position = 0; position < TEST_RENDER_CAMERA_POSITIONS; position++)
+			{
+				placeCamera(position);
+				//the fade and the geometry each take the layer cache out of it:
+				canvas.fadeColor = COLOR_WHITE;
+				canvas.fadeFraction = (position % 4 == 1) ? 0.5f : 0.0f;
+				MageGame->isCollisionDebugOn = (position % 4 == 2);
+				canvas.setBandRendering(false);
+				GameDraw(NULL);
+				memcpy(expected, frame, sizeof(expected));
+				canvas.setBandRendering(true);
+				canvas.renderBands(GameDraw, NULL);
+				canvas.setBandRendering(false);
+				frames++;
+				for (uint32_t pixel = 0; pixel < FRAMEBUFFER_SIZE; pixel++)
+				{
+					if (frame[pixel] != expected[pixel])
+					{
+						sprintf(
+							message,
+							"Band FAIL: map %u camera %u pixel %u,%u",
+							mapIndex,
+							position,
+							pixel % WIDTH,
+							pixel / WIDTH
+						);
+						canvas.fadeFraction = 0.0f;
+						MageGame->isCollisionDebugOn = false;
+						canvas.clearScreen(COLOR_BLACK);
+						printRenderMessage(message, y);
+						return false;
+					}
+				}
+			}
+		}
+		canvas.fadeFraction = 0.0f;
+		MageGame->isCollisionDebugOn = false;
+		sprintf(message, "Bands match whole frames: %u frames", frames);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return true;
+	}
+
+	//every map with the tiles under ones that cover them left out, against
+	//all of them drawn, with the camera all over it, faded and with the
+	//collision geometry, which draws the geometry of every tile:
+	static bool testOcclusionCulling(int y)
+	{
+		static uint16_t expected[FRAMEBUFFER_SIZE];
+		char message[128];
+		uint32_t frames = 0;
+		uint32_t drawn = 0;
+		uint32_t culled = 0;
+		MageGame->cameraShaking = false;
+		for (uint16_t mapIndex = 0; mapIndex < MageGame->MapCount(); mapIndex++)
+		{
+			MageGame->LoadMap(mapIndex);
+			MageGame->cameraFollowEntityId = NO_PLAYER;
+			for (uint32_t position = 0; position < TEST_RENDER_CAMERA_POSITIONS; position++)
+			{
+				placeCamera(position);
+				canvas.fadeColor = COLOR_WHITE;
+				canvas.fadeFraction = (position % 4 == 1) ? 0.5f : 0.0f;
+				MageGame->isCollisionDebugOn = (position % 4 == 2);
+				MageGame->setOcclusionCulling(false);
+				GameDraw(NULL);
+				memcpy(expected, frame, sizeof(expected));
+				MageGame->setOcclusionCulling(true);
+				MageGame->resetOcclusionStats();
+				GameDraw(NULL);
+				drawn += MageGame->getOcclusionStats()->tilesDrawn;
+				culled += MageGame->getOcclusionStats()->tilesCulled;
+				frames++;
+				if (memcmp(frame, expected, sizeof(expected)) != 0)
+				{
+					sprintf(message, "Occlusion FAIL: map %u camera %u", mapIndex, position);
+					canvas.fadeFraction = 0.0f;
+					MageGame->isCollisionDebugOn = false;
+					canvas.clearScreen(COLOR_BLACK);
+					printRenderMessage(message, y);
+					return false;
+				}
+			}
+		}
+		canvas.fadeFraction = 0.0f;
+		MageGame->isCollisionDebugOn = false;
+		sprintf(
+			message,
+			"Occlusion matches: %u frames, %u drawn %u culled tiles/frame",
+			frames,
+			drawn / frames,
+			culled / frames
+		);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return true;
+	}
+
+	//every map drawn from its render list, against drawn from ROM, the same
+	//way as the occlusion check:
+	static bool testRenderList(int y)
+	{
+		static uint16_t expected[FRAMEBUFFER_SIZE];
+		char message[128];
+		uint32_t frames = 0;
+		uint32_t mapsFromROM = 0;
+		uint32_t maxBytes = 0;
+		uint32_t maxMicroseconds = 0;
+		MageGame->cameraShaking = false;
+		for (uint16_t mapIndex = 0; mapIndex < MageGame->MapCount(); mapIndex++)
+		{
+			MageGame->LoadMap(mapIndex);
+			MageGame->cameraFollowEntityId = NO_PLAYER;
+			const MageRenderListStats *stats = MageGame->getRenderListStats();
+			if (stats->bytes == 0)
+			{
+				mapsFromROM++;
+			}
+			maxBytes = MAX(maxBytes, stats->bytes);
+			maxMicroseconds = MAX(maxMicroseconds, stats->microseconds);
+			for (uint32_t position = 0; position < TEST_RENDER_CAMERA_POSITIONS; position++)
+			{
+				placeCamera(position);
+				canvas.fadeColor = COLOR_WHITE;
+				canvas.fadeFraction = (position % 4 == 1) ? 0.5f : 0.0f;
+				MageGame->isCollisionDebugOn = (position % 4 == 2);
+				MageGame->setRenderList(false);
+				GameDraw(NULL);
+				memcpy(expected, frame, sizeof(expected));
+				MageGame->setRenderList(true);
+				GameDraw(NULL);
+				frames++;
+				if (memcmp(frame, expected, sizeof(expected)) != 0)
+				{
+					sprintf(message, "Render list FAIL: map %u camera %u", mapIndex, position);
+					canvas.fadeFraction = 0.0f;
+					MageGame->isCollisionDebugOn = false;
+					canvas.clearScreen(COLOR_BLACK);
+					printRenderMessage(message, y);
+					return false;
+				}
+			}
+		}
+		canvas.fadeFraction = 0.0f;
+		MageGame->isCollisionDebugOn = false;
+		sprintf(
+			message,
+			"Render list matches: %u frames, %u maps from ROM, %u bytes %uus at most",
+			frames,
+			mapsFromROM,
+			maxBytes,
+			maxMicroseconds
+		);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return true;
+	}
+
+	//the layers under the entities drawn from the layer cache, against drawn
+	//by DrawMap, while the camera wanders around every map. most steps are a
+	//few pixels so the cache gets shifted and has strips drawn in, some cross
+	//several tiles at once and a few jump far enough to redraw all of it:
+	static bool testLayerCache(int y)
+	{
+		static uint16_t expected[FRAMEBUFFER_SIZE];
+		char message[128];
+		uint32_t frames = 0;
+		uint32_t mapsWithoutCache = 0;
+		MageGame->cameraShaking = false;
+		MageGame->isCollisionDebugOn = false;
+		canvas.fadeFraction = 0.0f;
+		for (uint16_t mapIndex = 0; mapIndex < MageGame->MapCount(); mapIndex++)
+		{
+			MageGame->LoadMap(mapIndex);
+			MageGame->cameraFollowEntityId = NO_PLAYER;
+			MageMap &map = MageGame->Map();
+			int32_t tileWidth = map.TileWidth();
+			int32_t tileHeight = map.TileHeight();
+			int32_t mapWidth = map.Cols() * tileWidth;
+			int32_t mapHeight = map.Rows() * tileHeight;
+			uint8_t layersUnderEntities = map.LayerCount() > 1
+				? map.LayerCount() - 1
+				: 1;
+			MageGame->cameraPosition.x = 0;
+			MageGame->cameraPosition.y = 0;
+			for (uint32_t step = 0; step < TEST_RENDER_LAYER_CACHE_STEPS; step++)
+			{
+				uint32_t kind = rand() % 16;
+				if (kind == 0)
+				{
+					MageGame->cameraPosition.x = (rand() % (mapWidth + WIDTH)) - WIDTH;
+					MageGame->cameraPosition.y = (rand() % (mapHeight + HEIGHT)) - HEIGHT;
+				}
+				else
+				{
+					int32_t reachX = kind < 4 ? tileWidth * 3 : 8;
+					int32_t reachY = kind < 4 ? tileHeight * 3 : 8;
+					MageGame->cameraPosition.x += (rand() % ((reachX * 2) + 1)) - reachX;
+					MageGame->cameraPosition.y += (rand() % ((reachY * 2) + 1)) - reachY;
+				}
+				MageGame->applyCameraEffects(0);
+				if (!MageGame->DrawLayerCache(COLOR_BLACK))
+				{
+					mapsWithoutCache++;
+					break;
+				}
+				memcpy(expected, frame, sizeof(expected));
+				canvas.clearScreen(COLOR_BLACK);
+				for (uint8_t layer = 0; layer < layersUnderEntities; layer++)
+				{
+					MageGame->DrawMap(layer);
+				}
+				frames++;
+				if (memcmp(frame, expected, sizeof(expected)) != 0)
+				{
+					sprintf(
+						message,
+						"Layer cache FAIL: map %u step %u camera %d,%d",
+						mapIndex,
+						step,
+						MageGame->cameraPosition.x,
+						MageGame->cameraPosition.y
+					);
+					canvas.clearScreen(COLOR_BLACK);
+					printRenderMessage(message, y);
+					return false;
+				}
+			}
+		}
+		sprintf(
+			message,
+			"Layer cache matches: %u frames, %u maps without it",
+			frames,
+			mapsWithoutCache
+		);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return true;
+	}
+
+	static void drawFrameWithSquare(void *data)
+	{
+		GameDraw(NULL);
+		if (*(const bool *)data)
+		{
+			canvas.fillRect(100, 100, 8, 8, COLOR_RED);
+		}
+	}
+
+	//all the pixels sent so far, once the present thread has caught up,
+	//and how many of them were only sent again because their rows were due:
+	static uint32_t pixelsSent(uint32_t *refreshed)
+	{
+		const FrameBuffer_PresentStats *stats = canvas.getPresentStats();
+		while (stats->framesPresented + stats->framesDropped < stats->framesQueued)
+		{
+			nrf_delay_ms(1);
+			stats = canvas.getPresentStats();
+		}
+		*refreshed = stats->pixelsRefreshed;
+		return stats->pixelsTransferred;
+	}
+
+	//a frame only sends what changed since the one before: all of it after
+	//invalidateScreen, nothing when it's the same again, and only the rows
+	//of a square drawn over it and taken away again, whole and in bands.
+	//besides that, frames that don't change send all of it again over
+	//HEIGHT / FRAMEBUFFER_REFRESH_ROWS of them, a few rows each:
+	static bool testDirtyRects(int y)
+	{
+		char message[128];
+		uint32_t sent[4];
+		uint32_t refreshed;
+		uint32_t refreshedBefore;
+		const uint32_t expected[4] = { FRAMEBUFFER_SIZE, 0, 8 * WIDTH, 8 * WIDTH };
+		const bool square[4] = { false, false, true, false };
+		MageGame->cameraShaking = false;
+		MageGame->LoadMap(0);
+		MageGame->cameraFollowEntityId = NO_PLAYER;
+		placeCamera(0);
+		for (uint8_t bands = 0; bands < 2; bands++)
+		{
+			canvas.setBandRendering(bands != 0);
+			canvas.invalidateScreen();
+			for (uint8_t step = 0; step < 4; step++)
+			{
+				uint32_t before = pixelsSent(&refreshedBefore);
+				canvas.renderBands(drawFrameWithSquare, (void *)&square[step]);
+				sent[step] = pixelsSent(&refreshed) - before;
+				sent[step] -= refreshed - refreshedBefore;
+			}
+			uint32_t before = pixelsSent(&refreshedBefore);
+			for (uint32_t step = 0; step < HEIGHT / FRAMEBUFFER_REFRESH_ROWS; step++)
+			{
+				canvas.renderBands(drawFrameWithSquare, (void *)&square[0]);
+			}
+			uint32_t refreshCycle = pixelsSent(&refreshed) - before;
+			sprintf(
+				message,
+				"Dirty rects%s: whole %u same %u square %u back %u refresh %u pixels",
+				bands ? " in bands" : "",
+				sent[0],
+				sent[1],
+				sent[2],
+				sent[3],
+				refreshCycle
+			);
+			canvas.setBandRendering(false);
+			canvas.clearScreen(COLOR_BLACK);
+			printRenderMessage(message, y);
+			if (
+				memcmp(sent, expected, sizeof(sent)) != 0
+				|| refreshCycle != FRAMEBUFFER_SIZE
+				|| refreshed - refreshedBefore != FRAMEBUFFER_SIZE
+			)
+			{
+				printRenderMessage("Dirty rects FAIL", y + Monaco9.yAdvance);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//an image file played by drawImageFromFile, whole and in bands, has to
+	//end on its last frame the same as drawImage draws it, and one shorter
+	//than a frame only on the rows that are in it:
+	static bool testFilePlayback(int y)
+	{
+		const char *filename = "test_render_playback.raw";
+		const int x = 20, top = 30, w = 37, h = 90;
+		static uint16_t expected[FRAMEBUFFER_SIZE];
+		static uint16_t pixels[2][w * h];
+		static uint16_t image[w * h];
+		char message[128];
+		for (int pixel = 0; pixel < w * h; pixel++)
+		{
+			pixels[0][pixel] = (uint16_t)(pixel * 7);
+			pixels[1][pixel] = (uint16_t)(pixel * 13 + 1);
+		}
+		//the whole two frames, then just the first half of the first one:
+		const size_t lengths[2] = { sizeof(pixels), w * (h / 2) * sizeof(uint16_t) };
+		for (uint8_t length = 0; length < 2; length++)
+		{
+			FILE *file = fopen(filename, "wb");
+			fwrite(pixels, 1, lengths[length], file);
+			fclose(file);
+			int rows = length ? h / 2 : h;
+			memcpy(image, length ? pixels[0] : pixels[1], w * rows * sizeof(uint16_t));
+			ROM_ENDIAN_U2_BUFFER(image, w * rows);
+			canvas.clearScreen(COLOR_BLACK);
+			canvas.drawImage(x, top, w, rows, image);
+			memcpy(expected, frame, sizeof(expected));
+			for (uint8_t bands = 0; bands < 2; bands++)
+			{
+				//on the screen already, so only what the file draws is left to send:
+				canvas.clearScreen(COLOR_BLACK);
+				canvas.blt();
+				canvas.setBandRendering(bands != 0);
+				canvas.drawImageFromFile(x, top, w, h, filename);
+				canvas.setBandRendering(false);
+				if (memcmp(expected, frame, sizeof(expected)) != 0)
+				{
+					remove(filename);
+					sprintf(
+						message,
+						"File playback FAIL:%s%s",
+						length ? " short file" : "",
+						bands ? " in bands" : ""
+					);
+					canvas.clearScreen(COLOR_BLACK);
+					printRenderMessage(message, y);
+					return false;
+				}
+			}
+		}
+		remove(filename);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage("File playback matches drawImage, whole and in bands", y);
+		return true;
+	}
+
+	//how long a frame takes to draw whole and a band at a time,
+	//and where the time goes in each band:
+	static int benchmarkBands(int y)
+	{
+		char message[128];
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		uint32_t frameTime[2];
+		MageGame->LoadMap(0);
+		MageGame->cameraFollowEntityId = NO_PLAYER;
+		MageGame->cameraShaking = false;
+		canvas.resetBandStats();
+		for (uint8_t bands = 0; bands < 2; bands++)
+		{
+			canvas.setBandRendering(bands);
+			uint32_t frames = 0;
+			uint32_t startTime = millis();
+			uint32_t elapsed = 0;
+			do
+			{
+				placeCamera(frames % TEST_RENDER_CAMERA_POSITIONS);
+				canvas.renderBands(GameDraw, NULL);
+				frames++;
+				elapsed = millis() - startTime;
+			}
+			while (elapsed < TEST_RENDER_MILLISECONDS_PER_MEASUREMENT);
+			frameTime[bands] = (elapsed * 1000) / frames;
+		}
+		canvas.setBandRendering(false);
+		canvas.logBandStats("benchmark");
+		const FrameBuffer_BandStats *stats = canvas.getBandStats();
+		uint32_t slowest = 0;
+		for (uint8_t band = 0; band < FRAMEBUFFER_BAND_COUNT; band++)
+		{
+			slowest = MAX(slowest, stats->drawMicroseconds[band] / stats->frames);
+		}
+		sprintf(
+			message,
+			"Frame whole:%5uus bands:%5uus slowest band:%5uus",
+			frameTime[0],
+			frameTime[1],
+			slowest
+		);
+		canvas.resetBandStats();
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return y + yAdvance;
+	}
+
+	//whole frames, sent to the screen the way GameRender does it, to see how
+	//much of blt the game still has to wait for:
+	static int benchmarkPresent(int y)
+	{
+		char message[128];
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		MageGame->LoadMap(0);
+		MageGame->cameraFollowEntityId = NO_PLAYER;
+		MageGame->cameraPosition.x = 0;
+		MageGame->cameraPosition.y = 0;
+		MageGame->applyCameraEffects(0);
+		MageGame->UpdateEntities(0);
+		MageMap &map = MageGame->Map();
+		canvas.resetPresentStats();
+		uint32_t frames = 0;
+		uint32_t startTime = millis();
+		uint32_t elapsed = 0;
+		do
+		{
+			//the camera goes back and forth, so every frame has changed rows to present:
+			MageGame->cameraPosition.x = (frames & 1) * 16;
+			MageGame->applyCameraEffects(0);
+			canvas.waitForPresent();
+			canvas.clearScreen(COLOR_BLACK);
+			for (uint8_t layer = 0; layer < map.LayerCount(); layer++)
+			{
+				MageGame->DrawMap(layer);
+			}
+			MageGame->DrawEntities();
+			canvas.blt();
+			frames++;
+			elapsed = millis() - startTime;
+		}
+		while (elapsed < TEST_RENDER_MILLISECONDS_PER_MEASUREMENT);
+		canvas.waitForPresent();
+		const FrameBuffer_PresentStats *stats = canvas.getPresentStats();
+		sprintf(
+			message,
+			"Present: %5uus/frame wait:%5uus present:%5uus dropped: %u/%u",
+			(elapsed * 1000) / frames,
+			stats->waitMicroseconds / MAX(stats->framesQueued, 1),
+			stats->presentMicroseconds / MAX(stats->framesPresented, 1),
+			stats->framesDropped,
+			stats->framesQueued
+		);
+		canvas.logPresentStats("benchmark");
+		canvas.resetPresentStats();
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return y + yAdvance;
+	}
+
+	//every bundled font but Org_01, which has the same name as TomThumb:
+	typedef struct {
+		const char *name;
+		const GFXfont *font;
+	} TestRenderFont;
+	static const TestRenderFont testRenderFonts[] = {
+		{ "Monaco9", &Monaco9 },
+		{ "Scientifica", &Scientifica },
+		{ "DeterminationMono", &DeterminationMono },
+		{ "Dialog_plain_9", &Dialog_plain_9 },
+		{ "Computerfont12pt7b", &Computerfont12pt7b },
+		{ "monof558pt7b", &monof558pt7b },
+		{ "gameplay5pt7b", &gameplay5pt7b },
+		{ "VeraMono5pt7b", &VeraMono5pt7b },
+		{ "TomThumb", &TomThumb },
+		{ "practical8pt7b", &practical8pt7b },
+		{ "SFAlienEncountersSolid5pt7b", &SFAlienEncountersSolid5pt7b },
+	};
+	#define TEST_RENDER_FONT_COUNT (sizeof(testRenderFonts) / sizeof(testRenderFonts[0]))
+
+	//every glyph of a font, without the ones printMessage treats as newlines:
+	static uint16_t allGlyphs(const GFXfont *font, char *text)
+	{
+		uint16_t length = 0;
+		for (uint16_t c = MAX(font->first, 1); c <= font->last; c++)
+		{
+			if (c != '\n' && c != '\r')
+			{
+				text[length++] = c;
+			}
+		}
+		text[length] = '\0';
+		return length;
+	}
+
+	//all of a font's glyphs, hanging off every edge of the screen:
+	static void drawAllGlyphs(void *data)
+	{
+		const GFXfont *font = (const GFXfont *)data;
+		char text[257];
+		allGlyphs(font, text);
+		canvas.clearScreen(COLOR_BLACK);
+		canvas.printMessage(text, *font, COLOR_WHITE, -5, -3);
+		canvas.printMessage(text, *font, COLOR_GREEN, 17, 60);
+		canvas.printMessage(text, *font, COLOR_RED, WIDTH - 7, 130);
+		canvas.printMessage(text, *font, COLOR_BLUE, 3, HEIGHT - 4);
+	}
+
+	//every glyph of every font has to come out of its spans the same as
+	//out of its bitmap, whole and in bands:
+	static bool testGlyphSpans(int y)
+	{
+		static uint16_t expected[FRAMEBUFFER_SIZE];
+		char message[128];
+		for (uint8_t fontIndex = 0; fontIndex < TEST_RENDER_FONT_COUNT; fontIndex++)
+		{
+			const GFXfont *font = testRenderFonts[fontIndex].font;
+			EngineGlyphSpans_SetEnabled(false);
+			drawAllGlyphs((void *)font);
+			memcpy(expected, frame, sizeof(expected));
+			EngineGlyphSpans_SetEnabled(true);
+			for (uint8_t bands = 0; bands < 2; bands++)
+			{
+				canvas.setBandRendering(bands != 0);
+				canvas.renderBands(drawAllGlyphs, (void *)font);
+				canvas.setBandRendering(false);
+				if (memcmp(expected, frame, sizeof(expected)) != 0)
+				{
+					sprintf(
+						message,
+						"Glyph spans FAIL: %s%s",
+						testRenderFonts[fontIndex].name,
+						bands ? " in bands" : ""
+					);
+					canvas.clearScreen(COLOR_BLACK);
+					printRenderMessage(message, y);
+					return false;
+				}
+			}
+		}
+		const EngineGlyphSpans_Stats *stats = EngineGlyphSpans_GetStats();
+		sprintf(
+			message,
+			"Glyph spans match: %u fonts, %u bytes, %u glyphs from bitmaps",
+			stats->fonts,
+			stats->bytes,
+			stats->glyphsFromBitmap
+		);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return true;
+	}
+
+	static FrameBuffer_TextLayout testRenderLayouts[4];
+
+	//the same as drawAllGlyphs, from layouts made beforehand:
+	static void drawAllGlyphLayouts(void *data)
+	{
+		canvas.clearScreen(COLOR_BLACK);
+		canvas.drawLayout(&testRenderLayouts[0], COLOR_WHITE);
+		canvas.drawLayout(&testRenderLayouts[1], COLOR_GREEN);
+		canvas.drawLayout(&testRenderLayouts[2], COLOR_RED);
+		canvas.drawLayout(&testRenderLayouts[3], COLOR_BLUE);
+	}
+
+	//text drawn from a layout has to come out the same as printed,
+	//and a dialog with a response menu open has to draw without allocating:
+	static bool testTextLayout(int y)
+	{
+		static uint16_t expected[FRAMEBUFFER_SIZE];
+		char message[128];
+		char text[257];
+		for (uint8_t fontIndex = 0; fontIndex < TEST_RENDER_FONT_COUNT; fontIndex++)
+		{
+			const GFXfont *font = testRenderFonts[fontIndex].font;
+			drawAllGlyphs((void *)font);
+			memcpy(expected, frame, sizeof(expected));
+			allGlyphs(font, text);
+			canvas.layoutMessage(text, font, -5, -3, &testRenderLayouts[0]);
+			canvas.layoutMessage(text, font, 17, 60, &testRenderLayouts[1]);
+			canvas.layoutMessage(text, font, WIDTH - 7, 130, &testRenderLayouts[2]);
+			canvas.layoutMessage(text, font, 3, HEIGHT - 4, &testRenderLayouts[3]);
+			for (uint8_t bands = 0; bands < 2; bands++)
+			{
+				canvas.setBandRendering(bands != 0);
+				canvas.renderBands(drawAllGlyphLayouts, NULL);
+				canvas.setBandRendering(false);
+				if (memcmp(expected, frame, sizeof(expected)) != 0)
+				{
+					sprintf(
+						message,
+						"Text layout FAIL: %s%s",
+						testRenderFonts[fontIndex].name,
+						bands ? " in bands" : ""
+					);
+					canvas.clearScreen(COLOR_BLACK);
+					printRenderMessage(message, y);
+					return false;
+				}
+			}
+		}
+		//every response menu of every dialog:
+		uint32_t menus = 0;
+		uint32_t frames = 0;
+		uint32_t allocations = 0;
+		uint32_t microseconds = 0;
+		for (uint16_t dialogId = 0; dialogId < MageGame->DialogCount(); dialogId++)
+		{
+			MageDialog->load(dialogId, 0);
+			while (MageDialog->isOpen)
+			{
+				if (MageDialog->shouldShowResponses())
+				{
+					uint32_t allocationsBefore = testRenderAllocations;
+					uint32_t startTime = micros();
+					for (uint8_t draw = 0; draw < TEST_RENDER_DIALOG_FRAMES; draw++)
+					{
+						MageDialog->draw();
+					}
+					microseconds += micros() - startTime;
+					allocations += testRenderAllocations - allocationsBefore;
+					frames += TEST_RENDER_DIALOG_FRAMES;
+					menus++;
+				}
+				MageDialog->advanceMessage();
+			}
+		}
+		MageDialog->closeDialog();
+		sprintf(
+			message,
+			"%u response menus: %u allocations in %u frames, %uus per frame",
+			menus,
+			allocations,
+			frames,
+			frames ? microseconds / frames : 0
+		);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return allocations == 0;
+	}
+
+	static void drawDialog(void *data)
+	{
+		canvas.clearScreen(COLOR_PINK);
+		MageDialog->draw();
+	}
+
+	//microseconds it takes to draw the open dialog frames times:
+	static uint32_t timeDialog(uint8_t frames)
+	{
+		uint32_t startTime = micros();
+		for (uint8_t frame = 0; frame < frames; frame++)
+		{
+			MageDialog->draw();
+		}
+		return micros() - startTime;
+	}
+
+	//every message of every dialog has to come out the same from the cached
+	//boxes as drawn tile by tile, whole and in bands:
+	static bool testDialogBoxes(int y)
+	{
+		static uint16_t expected[FRAMEBUFFER_SIZE];
+		char message[128];
+		uint32_t messages = 0;
+		uint32_t cacheBytes = 0;
+		uint32_t tileMicroseconds = 0;
+		uint32_t cachedMicroseconds = 0;
+		for (uint16_t dialogId = 0; dialogId < MageGame->DialogCount(); dialogId++)
+		{
+			MageDialog->load(dialogId, 0);
+			while (MageDialog->isOpen)
+			{
+				MageDialog->setBoxCacheEnabled(false);
+				drawDialog(NULL);
+				memcpy(expected, frame, sizeof(expected));
+				MageDialog->setBoxCacheEnabled(true);
+				for (uint8_t bands = 0; bands < 2; bands++)
+				{
+					canvas.setBandRendering(bands != 0);
+					canvas.renderBands(drawDialog, NULL);
+					canvas.setBandRendering(false);
+					if (memcmp(expected, frame, sizeof(expected)) != 0)
+					{
+						MageDialog->closeDialog();
+						sprintf(message, "Dialog boxes FAIL: dialog %u%s", dialogId, bands ? " in bands" : "");
+						canvas.clearScreen(COLOR_BLACK);
+						printRenderMessage(message, y);
+						return false;
+					}
+				}
+				//whichever goes second comes out slower, so both go twice:
+				cachedMicroseconds += timeDialog(TEST_RENDER_DIALOG_FRAMES / 2);
+				MageDialog->setBoxCacheEnabled(false);
+				tileMicroseconds += timeDialog(TEST_RENDER_DIALOG_FRAMES);
+				MageDialog->setBoxCacheEnabled(true);
+				cachedMicroseconds += timeDialog(TEST_RENDER_DIALOG_FRAMES / 2);
+				cacheBytes = MAX(cacheBytes, MageDialog->getBoxCacheBytes());
+				messages++;
+				MageDialog->advanceMessage();
+			}
+		}
+		MageDialog->closeDialog();
+		uint32_t frames = MAX(messages * TEST_RENDER_DIALOG_FRAMES, 1);
+		sprintf(
+			message,
+			"Dialog boxes match: %u messages, %u bytes, %uus > %uus per frame",
+			messages,
+			cacheBytes,
+			tileMicroseconds / frames,
+			cachedMicroseconds / frames
+		);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return true;
+	}
+
+	//holds the buttons for step of testHexEditor and lets the hex editor
+	//have them, the way the game loop would over two frames. copying goes
+	//on for as long as rjoy_right is held, and ljoy changes how much:
+	static void pressHexButtons(uint32_t step)
+	{
+		ButtonStates buttons = {};
+		switch (step % 16)
+		{
+			case 1: case 2: buttons.ljoy_right = true; break;
+			case 3: buttons.ljoy_down = true; break;
+			case 5: buttons.rjoy_up = true; break;
+			case 6: case 7: case 10: buttons.rjoy_right = true; break;
+			case 8: case 9: buttons.rjoy_right = true; buttons.ljoy_right = true; break;
+			case 11: buttons.rjoy_right = true; buttons.ljoy_left = true; break;
+			case 13: buttons.ljoy_up = true; break;
+			case 14: buttons.rjoy_down = true; break;
+			case 15: buttons.ljoy_left = true; break;
+			default: break;
+		}
+		EngineInput_Activated = {};
+		EngineInput_Deactivated = {};
+		EngineInput_Activated.rjoy_right = buttons.rjoy_right && !EngineInput_Buttons.rjoy_right;
+		EngineInput_Buttons = buttons;
+		MageHex->applyHexModeInputs();
+		//the second frame only runs out the tick delay after moving:
+		EngineInput_Activated = {};
+		MageHex->applyHexModeInputs();
+		MageHex->updateHexStateVariables();
+	}
+
+	//microseconds it takes to draw and show the hex editor frames times:
+	static uint32_t timeHexEditor(uint8_t frames)
+	{
+		uint32_t startTime = micros();
+		for (uint8_t frame = 0; frame < frames; frame++)
+		{
+			canvas.renderBands(GameDraw, NULL);
+		}
+		return micros() - startTime;
+	}
+
+	//the hex editor drawing only what changed since the last frame has to
+	//come out the same as drawing all of it, moving around, changing bytes,
+	//copying across the end of a page, a band at a time like the badge and
+	//whole, and making room for a dialog:
+	static bool testHexEditor(int y)
+	{
+		static uint16_t expected[FRAMEBUFFER_SIZE];
+		static uint8_t hackableData[MAX_ENTITIES_PER_MAP * sizeof(MageEntity)];
+		char message[128];
+		//the map with the most entities has the most pages:
+		uint16_t mapIndex = 0;
+		uint16_t entityCount = 0;
+		for (uint16_t map = 0; map < MageGame->MapCount(); map++)
+		{
+			MageGame->LoadMap(map);
+			if (MageGame->filteredEntityCountOnThisMap > entityCount)
+			{
+				mapIndex = map;
+				entityCount = MageGame->filteredEntityCountOnThisMap;
+			}
+		}
+		MageGame->LoadMap(mapIndex);
+		uint32_t memTotal = entityCount * sizeof(MageEntity);
+		memcpy(hackableData, hackableDataAddress, memTotal);
+		MageSaveGame savedGame = MageGame->currentSave;
+		bool hadControl = MageGame->playerHasControl;
+		bool hadHexEditorControl = MageGame->playerHasHexEditorControl;
+		bool hadClipboard = MageGame->playerHasHexEditorControlClipboard;
+		MageGame->playerHasControl = true;
+		MageGame->playerHasHexEditorControl = true;
+		MageGame->playerHasHexEditorControlClipboard = true;
+		canvas.setBandRendering(false);
+		MageHex->updateHexStateVariables();
+		MageHex->toggleHexEditor();
+		bool passed = true;
+		uint32_t step = 0;
+		for (; step < TEST_RENDER_HEX_FRAMES && passed; step++)
+		{
+			if (step % 16 == 0)
+			{
+				//right before the end of a page, so what's copied runs off of it:
+				MageHex->setHexCursorLocation(((step / 16) * HEXED_MAX_BYTES_PER_PAGE + HEXED_MAX_BYTES_PER_PAGE - 2) % memTotal);
+				MageHex->setPageToCursorLocation();
+			}
+			if (step % 64 == 32 || step % 64 == 63)
+			{
+				MageHex->toggleHexDialog();
+			}
+			pressHexButtons(step);
+			canvas.setBandRendering(step % 8 != 4);
+			canvas.renderBands(GameDraw, NULL);
+			canvas.setBandRendering(false);
+			memcpy(expected, frame, sizeof(expected));
+			MageHex->setIncrementalRendering(false);
+			GameDraw(NULL);
+			MageHex->setIncrementalRendering(true);
+			passed = memcmp(expected, frame, sizeof(expected)) == 0;
+			//so the next frame's bands only send what they draw:
+			canvas.blt();
+		}
+		EngineInput_Buttons = {};
+		EngineInput_Activated = {};
+		pressHexButtons(0);
+		//in bands, the way the badge draws it.
+		//whichever goes second comes out slower, so both go twice:
+		canvas.setBandRendering(true);
+		uint32_t idleMicroseconds = timeHexEditor(TEST_RENDER_HEX_IDLE_FRAMES / 2);
+		MageHex->setIncrementalRendering(false);
+		uint32_t wholeMicroseconds = timeHexEditor(TEST_RENDER_HEX_IDLE_FRAMES);
+		MageHex->setIncrementalRendering(true);
+		idleMicroseconds += timeHexEditor(TEST_RENDER_HEX_IDLE_FRAMES / 2);
+		canvas.setBandRendering(false);
+		MageHex->toggleHexEditor();
+		memcpy(hackableDataAddress, hackableData, memTotal);
+		MageGame->currentSave = savedGame;
+		MageGame->playerHasControl = hadControl;
+		MageGame->playerHasHexEditorControl = hadHexEditorControl;
+		MageGame->playerHasHexEditorControlClipboard = hadClipboard;
+		if (!passed)
+		{
+			sprintf(message, "Hex editor FAIL: step %u", step - 1);
+		}
+		else
+		{
+			sprintf(
+				message,
+				"Hex editor matches: %u frames, idle %uus > %uus per frame",
+				step,
+				wholeMicroseconds / TEST_RENDER_HEX_IDLE_FRAMES,
+				idleMicroseconds / TEST_RENDER_HEX_IDLE_FRAMES
+			);
+		}
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return passed;
+	}
+
+	//thousands of glyphs per second printMessage gets through in one font:
+	static uint32_t timeText(const GFXfont *font, bool useSpans)
+	{
+		char text[257];
+		uint16_t length = allGlyphs(font, text);
+		EngineGlyphSpans_SetEnabled(useSpans);
+		uint64_t glyphs = 0;
+		uint32_t startTime = millis();
+		uint32_t elapsed = 0;
+		do
+		{
+			canvas.printMessage(text, *font, COLOR_WHITE, 0, 20);
+			glyphs += length;
+			elapsed = millis() - startTime;
+		}
+		while (elapsed < TEST_RENDER_MILLISECONDS_PER_MEASUREMENT);
+		EngineGlyphSpans_SetEnabled(true);
+		return (uint32_t)(glyphs / elapsed);
+	}
+
+	static int benchmarkText(int y)
+	{
+		char message[128];
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		for (uint8_t fontIndex = 0; fontIndex < TEST_RENDER_FONT_COUNT; fontIndex++)
+		{
+			const GFXfont *font = testRenderFonts[fontIndex].font;
+			//whichever goes second comes out slower, so both go twice:
+			uint32_t spansSpeed = timeText(font, true);
+			uint32_t bitmapSpeed = timeText(font, false);
+			bitmapSpeed += timeText(font, false);
+			spansSpeed += timeText(font, true);
+			sprintf(
+				message,
+				"%-27s spans:%5u bitmap:%5u kglyphs/s",
+				testRenderFonts[fontIndex].name,
+				spansSpeed / 2,
+				bitmapSpeed / 2
+			);
+			canvas.clearScreen(COLOR_BLACK);
+			printRenderMessage("Text, every glyph of each font:", 10);
+			printRenderMessage(message, y);
+			y += yAdvance;
+		}
+		return y;
+	}
+
+	//what drawChunkWithFlags drew before the tile blitter replaced the eight
+	//tileToBuffer* functions, done the slow and obvious way, pixel by pixel:
+	static void referenceDrawChunkWithFlags(
+		uint16_t *target,
+		int32_t targetWidth,
+		int32_t targetHeight,
+		uint32_t address,
+		const MageColorPalette *colorPalette,
+		int32_t screen_x,
+		int32_t screen_y,
+		uint16_t tile_width,
+		uint16_t tile_height,
+		uint16_t source_x,
+		uint16_t source_y,
+		uint16_t pitch,
+		uint8_t flags
+	)
+	{
+		RenderFlagsUnion flagSplit;
+		flagSplit.i = flags;
+		uint16_t transparent_color = SCREEN_ENDIAN_U2_VALUE(TRANSPARENCY_COLOR);
+		if (flagSplit.f.glitched)
+		{
+			screen_x += tile_width * 0.125;
+			tile_width *= 0.75;
+		}
+		if (
+			screen_x + tile_width < 0 ||
+			screen_x >= targetWidth ||
+			screen_y + tile_height < 0 ||
+			screen_y >= targetHeight
+		)
+		{
+			return;
+		}
+		bool packed = colorPalette->packed();
+		const uint8_t *pixels = EngineROM_View(
+			address + EngineImage_Offset((source_y * pitch) + source_x, packed),
+			EngineImage_Bytes(tile_width * tile_height, packed)
+		);
+		for (int32_t y = 0; y < tile_height; y++)
+		{
+			for (int32_t x = 0; x < tile_width; x++)
+			{
+				int32_t target_x = screen_x + x;
+				int32_t target_y = screen_y + y;
+				if (
+					target_x < 0 ||
+					target_x >= targetWidth ||
+					target_y < 0 ||
+					target_y >= targetHeight
+				)
+				{
+					continue;
+				}
+				int32_t tile_x = flagSplit.f.horizontal ? tile_width - 1 - x : x;
+				int32_t tile_y = flagSplit.f.vertical ? tile_height - 1 - y : y;
+				uint32_t tile_index = flagSplit.f.diagonal
+					? tile_y + (tile_x * tile_width)
+					: tile_x + (tile_y * tile_width);
+				uint16_t color = colorPalette->colors[EngineImage_Pixel(pixels, tile_index, packed)];
+				if (color != transparent_color)
+				{
+					target[(target_y * targetWidth) + target_x] = color;
+				}
+			}
+		}
+	}
+
+	//random tiles from every tileset with random flips, mostly hanging off
+	//the edges of the target, have to come out the same as the reference,
+	//drawn by the tile blitter, and then through a tile cache as small as
+	//the badge's so it's throwing tiles out the whole time:
+	static bool testTileBlitter(int y)
+	{
+		static uint16_t expected[TEST_RENDER_BLITTER_TARGET_WIDTH * TEST_RENDER_BLITTER_TARGET_HEIGHT];
+		static uint16_t actual[TEST_RENDER_BLITTER_TARGET_WIDTH * TEST_RENDER_BLITTER_TARGET_HEIGHT];
+		const int32_t targetWidth = TEST_RENDER_BLITTER_TARGET_WIDTH;
+		const int32_t targetHeight = TEST_RENDER_BLITTER_TARGET_HEIGHT;
+		char message[128];
+		uint32_t failures = 0;
+		uint32_t packedCases = 0;
+		EngineTileCache_SetEnabled(false);
+		for (uint32_t testCase = 0; testCase < TEST_RENDER_BLITTER_CASES * 2; testCase++)
+		{
+			bool cached = testCase >= TEST_RENDER_BLITTER_CASES;
+			if (testCase == TEST_RENDER_BLITTER_CASES)
+			{
+				EngineTileCache_SetEnabled(true);
+				EngineTileCache_SetLimit(TEST_RENDER_TILE_CACHE_BYTES);
+			}
+			//fewer different tiles through the cache, so they come back
+			//to it both before and after they've been thrown out:
+			const MageTileset *tileset = MageGame->getValidTileset(rand() % (cached ? 3 : RAND_MAX));
+			uint16_t tileWidth = tileset->TileWidth();
+			uint16_t tileHeight = tileset->TileHeight();
+			uint16_t tileId = rand() % (cached ? MIN(tileset->Tiles(), 4) : tileset->Tiles());
+			uint8_t flags = rand() & 0x07;
+			if (rand() % 8 == 0)
+			{
+				flags |= 0x80; //glitched
+			}
+			int32_t screen_x = (rand() % (targetWidth + (tileWidth * 2))) - (tileWidth * 3 / 2);
+			int32_t screen_y = (rand() % (targetHeight + (tileHeight * 2))) - (tileHeight * 3 / 2);
+			uint32_t address = MageGame->getImageAddress(tileset->ImageId());
+			MageColorPalette *colorPalette = MageGame->getValidColorPalette(tileset->ImageId());
+			uint16_t source_x = (tileId % tileset->Cols()) * tileWidth;
+			uint16_t source_y = (tileId / tileset->Cols()) * tileHeight;
+			packedCases += colorPalette->packed();
+			for (int32_t i = 0; i < targetWidth * targetHeight; i++)
+			{
+				expected[i] = testCase + i;
+				actual[i] = testCase + i;
+			}
+			referenceDrawChunkWithFlags(
+				expected,
+				targetWidth,
+				targetHeight,
+				address,
+				colorPalette,
+				screen_x,
+				screen_y,
+				tileWidth,
+				tileHeight,
+				source_x,
+				source_y,
+				tileset->ImageWidth(),
+				flags
+			);
+			canvas.setDrawTarget(actual, targetWidth, targetHeight);
+			//half of them with spans, the other half checking every pixel:
+			canvas.drawChunkWithFlags(
+				address,
+				colorPalette,
+				screen_x,
+				screen_y,
+				tileWidth,
+				tileHeight,
+				source_x,
+				source_y,
+				tileset->ImageWidth(),
+				TRANSPARENCY_COLOR,
+				flags,
+				testCase % 2 ? tileset->TileSpans(tileId) : NULL
+			);
+			canvas.resetDrawTarget();
+			if (memcmp(expected, actual, sizeof(actual)) != 0)
+			{
+				if (failures < 10)
+				{
+					debug_print(
+						"Tile blitter mismatch: %ux%u tile at %d,%d, flags 0x%02x, %s%s%s",
+						tileWidth,
+						tileHeight,
+						screen_x,
+						screen_y,
+						flags,
+						testCase % 2 ? "spans" : "no spans",
+						colorPalette->packed() ? ", packed" : "",
+						cached ? ", cached" : ""
+					);
+				}
+				failures++;
+			}
+		}
+		const EngineTileCache_Stats cacheStats = *EngineTileCache_GetStats();
+		EngineTileCache_SetLimit(ENGINE_TILE_CACHE_BYTES);
+		sprintf(
+			message,
+			"Tile blitter: %u of %u tiles wrong, %u of them packed, %u cache hits %u evictions",
+			failures,
+			TEST_RENDER_BLITTER_CASES * 2,
+			packedCases,
+			cacheStats.hits,
+			cacheStats.evictions
+		);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return failures == 0;
+	}
+
+	//how much of ROM the tileset images take, and how much of it a whole
+	//frame reads with nothing cached, like on the badge. the same numbers
+	//for a game.dat encoded without packed images are what to compare with:
+	static int benchmarkImageReads(int y)
+	{
+		char message[128];
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		uint32_t imageBytes = 0;
+		uint32_t unpackedBytes = 0;
+		uint16_t packedTilesets = 0;
+		for (uint16_t tilesetId = 0; tilesetId < MageGame->TilesetCount(); tilesetId++)
+		{
+			const MageTileset *tileset = MageGame->getValidTileset(tilesetId);
+			bool packed = MageGame->getValidColorPalette(tileset->ImageId())->packed();
+			uint32_t pixels = tileset->Tiles() * tileset->TileWidth() * tileset->TileHeight();
+			imageBytes += EngineImage_Bytes(pixels, packed);
+			unpackedBytes += pixels;
+			packedTilesets += packed;
+		}
+		sprintf(
+			message,
+			"Tilesets: %u of %u packed, images %u bytes, %u unpacked",
+			packedTilesets,
+			MageGame->TilesetCount(),
+			imageBytes,
+			unpackedBytes
+		);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		y += yAdvance;
+		EngineTileCache_SetEnabled(false);
+		MageGame->cameraFollowEntityId = NO_PLAYER;
+		MageGame->cameraShaking = false;
+		uint64_t totalBytes = 0;
+		uint32_t totalFrames = 0;
+		for (uint16_t mapIndex = 0; mapIndex < MageGame->MapCount(); mapIndex++)
+		{
+			MageGame->LoadMap(mapIndex);
+			MageGame->cameraFollowEntityId = NO_PLAYER;
+			MageMap &map = MageGame->Map();
+			EngineROM_ResetViewStats();
+			for (uint32_t position = 0; position < TEST_RENDER_CAMERA_POSITIONS; position++)
+			{
+				placeCamera(position);
+				canvas.clearScreen(COLOR_BLACK);
+				for (uint8_t layer = 0; layer < map.LayerCount(); layer++)
+				{
+					MageGame->DrawMap(layer);
+				}
+				MageGame->DrawEntities();
+			}
+			totalBytes += EngineROM_GetViewStats()->bytes;
+			totalFrames += TEST_RENDER_CAMERA_POSITIONS;
+			sprintf(
+				message,
+				"Map %2u ROM read: %7u bytes/frame",
+				mapIndex,
+				EngineROM_GetViewStats()->bytes / TEST_RENDER_CAMERA_POSITIONS
+			);
+			canvas.clearScreen(COLOR_BLACK);
+			printRenderMessage("ROM reads per frame, no tile cache:", 10);
+			printRenderMessage(message, y);
+		}
+		EngineTileCache_SetEnabled(true);
+		sprintf(
+			message,
+			"ROM read: %u bytes/frame over %u frames",
+			(uint32_t)(totalBytes / totalFrames),
+			totalFrames
+		);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage(message, y);
+		return y + yAdvance;
+	}
+
+	//pixels per second drawChunkWithFlags gets through with the tile cache
+	//off, drawing every tile of a tileset all over the screen with one set of flips.
+	//this is the speed the badge has to live with, relative to other variants.
+	static uint32_t timeTileBlitter(const MageTileset *tileset, uint8_t flags)
+	{
+		uint16_t tileWidth = tileset->TileWidth();
+		uint16_t tileHeight = tileset->TileHeight();
+		uint32_t address = MageGame->getImageAddress(tileset->ImageId());
+		MageColorPalette *colorPalette = MageGame->getValidColorPalette(tileset->ImageId());
+		int32_t tilesAcross = WIDTH / tileWidth;
+		int32_t tilesDown = HEIGHT / tileHeight;
+		uint64_t pixels = 0;
+		uint32_t draws = 0;
+		uint32_t startTime = millis();
+		uint32_t elapsed = 0;
+		do
+		{
+			uint16_t tileId = draws % tileset->Tiles();
+			int32_t position = draws % (tilesAcross * tilesDown);
+			canvas.drawChunkWithFlags(
+				address,
+				colorPalette,
+				(position % tilesAcross) * tileWidth,
+				(position / tilesAcross) * tileHeight,
+				tileWidth,
+				tileHeight,
+				(tileId % tileset->Cols()) * tileWidth,
+				(tileId / tileset->Cols()) * tileHeight,
+				tileset->ImageWidth(),
+				TRANSPARENCY_COLOR,
+				flags
+			);
+			pixels += tileWidth * tileHeight;
+			draws++;
+			//the timer is only checked every so often, it costs more than a tile:
+			if (draws % 256 == 0)
+			{
+				elapsed = millis() - startTime;
+			}
+		}
+		while (elapsed < TEST_RENDER_MILLISECONDS_PER_MEASUREMENT);
+		return (uint32_t)(pixels / (elapsed * 1000));
+	}
+
+	static int benchmarkTileBlitter(int y)
+	{
+		char message[128];
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		EngineTileCache_SetEnabled(false);
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage("Tile blitter, Mpx/s for flags 0-7:", 10);
+		uint16_t tilesetCount = MIN(MageGame->TilesetCount(), TEST_RENDER_BLITTER_TILESETS);
+		for (uint16_t tilesetId = 0; tilesetId < tilesetCount; tilesetId++)
+		{
+			const MageTileset *tileset = MageGame->getValidTileset(tilesetId);
+			const MageColorPalette *colorPalette = MageGame->getValidColorPalette(tileset->ImageId());
+			int length = sprintf(
+				message,
+				"Tileset %u %ux%u %s",
+				tilesetId,
+				tileset->TileWidth(),
+				tileset->TileHeight(),
+				colorPalette->opaque ? "opaque" : "keyed"
+			);
+			for (uint8_t flags = 0; flags < 8; flags++)
+			{
+				length += sprintf(
+					message + length,
+					" %u",
+					timeTileBlitter(tileset, flags)
+				);
+			}
+			printRenderMessage(message, y);
+			y += yAdvance;
+		}
+		EngineTileCache_SetEnabled(true);
+		return y;
+	}
+
+	//how long drawChunkWithFlags takes per tile of a tileset in nanoseconds,
+	//with the tile cache off, drawing each of its tiles in turn all over the screen:
+	static uint32_t timeTileSpans(const MageTileset *tileset, bool useSpans)
+	{
+		uint16_t tileWidth = tileset->TileWidth();
+		uint16_t tileHeight = tileset->TileHeight();
+		uint32_t address = MageGame->getImageAddress(tileset->ImageId());
+		MageColorPalette *colorPalette = MageGame->getValidColorPalette(tileset->ImageId());
+		int32_t tilesAcross = MAX(WIDTH / tileWidth, 1);
+		int32_t tilesDown = MAX(HEIGHT / tileHeight, 1);
+		uint32_t draws = 0;
+		uint32_t startTime = millis();
+		uint32_t elapsed = 0;
+		do
+		{
+			uint16_t tileId = draws % tileset->Tiles();
+			int32_t position = draws % (tilesAcross * tilesDown);
+			canvas.drawChunkWithFlags(
+				address,
+				colorPalette,
+				(position % tilesAcross) * tileWidth,
+				(position / tilesAcross) * tileHeight,
+				tileWidth,
+				tileHeight,
+				(tileId % tileset->Cols()) * tileWidth,
+				(tileId / tileset->Cols()) * tileHeight,
+				tileset->ImageWidth(),
+				TRANSPARENCY_COLOR,
+				0,
+				useSpans ? tileset->TileSpans(tileId) : NULL
+			);
+			draws++;
+			if (draws % 256 == 0)
+			{
+				elapsed = millis() - startTime;
+			}
+		}
+		while (elapsed < TEST_RENDER_MILLISECONDS_PER_MEASUREMENT);
+		return (uint32_t)(((uint64_t)elapsed * 1000000) / draws);
+	}
+
+	//every tileset that got spans when the game loaded, which is every one with
+	//a tile that's at least half transparent on desktop, with how much of it the
+	//spans skip and what that saves over checking every pixel:
+	static int benchmarkTileSpans(int y)
+	{
+		char message[128];
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		uint64_t totalPixels = 0;
+		uint64_t totalSkipped = 0;
+		uint64_t totalKeyedTime = 0;
+		uint64_t totalSpansTime = 0;
+		EngineTileCache_SetEnabled(false);
+		canvas.clearScreen(COLOR_BLACK);
+		for (uint16_t tilesetId = 0; tilesetId < MageGame->TilesetCount(); tilesetId++)
+		{
+			const MageTileset *tileset = MageGame->getValidTileset(tilesetId);
+			if (!tileset->HasSpans())
+			{
+				continue;
+			}
+			uint32_t tilePixels = tileset->TileWidth() * tileset->TileHeight();
+			uint32_t pixels = tileset->Tiles() * tilePixels;
+			uint32_t opaquePixels = 0;
+			for (uint16_t tileId = 0; tileId < tileset->Tiles(); tileId++)
+			{
+				//a tile without spans doesn't skip any of its pixels:
+				opaquePixels += tileset->TileSpans(tileId) == NULL
+					? tilePixels
+					: EngineTileSpans_OpaquePixels(
+						tileset->TileSpans(tileId),
+						tileset->TileHeight()
+					);
+			}
+			//keyed, spans, spans, keyed, so neither one always goes first:
+			uint32_t keyedTime = timeTileSpans(tileset, false);
+			uint32_t spansTime = timeTileSpans(tileset, true);
+			spansTime = (spansTime + timeTileSpans(tileset, true)) / 2;
+			keyedTime = (keyedTime + timeTileSpans(tileset, false)) / 2;
+			totalPixels += pixels;
+			totalSkipped += pixels - opaquePixels;
+			totalKeyedTime += keyedTime * tileset->Tiles();
+			totalSpansTime += spansTime * tileset->Tiles();
+			sprintf(
+				message,
+				"Tileset %2u %2ux%-2u skip %3u%% %5uns > %5uns",
+				tilesetId,
+				tileset->TileWidth(),
+				tileset->TileHeight(),
+				((pixels - opaquePixels) * 100) / pixels,
+				keyedTime,
+				spansTime
+			);
+			canvas.clearScreen(COLOR_BLACK);
+			printRenderMessage("Tile spans, skipped pixels, time per tile:", 10);
+			printRenderMessage(message, y);
+		}
+		EngineTileCache_SetEnabled(true);
+		if (totalPixels > 0)
+		{
+			sprintf(
+				message,
+				"All tiles: skip %u%%, %u%% less time",
+				(uint32_t)((totalSkipped * 100) / totalPixels),
+				totalKeyedTime > 0
+					? (uint32_t)(100 - ((totalSpansTime * 100) / totalKeyedTime))
+					: 0
+			);
+			printRenderMessage(message, y + yAdvance);
+		}
+		return y + (yAdvance * 2);
+	}
+
+	//the fills FrameBuffer had before they went row by row, a word at a time,
+	//drawing into target instead of the frame so they can be compared:
+	static void referenceClearScreen(uint16_t *target, uint16_t color)
+	{
+		for (uint32_t i = 0; i < FRAMEBUFFER_SIZE; ++i)
+		{
+			target[i] = SCREEN_ENDIAN_U2_VALUE(color);
+		}
+	}
+
+	static void referenceFillRect(uint16_t *target, int x, int y, int w, int h, uint16_t color)
+	{
+		if ((x >= WIDTH) || (y >= HEIGHT))
+		{
+			return;
+		}
+		if ((x + w) > WIDTH)
+		{
+			w = WIDTH - x;
+		}
+		if ((y + h) > HEIGHT)
+		{
+			h = HEIGHT - y;
+		}
+		for (int i = x; i < (x + w); i++)
+		{
+			for (int j = y; j < (y + h); j++)
+			{
+				target[i + (WIDTH * j)] = SCREEN_ENDIAN_U2_VALUE(color);
+			}
+		}
+	}
+
+	static void referenceHorizontalLine(uint16_t *target, int x1, int y, int x2, uint16_t color)
+	{
+		int s1 = MIN(x1, x2);
+		int s2 = MAX(x1, x2);
+		if (y < 0 || y >= HEIGHT) { return; }
+		for (int x = s1; x <= s2; ++x)
+		{
+			if (x >= 0 && x < WIDTH)
+			{
+				target[x + (y * WIDTH)] = SCREEN_ENDIAN_U2_VALUE(color);
+			}
+		}
+	}
+
+	static void referenceVerticalLine(uint16_t *target, int x, int y1, int y2, uint16_t color)
+	{
+		int s1 = MIN(y1, y2);
+		int s2 = MAX(y1, y2);
+		if (x < 0 || x >= WIDTH) { return; }
+		for (int y = s1; y <= s2; ++y)
+		{
+			if (y >= 0 && y < HEIGHT)
+			{
+				target[x + (y * WIDTH)] = SCREEN_ENDIAN_U2_VALUE(color);
+			}
+		}
+	}
+
+	enum FillCase {
+		FILL_CLEAR_SCREEN,
+		FILL_RECT_SCREEN,
+		//about one hex editor cell, at an odd x so it starts half a word in:
+		FILL_RECT_SMALL,
+		FILL_HORIZONTAL_LINE,
+		FILL_VERTICAL_LINE,
+		FILL_CASE_COUNT
+	};
+
+	static const char *fillCaseNames[FILL_CASE_COUNT] = {
+		"clearScreen",
+		"fillRect screen",
+		"fillRect 13x9",
+		"hLine screen",
+		"vLine screen",
+	};
+
+	//draws one of the cases with the old code into referenceTarget,
+	//or with the FrameBuffer into the frame if referenceTarget is NULL:
+	static void drawFillCase(uint8_t fillCase, uint16_t *referenceTarget, uint16_t color)
+	{
+		switch (fillCase)
+		{
+		case FILL_CLEAR_SCREEN:
+			referenceTarget
+				? referenceClearScreen(referenceTarget, color)
+				: canvas.clearScreen(color);
+			break;
+		case FILL_RECT_SCREEN:
+			referenceTarget
+				? referenceFillRect(referenceTarget, 0, 0, WIDTH, HEIGHT, color)
+				: canvas.fillRect(0, 0, WIDTH, HEIGHT, color);
+			break;
+		case FILL_RECT_SMALL:
+			referenceTarget
+				? referenceFillRect(referenceTarget, 101, 37, 13, 9, color)
+				: canvas.fillRect(101, 37, 13, 9, color);
+			break;
+		case FILL_HORIZONTAL_LINE:
+			referenceTarget
+				? referenceHorizontalLine(referenceTarget, -5, 17, WIDTH + 5, color)
+				: canvas.drawHorizontalLine(-5, 17, WIDTH + 5, color);
+			break;
+		case FILL_VERTICAL_LINE:
+			referenceTarget
+				? referenceVerticalLine(referenceTarget, 31, -5, HEIGHT + 5, color)
+				: canvas.drawVerticalLine(31, -5, HEIGHT + 5, color);
+			break;
+		}
+	}
+
+	//nanoseconds per call:
+	static uint32_t timeFillCase(uint8_t fillCase, uint16_t *referenceTarget)
+	{
+		uint32_t draws = 0;
+		uint32_t startTime = millis();
+		uint32_t elapsed = 0;
+		do
+		{
+			drawFillCase(fillCase, referenceTarget, draws);
+			draws++;
+			if (draws % 64 == 0)
+			{
+				elapsed = millis() - startTime;
+			}
+		}
+		while (elapsed < TEST_RENDER_MILLISECONDS_PER_MEASUREMENT);
+		return (uint32_t)(((uint64_t)elapsed * 1000000) / draws);
+	}
+
+	//every fill has to leave the frame the way the old code would have,
+	//and is timed against it:
+	static bool benchmarkFills(int y)
+	{
+		static uint16_t expected[FRAMEBUFFER_SIZE];
+		char message[128];
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		bool passed = true;
+		for (uint8_t fillCase = 0; fillCase < FILL_CASE_COUNT; fillCase++)
+		{
+			uint32_t referenceTime = timeFillCase(fillCase, expected);
+			uint32_t fillTime = timeFillCase(fillCase, NULL);
+			memcpy(expected, frame, sizeof(expected));
+			drawFillCase(fillCase, expected, COLOR_PINK);
+			drawFillCase(fillCase, NULL, COLOR_PINK);
+			bool same = memcmp(expected, frame, sizeof(expected)) == 0;
+			passed &= same;
+			sprintf(
+				message,
+				"%-16s%7uns >%6uns%s",
+				fillCaseNames[fillCase],
+				referenceTime,
+				fillTime,
+				same ? "" : " WRONG"
+			);
+			canvas.clearScreen(COLOR_BLACK);
+			printRenderMessage("Fills, old > new, per call:", 10);
+			printRenderMessage(message, y);
+		}
+		return passed;
+	}
+
+	bool TestRender()
+	{
+		// y advance value from text
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		int y = 10;
+
+		canvas.clearScreen(COLOR_BLACK);
+		printRenderMessage("Loading game.dat", y);
+		y += yAdvance;
+		//the same setup MAGE() does before its game loop:
+		mage_canvas = p_canvas();
+		EngineInit();
+
+		if (testTileBlitter(y) != true) return false;
+		y += yAdvance;
+		if (benchmarkFills(y) != true) return false;
+		y += yAdvance;
+		if (testBandRendering(y) != true) return false;
+		y += yAdvance;
+		if (testDirtyRects(y) != true) return false;
+		y += yAdvance;
+		if (testFilePlayback(y) != true) return false;
+		y += yAdvance;
+		if (testOcclusionCulling(y) != true) return false;
+		y += yAdvance;
+		if (testRenderList(y) != true) return false;
+		y += yAdvance;
+		if (testLayerCache(y) != true) return false;
+		y += yAdvance;
+		if (testGlyphSpans(y) != true) return false;
+		y += yAdvance;
+		if (testTextLayout(y) != true) return false;
+		y += yAdvance;
+		if (testDialogBoxes(y) != true) return false;
+		y += yAdvance;
+		if (testHexEditor(y) != true) return false;
+		y += yAdvance;
+		y = benchmarkTileBlitter(y);
+		y = benchmarkTileSpans(y);
+		y = benchmarkImageReads(y);
+		y = benchmarkMapLayers(y);
+		y = benchmarkRenderList(y);
+		y = benchmarkLayerCache(y);
+		y = benchmarkFade(y);
+		y = benchmarkPresent(y);
+		y = benchmarkBands(y);
+		y = benchmarkText(y);
+
+		y += yAdvance * 2;
+
+		printRenderMessage("Benchmarks done", y);
+
+		y = HEIGHT - (yAdvance * 2);
+
+		printRenderMessage("Press Right Joystick to exit", y);
+
+		while (EngineInput_Buttons.rjoy_center == false)
+		{
+			canvas.blt(); // Keep the window frame updated
+
+			// Update EngineInput_Buttons
+			EngineHandleInput();
+
+			// If we manually exit
+			if (EngineIsRunning() == false)
+			{
+				break;
+			}
+
+			// Sleep
+			nrf_delay_ms(100);
+		}
+
+		return true;
+	}
+
+#ifndef TEST_ALL
+	bool Test()
+	{
+		return TestRender();
+	}
+#endif
+}
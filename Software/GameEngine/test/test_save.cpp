@@ -0,0 +1,252 @@
+#include "common.h"
+#include "EngineInput.h"
+#include "EngineSaveLog.h"
+#include "FrameBuffer.h"
+#include "games/mage/mage_defines.h"
+
+#include "../../../fonts/Monaco9.h"
+
+//enough saves to go around the whole log a few times:
+#define TEST_SAVE_WRITE_COUNT (ENGINE_SAVE_LOG_SECTOR_COUNT * 3)
+
+//This wipes every save slot! On desktop, test.make points the log at its own file.
+namespace DC801_Test
+{
+	static void printSaveMessage(const char *message, int y)
+	{
+		canvas.printMessage(
+			message,
+			Monaco9,
+			COLOR_WHITE,
+			20,
+			y
+		);
+
+		canvas.blt();
+
+	#ifdef DC801_DESKTOP
+		debug_print("%s\n", message);
+	#endif
+	}
+
+	static void fillSaveData(uint8_t *data, uint8_t slotIndex, uint32_t writeIndex)
+	{
+		for (uint32_t i = 0; i < sizeof(MageSaveGame); i++)
+		{
+			data[i] = (uint8_t)((writeIndex * 7) + (slotIndex * 31) + i);
+		}
+	}
+
+	static bool checkSaveSlots(const uint32_t *lastWrites)
+	{
+		uint8_t expected[sizeof(MageSaveGame)];
+		uint8_t actual[sizeof(MageSaveGame)];
+		for (uint8_t slotIndex = 0; slotIndex < ENGINE_ROM_SAVE_GAME_SLOTS; slotIndex++)
+		{
+			fillSaveData(expected, slotIndex, lastWrites[slotIndex]);
+			if (
+				!EngineSaveLog_Read(slotIndex, sizeof(actual), actual)
+				|| memcmp(expected, actual, sizeof(actual)) != 0
+			)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool TestSave()
+	{
+		bool failed = false;
+		char message[128];
+		uint8_t data[sizeof(MageSaveGame)];
+		uint32_t lastWrites[ENGINE_ROM_SAVE_GAME_SLOTS];
+
+		// y advance value from text
+		const uint8_t yAdvance = Monaco9.yAdvance;
+		int y = 10;
+
+		canvas.clearScreen(COLOR_BLACK);
+		printSaveMessage("Erasing save log", y);
+		y += yAdvance;
+		EngineSaveLog_Init();
+		EngineSaveLog_EraseAll();
+		const EngineSaveLog_Stats *stats = EngineSaveLog_GetStats();
+		EngineSaveLog_Stats statsBefore = *stats;
+
+		uint32_t startTime = millis();
+		for (uint32_t writeIndex = 0; writeIndex < TEST_SAVE_WRITE_COUNT; writeIndex++)
+		{
+			// slot 0 gets most of the saves, like it does in practice, and the
+			// last slot is only saved once, so the log has to keep moving it
+			uint8_t slotIndex = 0;
+			if (writeIndex < ENGINE_ROM_SAVE_GAME_SLOTS)
+			{
+				slotIndex = writeIndex;
+			}
+			else if (writeIndex % 5 == 4)
+			{
+				slotIndex = 1;
+			}
+			fillSaveData(data, slotIndex, writeIndex);
+			EngineSaveLog_Write(slotIndex, sizeof(data), data);
+			lastWrites[slotIndex] = writeIndex;
+
+			// every so often, 'reboot' and make sure the scan finds the same saves
+			if (writeIndex % 41 == 40 || writeIndex == TEST_SAVE_WRITE_COUNT - 1)
+			{
+				EngineSaveLog_Init();
+				if (!checkSaveSlots(lastWrites))
+				{
+					sprintf(message, "Wrong save data after write %u", writeIndex);
+					printSaveMessage(message, y);
+					y += yAdvance;
+					failed = true;
+					break;
+				}
+			}
+		}
+		uint32_t elapsed = millis() - startTime;
+
+		sprintf(
+			message,
+			"%u saves, %u moved, in %ums",
+			stats->recordsWritten - statsBefore.recordsWritten,
+			stats->recordsMoved - statsBefore.recordsMoved,
+			elapsed
+		);
+		printSaveMessage(message, y);
+		y += yAdvance;
+		// erasing one whole slot block per save used to cost an erase every time:
+		sprintf(
+			message,
+			"Erases: %u, was %u",
+			stats->segmentErases - statsBefore.segmentErases,
+			stats->recordsWritten - statsBefore.recordsWritten
+		);
+		printSaveMessage(message, y);
+		y += yAdvance;
+		sprintf(
+			message,
+			"Flash time: erase %ums, program %ums",
+			(stats->eraseMicroseconds - statsBefore.eraseMicroseconds) / 1000,
+			(stats->programMicroseconds - statsBefore.programMicroseconds) / 1000
+		);
+		printSaveMessage(message, y);
+		y += yAdvance;
+
+		// saves in the background should only ever cost the game loop a sliver of
+		// a frame, even the ones that have to wait on a segment erase:
+		{
+			uint32_t longestStep = 0;
+			uint32_t steps = 0;
+			uint32_t erasesBefore = stats->segmentErases;
+			startTime = millis();
+			for (uint32_t writeIndex = 0; writeIndex < ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT; writeIndex++)
+			{
+				fillSaveData(data, 0, writeIndex);
+				EngineSaveLog_StartWrite(0, sizeof(data), data);
+				// the snapshot was taken, so this must not end up in the save
+				memset(data, 0, sizeof(data));
+				lastWrites[0] = writeIndex;
+				while (EngineSaveLog_IsBusy())
+				{
+					uint32_t stepStartTime = millis();
+					EngineSaveLog_Step();
+					longestStep = MAX(longestStep, millis() - stepStartTime);
+					steps++;
+					nrf_delay_ms(1);
+				}
+			}
+			elapsed = millis() - startTime;
+			if (!checkSaveSlots(lastWrites))
+			{
+				printSaveMessage("Wrong save data after background saves", y);
+				y += yAdvance;
+				failed = true;
+			}
+			sprintf(
+				message,
+				"Background: %u erases, longest step %ums",
+				stats->segmentErases - erasesBefore,
+				longestStep
+			);
+			printSaveMessage(message, y);
+			y += yAdvance;
+			sprintf(
+				message,
+				"%u saves took %u steps in %ums",
+				ENGINE_SAVE_LOG_SECTORS_PER_SEGMENT,
+				steps,
+				elapsed
+			);
+			printSaveMessage(message, y);
+			y += yAdvance;
+		}
+
+		// a save still in progress when the engine shuts down makes it to the
+		// file, and the log carries on after starting up again
+		fillSaveData(data, 0, TEST_SAVE_WRITE_COUNT);
+		EngineSaveLog_StartWrite(0, sizeof(data), data);
+		lastWrites[0] = TEST_SAVE_WRITE_COUNT;
+		EngineSaveLog_Deinit();
+		EngineSaveLog_Init();
+		if (!checkSaveSlots(lastWrites))
+		{
+			printSaveMessage("Wrong save data after shutting down", y);
+			y += yAdvance;
+			failed = true;
+		}
+
+		// a slot that was never written reads back as zeros
+		EngineSaveLog_EraseAll();
+		memset(data, 0xAA, sizeof(data));
+		if (EngineSaveLog_Read(0, sizeof(data), data) || data[0] != 0)
+		{
+			printSaveMessage("Erased slot did not read back empty", y);
+			y += yAdvance;
+			failed = true;
+		}
+
+		y += yAdvance * 2;
+
+		if (failed)
+		{
+			printSaveMessage("Test failed", y);
+		}
+		else
+		{
+			printSaveMessage("Test passed", y);
+		}
+
+		y = HEIGHT - (yAdvance * 2);
+
+		printSaveMessage("Press Right Joystick to exit", y);
+
+		while (EngineInput_Buttons.rjoy_center == false)
+		{
+			canvas.blt(); // Keep the window frame updated
+
+			// Update EngineInput_Buttons
+			EngineHandleInput();
+
+			// If we manually exit
+			if (EngineIsRunning() == false)
+			{
+				break;
+			}
+
+			// Sleep
+			nrf_delay_ms(100);
+		}
+
+		return !failed;
+	}
+
+#ifndef TEST_ALL
+	bool Test()
+	{
+		return TestSave();
+	}
+#endif
+}